@@ -5,140 +5,202 @@
 #include <cstdint>
 #include <iostream>
 #include <limits>
-#include <queue>
 #include <stdexcept>
 
+#include "edgeSnap.hpp"
+#include "searchCommon.hpp"
 #include "utils.hpp"
 
-// NOTE: Keep edge-access bits separate from the path step labels.
-// Edges use bitmasks (bike=0x1, foot=0x2). Your new enum values are for OUTPUT
-// labeling.
 namespace
 {
-constexpr std::uint8_t EDGE_MASK_BIKE = 0x1;
-constexpr std::uint8_t EDGE_MASK_FOOT = 0x2;
-}  // namespace
-
-inline bool isPreferredBike(std::uint8_t primary, std::uint16_t mask) noexcept
+// Endpoints of an aStarSnapped query, with the tail node of every target
+// edge (the node a target is reached through).
+struct SnappedEnds
 {
-  if (primary >= 16) return true;  // unknown → neutral (no penalty)
-  return (mask & (std::uint16_t(1) << primary)) != 0;
-}
-
-AStarResult aStarTwoLayer(const EdgesView& edgesView,
-                          const NodesView& nodesView, uint32_t sourceIdx,
-                          uint32_t targetIdx, const AStarParams& params)
+  const std::vector<EdgePoint>& sources;
+  const std::vector<EdgePoint>& targets;
+  std::vector<uint32_t> targetTails;
+};
+
+// Cheapest way found so far to a snapped target: from state parent (or
+// straight from sources[source] on the same edge if parent is UINT32_MAX)
+// along targets[target]'s edge.
+struct SnappedGoal
+{
+  double cost{std::numeric_limits<double>::infinity()};
+  double time{0.0};
+  uint32_t parent{UINT32_MAX};
+  uint32_t source{UINT32_MAX};
+  uint32_t target{UINT32_MAX};
+  uint8_t mode{0};
+};
+
+// Templated on the cost kernel, edge layout, state store and open-set
+// policy so every combination gets a fully inlined relaxation loop.
+// Node-to-node unless ends is set (aStarSnapped).
+template <CostKernel kKernel, class Edges, class StateStore, class OpenQueue>
+AStarResult runAStar(const EdgesView& edgesView, const Edges& edges,
+                     uint32_t sourceIdx, uint32_t targetIdx,
+                     const AStarParams& params, const CostModel& costs,
+                     const TravelTimeBound& heuristic,
+                     const SearchOptions& options, StateStore& states,
+                     OpenQueue& openPQ, SearchWorkspace& workspace,
+                     const SnappedEnds* ends = nullptr)
 {
   const uint32_t numNodes = edgesView.numNodes;
-  if (sourceIdx >= numNodes || targetIdx >= numNodes)
-    throw std::runtime_error("source/target out of range");
-
-  // Validate speeds
-  if (!(std::isfinite(params.bikeSpeedMps) && params.bikeSpeedMps > 0.0) ||
-      !(std::isfinite(params.walkSpeedMps) && params.walkSpeedMps > 0.0))
-    throw std::invalid_argument(
-        "bikeSpeedMps and walkSpeedMps must be finite and > 0");
-
-  const double invBike = 1.0 / params.bikeSpeedMps;
-  const double invWalk = 1.0 / params.walkSpeedMps;
-  const double wSurfPerM =
-      std::max(0.0, params.surfacePenaltySPerKm) * 0.001;  // s per meter
-
-  double targetLat, targetLon;
-  nodeDeg(nodesView, targetIdx, targetLat, targetLon);
-  const double vmax = std::max(params.bikeSpeedMps, params.walkSpeedMps);
-
-  // Heuristic = optimistic straight-line time with vmax (no penalties)
-  auto heuristic = [&](uint32_t currentIdx) -> double {
-    double currentLat, currentLon;
-    nodeDeg(nodesView, currentIdx, currentLat, currentLon);
-    return utils::haversineMeters(currentLat, currentLon, targetLat,
-                                  targetLon) /
-           vmax;
+  SearchStats stats;
+  stats.collected = kSearchStats;
+  PhaseTimer timer;
+
+  // States: reset is O(1) for the dense store, O(touched) for the sparse one
+  states.reset(StateKey::kLayers * numNodes);
+  openPQ.clear();
+
+  // A seed has no parent state; parentEdge is the snapped source's edge
+  auto seed = [&](uint32_t node, Layer layer, double costS, double timeS,
+                  uint32_t edgeIdx, uint8_t stepLabel) {
+    const uint32_t key = StateKey::idx(node, layer);
+    SearchState& state = states.at(key);
+    if (costS >= state.gCost) return;
+    state.gCost = costS;
+    state.gTime = timeS;
+    state.parentEdge = edgeIdx;
+    state.parentMode = stepLabel;
+    openPQ.push(costS + heuristic(node), key, state);
+    if constexpr (kSearchStats) ++stats.pushes;
   };
 
-  const double INF = std::numeric_limits<double>::infinity();
-  const uint32_t S_ride = StateKey::idx(sourceIdx, Layer::Ride);
-  const uint32_t S_walk = StateKey::idx(sourceIdx, Layer::Walk);
-
-  // States
-  std::vector<double> gCost(2 * numNodes, INF);
-  // keep track of actual time
-  std::vector<double> gTime(2 * numNodes, INF);
-  std::vector<uint32_t> parent(2 * numNodes, UINT32_MAX);
-  // stores OUTPUT step label
-  std::vector<uint8_t> parentMode(2 * numNodes, 0);
-  // UINT32_MAX => mode switch
-  std::vector<uint32_t> parentEdge(2 * numNodes, UINT32_MAX);
-  std::vector<uint8_t> closed(2 * numNodes, 0);
-
-  gCost[S_ride] = 0.0;
-  gCost[S_walk] = 0.0;
-  gTime[S_ride] = 0.0;  // NEW
-  gTime[S_walk] = 0.0;  // NEW
-
-  // check for queue inclusion
-  std::vector<uint8_t> inQueue(2 * numNodes, 0);
-
-  std::priority_queue<PQItem> openPQ;
-  openPQ.push(
-      PQItem{gCost[S_ride] + heuristic(sourceIdx), sourceIdx, Layer::Ride});
-  openPQ.push(
-      PQItem{gCost[S_walk] + heuristic(sourceIdx), sourceIdx, Layer::Walk});
-
-  auto relaxEdge = [&](uint32_t u, Layer layerU, uint32_t v, uint32_t edgeIdx,
-                       double edgeTimeSec, double surfPenalty,
-                       uint8_t stepLabel) {
-    const uint32_t curIdx = StateKey::idx(u, layerU);
-    const uint32_t nextIdx = StateKey::idx(v, layerU);
-    const double tentativeCost = gCost[curIdx] + edgeTimeSec + surfPenalty;
-    const double tentativeTime = gTime[curIdx] + edgeTimeSec;
-    if (tentativeCost < gCost[nextIdx])
-    {
-      gCost[nextIdx] = tentativeCost;
-      gTime[nextIdx] = tentativeTime;
-      parent[nextIdx] = curIdx;
-      parentMode[nextIdx] = stepLabel;  // label this step for coloring
-      parentEdge[nextIdx] = edgeIdx;
+  SnappedGoal goal;
+  auto offerGoal = [&](double costS, double timeS, uint32_t parent,
+                       uint32_t source, uint32_t target, uint8_t stepLabel) {
+    if (costS >= goal.cost) return;
+    goal = SnappedGoal{costS, timeS, parent, source, target, stepLabel};
+  };
 
-      if (!inQueue[nextIdx])
+  if (!ends)
+  {
+    seed(sourceIdx, Layer::Ride, 0.0, 0.0, UINT32_MAX, 0);
+    seed(sourceIdx, Layer::Walk, 0.0, 0.0, UINT32_MAX, 0);
+  }
+  else
+  {
+    const auto& sources = ends->sources;
+    const auto& targets = ends->targets;
+    for (uint32_t s{0}; s < sources.size(); ++s)
+    {
+      const EdgePoint& from = sources[s];
+      for (Layer layer : {Layer::Ride, Layer::Walk})
       {
-        openPQ.push(PQItem{tentativeCost + heuristic(v), v, layerU});
-        inQueue[nextIdx] = 1;
+        double costS, timeS;
+        uint8_t stepLabel;
+        if (!partialEdgeCost<kKernel>(costs, edges, from.edgeIdx, layer,
+                                      1.0 - from.offset, costS, timeS,
+                                      stepLabel))
+          continue;
+        seed(edges.head(from.edgeIdx), layer, costS, timeS, from.edgeIdx,
+             stepLabel);
+
+        // Both points on this edge, target ahead: no node in between
+        for (uint32_t t{0}; t < targets.size(); ++t)
+        {
+          const EdgePoint& to = targets[t];
+          if (to.edgeIdx != from.edgeIdx || to.offset < from.offset) continue;
+          partialEdgeCost<kKernel>(costs, edges, to.edgeIdx, layer,
+                                   to.offset - from.offset, costS, timeS,
+                                   stepLabel);
+          offerGoal(costS, timeS, UINT32_MAX, s, t, stepLabel);
+        }
       }
     }
+  }
+
+  auto relaxEdge = [&](const SearchState& cur, uint32_t curIdx, uint32_t v,
+                       Layer layerU, uint32_t edgeIdx, double edgeTimeSec,
+                       double surfPenalty, uint8_t stepLabel) {
+    const uint32_t nextIdx = StateKey::idx(v, layerU);
+    SearchState& next = states.at(nextIdx);
+    const double tentativeCost = cur.gCost + edgeTimeSec + surfPenalty;
+    const double tentativeTime = cur.gTime + edgeTimeSec;
+    if (tentativeCost < next.gCost)
+    {
+      next.gCost = tentativeCost;
+      next.gTime = tentativeTime;
+      next.parent = curIdx;
+      next.parentMode = stepLabel;  // label this step for coloring
+      next.parentEdge = edgeIdx;
+
+      // Re-queue on every improvement so heap order matches the labels
+      // (lazy policies add a duplicate, the indexed heap decreases the key).
+      openPQ.push(tentativeCost + heuristic(v), nextIdx, next);
+      if constexpr (kSearchStats) ++stats.pushes;
+    }
   };
 
-  auto relaxSwitch = [&](uint32_t u, Layer from, Layer to, double penaltySec) {
-    const uint32_t curIdx = StateKey::idx(u, from);
+  auto relaxSwitch = [&](const SearchState& cur, uint32_t curIdx, uint32_t u,
+                         Layer to, double penaltySec) {
+    if constexpr (kSearchStats) ++stats.switchesRelaxed;
     const uint32_t nextIdx = StateKey::idx(u, to);
-    const double tentativeCost = gCost[curIdx] + penaltySec;
-    const double tentativeTime = gTime[curIdx];
-    if (tentativeCost < gCost[nextIdx])
+    SearchState& next = states.at(nextIdx);
+    const double tentativeCost = cur.gCost + penaltySec;
+    const double tentativeTime = cur.gTime;
+    if (tentativeCost < next.gCost)
     {
-      gCost[nextIdx] = tentativeCost;
-      gTime[nextIdx] = tentativeTime;
-      parent[nextIdx] = curIdx;
-      parentMode[nextIdx] = 0;  // special: switch (no edge)
-      parentEdge[nextIdx] = UINT32_MAX;
-      openPQ.push(PQItem{tentativeCost + heuristic(u), u, to});
+      next.gCost = tentativeCost;
+      next.gTime = tentativeTime;
+      next.parent = curIdx;
+      next.parentMode = 0;  // special: switch (no edge)
+      next.parentEdge = UINT32_MAX;
+      openPQ.push(tentativeCost + heuristic(u), nextIdx, next);
+      if constexpr (kSearchStats) ++stats.pushes;
     }
   };
 
   uint32_t goalState = UINT32_MAX;
+  uint32_t settled = 0;
+  SearchStatus status = SearchStatus::NoRoute;
+  timer.lap(stats.setupMs);
 
   while (!openPQ.empty())
   {
-    PQItem it = openPQ.top();
-    openPQ.pop();
-
-    const uint32_t u = it.nodeIdx;
-    const Layer layer = it.layer;
-    const uint32_t uIdx = StateKey::idx(u, layer);
-    if (closed[uIdx]) continue;
-    closed[uIdx] = 1;
+    const QueueEntry entry = openPQ.pop();
+    // Snapped: nothing left in the queue can beat the goal (goal.cost is
+    // infinite for node-to-node queries)
+    if (entry.priorityF >= goal.cost) break;
+    const uint32_t uIdx = entry.stateKey;
+    const uint32_t u = uIdx / StateKey::kLayers;
+    const Layer layer = static_cast<Layer>(uIdx % StateKey::kLayers);
+    SearchState& cur = states.at(uIdx);
+    if (cur.closed)
+    {
+      if constexpr (kSearchStats) ++stats.stalePops;
+      continue;
+    }
+    if (options.limits.reached(settled, status)) break;
+    cur.closed = 1;
+    ++settled;
+    if constexpr (kSearchStats)
+    {
+      ++(layer == Layer::Ride ? stats.settledRide : stats.settledWalk);
+      // Size before this pop: the queue only grows between pops
+      stats.maxQueueSize = std::max(stats.maxQueueSize,
+                                    static_cast<uint32_t>(openPQ.size() + 1));
+    }
 
-    if (u == targetIdx)
+    if (ends)
+    {
+      for (uint32_t t{0}; t < ends->targets.size(); ++t)
+      {
+        if (ends->targetTails[t] != u) continue;
+        const EdgePoint& to = ends->targets[t];
+        double costS, timeS;
+        uint8_t stepLabel;
+        if (partialEdgeCost<kKernel>(costs, edges, to.edgeIdx, layer,
+                                     to.offset, costS, timeS, stepLabel))
+          offerGoal(cur.gCost + costS, cur.gTime + timeS, uIdx, UINT32_MAX,
+                    t, stepLabel);
+      }
+    }
+    else if (u == targetIdx)
     {
       goalState = uIdx;
       break;
@@ -151,123 +213,239 @@ AStarResult aStarTwoLayer(const EdgesView& edgesView,
     {
       for (uint32_t edgeIdx{begin}; edgeIdx < end; ++edgeIdx)
       {
-        if ((edgesView.modeMask[edgeIdx] & EDGE_MASK_BIKE) == 0) continue;
-
-        const uint32_t v = edgesView.neighbors[edgeIdx];
-        const double len =
-            static_cast<double>(edgesView.lengthsMeters[edgeIdx]);
-        const uint8_t s =
-            edgesView.surfacePrimary ? edgesView.surfacePrimary[edgeIdx] : 0xFF;
-
-        // this will be added later
-        const double factor = edgesView.surfacePrimary
-                                  ? surfaceFactor(params.bikeSurfaceFactor, s)
-                                  : 1.0;
-        const double time_s = len * invBike * factor;
-
-        // Bike-only soft preference penalty + label
-        const bool preferred = isPreferredBike(s, params.bikeSurfaceMask);
-        const double surfPenalty = preferred ? 0.0 : (wSurfPerM * len);
-        const uint8_t stepLabel =
-            preferred ? MODE_BIKE_PREFERRED : MODE_BIKE_NON_PREFERRED;
-
-        relaxEdge(u, layer, v, edgeIdx, time_s, surfPenalty, stepLabel);
+        double time_s, surfPenalty;
+        uint8_t stepLabel;
+        if constexpr (kSearchStats) ++stats.edgesScanned;
+        if (!costs.ride<kKernel>(edges, edgeIdx, time_s, surfPenalty,
+                                 stepLabel))
+        {
+          if constexpr (kSearchStats) ++stats.edgesFiltered;
+          continue;
+        }
+
+        relaxEdge(cur, uIdx, edges.head(edgeIdx), layer, edgeIdx, time_s,
+                  surfPenalty, stepLabel);
       }
 
       if (params.rideToWalkPenaltyS >= 0.0)
       {
-        relaxSwitch(u, Layer::Ride, Layer::Walk, params.rideToWalkPenaltyS);
+        relaxSwitch(cur, uIdx, u, Layer::Walk, params.rideToWalkPenaltyS);
       }
     }
     else
     {  // Walk layer
       for (uint32_t edgeIdx{begin}; edgeIdx < end; ++edgeIdx)
       {
-        if ((edgesView.modeMask[edgeIdx] & EDGE_MASK_FOOT) == 0) continue;
-
-        const uint32_t v = edgesView.neighbors[edgeIdx];
-        const double len =
-            static_cast<double>(edgesView.lengthsMeters[edgeIdx]);
-        const uint8_t s =
-            edgesView.surfacePrimary ? edgesView.surfacePrimary[edgeIdx] : 0xFF;
-
-        const double factor = edgesView.surfacePrimary
-                                  ? surfaceFactor(params.walkSurfaceFactor, s)
-                                  : 1.0;
-        const double time_s = len * invWalk * factor;
-
-        relaxEdge(u, layer, v, edgeIdx, time_s, 0.0, MODE_FOOT);
+        double time_s;
+        if constexpr (kSearchStats) ++stats.edgesScanned;
+        if (!costs.walk<kKernel>(edges, edgeIdx, time_s))
+        {
+          if constexpr (kSearchStats) ++stats.edgesFiltered;
+          continue;
+        }
+
+        relaxEdge(cur, uIdx, edges.head(edgeIdx), layer, edgeIdx, time_s, 0.0,
+                  MODE_FOOT);
       }
 
       if (params.walkToRidePenaltyS >= 0.0)
       {
-        relaxSwitch(u, Layer::Walk, Layer::Ride, params.walkToRidePenaltyS);
+        relaxSwitch(cur, uIdx, u, Layer::Ride, params.walkToRidePenaltyS);
       }
     }
   }
 
+  timer.lap(stats.searchMs);
+
   AStarResult result;
-  if (goalState == UINT32_MAX)
+  result.settledStates = settled;
+  result.stats = stats;
+  // A snapped goal counts only if the search ran until it was proven best
+  const bool found = ends ? goal.cost < std::numeric_limits<double>::infinity()
+                                && status == SearchStatus::NoRoute
+                          : goalState != UINT32_MAX;
+  if (!found)
   {
     result.success = false;
+    result.status = status;
     return result;
   }
 
-  // Reconstruct states
-  std::vector<uint32_t> stateChain;
-  for (uint32_t cur{goalState}; cur != UINT32_MAX;)
+  auto edgeMeters = [&](uint32_t edgeIdx, double fraction) {
+    return fraction * static_cast<double>(edgesView.lengthsMeters[edgeIdx]);
+  };
+  const uint32_t lastState = ends ? goal.parent : goalState;
+  if (ends && lastState == UINT32_MAX)
   {
-    stateChain.push_back(cur);
-    uint32_t p = parent[cur];
-    if (p == UINT32_MAX) break;
-    cur = p;
+    // Source and target on the same edge
+    const EdgePoint& from = ends->sources[goal.source];
+    const EdgePoint& to = ends->targets[goal.target];
+    result.sourceStep =
+        PartialStep{to.edgeIdx, from.offset, to.offset, goal.mode};
+    addStepDistance(result, edgeMeters(to.edgeIdx, to.offset - from.offset),
+                    goal.mode);
   }
-  std::reverse(stateChain.begin(), stateChain.end());
-
-  // Outputs
-  result.pathNodes.clear();
-  result.pathModes.clear();
-  result.pathNodes.reserve(stateChain.size());
-  result.pathNodes.push_back(stateChain.front() / 2u);
-
-  double totalMeters = 0.0;
-
-  for (size_t i{1}; i < stateChain.size(); ++i)
+  else
   {
-    const uint32_t cur = stateChain[i];
+    // Reconstruct states
+    std::vector<uint32_t>& stateChain = workspace.stateChain;
+    stateChain.clear();
+    for (uint32_t cur{lastState}; cur != UINT32_MAX;)
+    {
+      stateChain.push_back(cur);
+      uint32_t p = states.at(cur).parent;
+      if (p == UINT32_MAX) break;
+      cur = p;
+    }
+    std::reverse(stateChain.begin(), stateChain.end());
 
-    if (parentEdge[cur] == UINT32_MAX)
+    // Outputs
+    if (ends)
     {
-      // Mode switch at same node (no distance)
-      continue;
+      const SearchState& first = states.at(stateChain.front());
+      const auto source = std::find_if(
+          ends->sources.begin(), ends->sources.end(),
+          [&](const EdgePoint& point) {
+            return point.edgeIdx == first.parentEdge;
+          });
+      result.sourceStep = PartialStep{first.parentEdge, source->offset, 1.0,
+                                      first.parentMode};
+      addStepDistance(result,
+                      edgeMeters(first.parentEdge, 1.0 - source->offset),
+                      first.parentMode);
     }
+    result.pathNodes.reserve(stateChain.size());
+    result.pathNodes.push_back(stateChain.front() / StateKey::kLayers);
 
-    const uint32_t edgeIdx = parentEdge[cur];
-    const uint32_t v = cur / 2u;
-    const double len = static_cast<double>(edgesView.lengthsMeters[edgeIdx]);
+    for (size_t i{1}; i < stateChain.size(); ++i)
+    {
+      const SearchState& cur = states.at(stateChain[i]);
 
-    totalMeters += len;
+      // Mode switch at same node (no distance)
+      if (cur.parentEdge == UINT32_MAX) continue;
 
-    switch (parentMode[cur])
+      appendStep(result, edgesView, cur.parentEdge, cur.parentMode,
+                 stateChain[i] / StateKey::kLayers);
+    }
+    if (ends)
     {
-      case MODE_FOOT:
-        result.distanceWalk += len;
-        break;
-      case MODE_BIKE_PREFERRED:
-        result.distanceBikePreferred += len;
-        break;
-      case MODE_BIKE_NON_PREFERRED:
-        result.distanceBikeNonPreferred += len;
-        break;
+      const EdgePoint& to = ends->targets[goal.target];
+      result.targetStep = PartialStep{to.edgeIdx, 0.0, to.offset, goal.mode};
+      addStepDistance(result, edgeMeters(to.edgeIdx, to.offset), goal.mode);
     }
-
-    result.pathModes.push_back(parentMode[cur]);  // keep exact label (preferred
-                                                  // / non-preferred / walk)
-    result.pathNodes.push_back(v);
   }
 
-  result.distanceM = totalMeters;
-  result.durationS = gTime[goalState];
+  result.durationS = ends ? goal.time : states.at(goalState).gTime;
+  result.costS = ends ? goal.cost : states.at(goalState).gCost;
   result.success = true;
+  result.status = SearchStatus::Found;
+  timer.lap(result.stats.reconstructMs);
   return result;
 }
+}  // namespace
+
+AStarResult aStarTwoLayer(const EdgesView& edgesView,
+                          const NodesView& nodesView, uint32_t sourceIdx,
+                          uint32_t targetIdx, const AStarParams& params,
+                          SearchWorkspace& workspace,
+                          const SearchOptions& options)
+{
+  if (options.direction == SearchDirection::Bidirectional)
+    return aStarBidirectional(edgesView, nodesView, sourceIdx, targetIdx,
+                              params, workspace, options);
+
+  validateQuery(edgesView, sourceIdx, targetIdx, params);
+  const StateStorage storage =
+      resolveStorage(nodesView, sourceIdx, targetIdx, options);
+  const CostModel costs(params, edgesView);
+
+  // Heuristic = optimistic time to target: straight line or landmark
+  // bound, whichever is larger, at the fastest possible speed
+  const TravelTimeBound heuristic(nodesView, options.landmarks, targetIdx,
+                                  sourceIdx, TravelTimeBound::Anchor::Target,
+                                  params);
+
+  return withSearchPolicies(
+      workspace, storage, options.queue,
+      [&](auto& states, auto& openPQ, auto& /*backwardStates*/,
+          auto& /*backwardPQ*/) {
+        return withCostKernel(costs.kernel(), [&](auto kernel) {
+          return withEdgeLayout(
+              edgesView, options.edgeLayout, [&](const auto& edges) {
+                return runAStar<decltype(kernel)::value>(
+                    edgesView, edges, sourceIdx, targetIdx, params, costs,
+                    heuristic, options, states, openPQ, workspace);
+              });
+        });
+      });
+}
+
+AStarResult aStarSnapped(const EdgesView& edgesView,
+                         const NodesView& nodesView,
+                         const std::vector<EdgePoint>& sources,
+                         const std::vector<EdgePoint>& targets,
+                         const AStarParams& params, SearchWorkspace& workspace,
+                         const SearchOptions& options)
+{
+  validateSnappedQuery(edgesView, sources, targets, params);
+
+  auto planar = [&](const EdgePoint& point, double& x, double& y) {
+    const uint32_t tail = edgeTail(edgesView, point.edgeIdx);
+    const uint32_t head = edgesView.neighbors[point.edgeIdx];
+    x = nodesView.xM[tail] + point.offset * (nodesView.xM[head] -
+                                             nodesView.xM[tail]);
+    y = nodesView.yM[tail] + point.offset * (nodesView.yM[head] -
+                                             nodesView.yM[tail]);
+  };
+
+  SnappedEnds ends{sources, targets, {}};
+  for (const EdgePoint& point : targets)
+    ends.targetTails.push_back(edgeTail(edgesView, point.edgeIdx));
+
+  // Straight line to the disc around the first target holding them all,
+  // or the landmark bound to the nearest target tail if larger
+  double centreX, centreY, radiusM{0.0};
+  planar(targets.front(), centreX, centreY);
+  for (const EdgePoint& point : targets)
+  {
+    double x, y;
+    planar(point, x, y);
+    radiusM = std::max(radiusM, std::hypot(x - centreX, y - centreY));
+  }
+  const TravelTimeBound heuristic(
+      nodesView, options.landmarks, centreX, centreY, radiusM,
+      ends.targetTails, edgesView.neighbors[sources.front().edgeIdx], params);
+
+  StateStorage storage = options.storage;
+  if (storage == StateStorage::Auto)
+  {
+    double x, y;
+    planar(sources.front(), x, y);
+    storage = std::hypot(x - centreX, y - centreY) <= options.sparseMaxMeters
+                  ? StateStorage::Sparse
+                  : StateStorage::Dense;
+  }
+  const CostModel costs(params, edgesView);
+
+  return withSearchPolicies(
+      workspace, storage, options.queue,
+      [&](auto& states, auto& openPQ, auto& /*backwardStates*/,
+          auto& /*backwardPQ*/) {
+        return withCostKernel(costs.kernel(), [&](auto kernel) {
+          return withEdgeLayout(
+              edgesView, options.edgeLayout, [&](const auto& edges) {
+                return runAStar<decltype(kernel)::value>(
+                    edgesView, edges, UINT32_MAX, UINT32_MAX, params, costs,
+                    heuristic, options, states, openPQ, workspace, &ends);
+              });
+        });
+      });
+}
+
+AStarResult aStarTwoLayer(const EdgesView& edgesView,
+                          const NodesView& nodesView, uint32_t sourceIdx,
+                          uint32_t targetIdx, const AStarParams& params)
+{
+  return aStarTwoLayer(edgesView, nodesView, sourceIdx, targetIdx, params,
+                       SearchWorkspace::forThisThread());
+}
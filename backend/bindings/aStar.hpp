@@ -1,11 +1,17 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <cmath>  // std::isfinite
 #include <cstddef>
 #include <cstdint>
+#include <memory>
+#include <mutex>
 #include <vector>
 
+#include "priorityQueues.hpp"
 #include "route.hpp"
+#include "searchWorkspace.hpp"
 
 // ---------------- Two-mode A* over CSR ----------------
 
@@ -72,9 +78,105 @@ struct AStarParams
   double surfacePenaltySPerKm = 0.0;
 };
 
+// Canonical form of everything in AStarParams that changes a search: two
+// params with equal keys give identical routes. Factor lists are read the
+// way surfaceFactor() reads them (invalid -> 1.0, trailing 1.0s dropped),
+// disabled switches all map to -1.
+inline std::vector<double> profileKey(const AStarParams& params)
+{
+  auto factors = [](const std::vector<double>& in) {
+    std::vector<double> out(in.size());
+    for (std::size_t i{0}; i < in.size(); ++i)
+      out[i] = (std::isfinite(in[i]) && in[i] > 0.0) ? in[i] : 1.0;
+    while (!out.empty() && out.back() == 1.0) out.pop_back();
+    return out;
+  };
+  auto switchPenalty = [](double penaltyS) {
+    return penaltyS >= 0.0 ? penaltyS : -1.0;
+  };
+
+  const std::vector<double> bike = factors(params.bikeSurfaceFactor);
+  const std::vector<double> walk = factors(params.walkSurfaceFactor);
+  std::vector<double> key{static_cast<double>(params.bikeSurfaceMask),
+                          params.bikeSpeedMps,
+                          params.walkSpeedMps,
+                          switchPenalty(params.rideToWalkPenaltyS),
+                          switchPenalty(params.walkToRidePenaltyS),
+                          params.surfacePenaltySPerKm,
+                          static_cast<double>(bike.size())};
+  key.insert(key.end(), bike.begin(), bike.end());
+  key.insert(key.end(), walk.begin(), walk.end());
+  return key;
+}
+
+// How a search ended. Only Found carries a route; the stopped states mean
+// the search gave up early, not that no route exists.
+enum class SearchStatus : std::uint8_t
+{
+  Found = 0,
+  NoRoute = 1,           // every reachable state settled
+  DeadlineExceeded = 2,  // SearchLimits::deadline passed
+  BudgetExceeded = 3,    // SearchLimits::maxSettledStates settled
+  Cancelled = 4          // SearchLimits::cancelled set
+};
+
+// Per-query counters of the A* searches, for telling a 2 ms query from an
+// 80 ms one. Build with -DROUTE_SEARCH_STATS=1 to collect them; otherwise
+// every update compiles away and they stay zero. The bidirectional search
+// sums both sides; the CCH query collects none.
+#ifndef ROUTE_SEARCH_STATS
+#define ROUTE_SEARCH_STATS 0
+#endif
+inline constexpr bool kSearchStats = ROUTE_SEARCH_STATS != 0;
+
+struct SearchStats
+{
+  std::uint32_t settledRide{0};
+  std::uint32_t settledWalk{0};
+  std::uint32_t pushes{0};
+  std::uint32_t stalePops{0};  // entries of already settled states
+  std::uint32_t maxQueueSize{0};
+  std::uint32_t edgesScanned{0};
+  std::uint32_t edgesFiltered{0};  // not usable in the layer (modeMask)
+  std::uint32_t switchesRelaxed{0};
+  // Bidirectional only: settles per side (the counters above sum both)
+  std::uint32_t settledForward{0};
+  std::uint32_t settledBackward{0};
+
+  // Wall time: state reset and seeding / main loop / path build
+  double setupMs{0.0};
+  double searchMs{0.0};
+  double reconstructMs{0.0};
+
+  bool collected{false};  // set by a search built with stats
+};
+
+// A route end inside an edge: the point at offset (0 = tail, 1 = head)
+// along edgeIdx, as EdgeSnapIndex finds it.
+struct EdgePoint
+{
+  std::uint32_t edgeIdx{UINT32_MAX};
+  double offset{0.0};
+};
+
+// The part of an edge a snapped route travels at one of its ends: edgeIdx
+// from fromOffset to toOffset. edgeIdx == UINT32_MAX if the end is a node.
+struct PartialStep
+{
+  std::uint32_t edgeIdx{UINT32_MAX};
+  double fromOffset{0.0};
+  double toOffset{0.0};
+  std::uint8_t mode{0};  // MODE_* label of the step
+
+  bool present() const noexcept { return edgeIdx != UINT32_MAX; }
+};
+
 struct AStarResult
 {
   bool success{false};
+  SearchStatus status{SearchStatus::NoRoute};
+  std::uint32_t settledStates{0};
+  SearchStats stats;  // all zero unless kSearchStats
 
   // Node indices s..t
   std::vector<std::uint32_t> pathNodes;
@@ -82,8 +184,15 @@ struct AStarResult
   // MODE_* for each step between nodes; length = pathNodes.size()-1
   std::vector<std::uint8_t> pathModes;
 
+  // Snapped queries only: source point -> pathNodes.front() and
+  // pathNodes.back() -> target point. pathNodes is empty if both points lie
+  // on one edge; sourceStep then runs from one to the other.
+  PartialStep sourceStep;
+  PartialStep targetStep;
+
   double distanceM{0.0};
   double durationS{0.0};
+  double costS{0.0};  // search objective: durationS plus all penalties
 
   // Distances per mode (aggregates)
   double distanceBikePreferred{0.0};
@@ -103,24 +212,172 @@ struct StateKey
   }
 };
 
-struct PQItem
+enum class SearchDirection : std::uint8_t
+{
+  Forward = 0,       // single A* from the source
+  Bidirectional = 1  // forward + backward A* over the incoming CSR
+};
+
+enum class EdgeLayout : std::uint8_t
 {
-  // f(n) = g(n) + h(n): the estimated total trip time if you go through n
-  // Min-heap behavior with std::priority_queue via reversed comparison.
-  double priorityF;       // f = g + h
-  std::uint32_t nodeIdx;  // graph node
-  Layer layer;            // Ride/Walk
+  Auto = 0,    // packed records when the graph has them
+  Packed = 1,  // 8-byte records (EdgesView::packed)
+  Soa = 2      // separate neighbor / length / surface / mode arrays
+};
+
+// Cooperative stop conditions for one query. The search loops count settled
+// states and poll these; the clock and the flag are read only every
+// kPollInterval states, so an unlimited query pays one compare per state.
+struct SearchLimits
+{
+  using Clock = std::chrono::steady_clock;
+  inline static constexpr std::uint32_t kPollInterval{256};
+
+  Clock::time_point deadline{Clock::time_point::max()};
+  std::uint32_t maxSettledStates{0};  // 0 = unlimited
+  // Set from another thread (JS cancel handle); nullptr = not cancellable
+  const std::atomic<bool>* cancelled{nullptr};
 
-  bool operator<(const PQItem& rhs) const noexcept
+  // true (and why) once the search should stop
+  bool reached(std::uint32_t settled, SearchStatus& status) const noexcept
   {
-    return priorityF > rhs.priorityF;
+    if (maxSettledStates != 0 && settled >= maxSettledStates)
+    {
+      status = SearchStatus::BudgetExceeded;
+      return true;
+    }
+    if (settled % kPollInterval != 0) return false;
+    if (cancelled && cancelled->load(std::memory_order_relaxed))
+    {
+      status = SearchStatus::Cancelled;
+      return true;
+    }
+    if (deadline != Clock::time_point::max() && Clock::now() >= deadline)
+    {
+      status = SearchStatus::DeadlineExceeded;
+      return true;
+    }
+    return false;
   }
 };
 
+// Engine knobs that do not change the route, only how it is searched
+// (limits may stop it before a route is found).
+struct SearchOptions
+{
+  StateStorage storage{StateStorage::Auto};
+  QueuePolicy queue{ROUTE_DEFAULT_QUEUE};
+  SearchDirection direction{SearchDirection::Forward};
+  EdgeLayout edgeLayout{EdgeLayout::Auto};
+
+  // Auto picks Sparse when the straight-line s-t distance is below this.
+  double sparseMaxMeters{2500.0};
+
+  // Landmark tables for the ALT heuristic; nullptr = straight line only.
+  const LandmarksView* landmarks{nullptr};
+
+  SearchLimits limits;
+};
+
+// Labels and open set for one search direction.
+struct SearchSide
+{
+  DenseStateStore dense;
+  SparseStateStore sparse;
+  BinaryHeapQueue binaryHeap;
+  IndexedDaryHeap<4> daryHeap;
+  RadixHeapQueue radixHeap;
+};
+
+// Scratch memory for aStarTwoLayer. One per thread, reused across queries so
+// a short route no longer pays for allocating and filling 2 * numNodes
+// labels. The backward side is only allocated by bidirectional queries.
+// Not thread-safe.
+struct SearchWorkspace
+{
+  SearchSide forward;
+  SearchSide backward;
+  std::vector<std::uint32_t> stateChain;  // reconstruction scratch
+
+  // Workspace owned by the calling thread (libuv pool threads live for the
+  // whole process, so this is allocated once per worker).
+  static SearchWorkspace& forThisThread()
+  {
+    static thread_local SearchWorkspace workspace;
+    return workspace;
+  }
+};
+
+// Workspaces for threads started per call (matrix rows, batches), which
+// would rebuild a thread_local workspace every time. Process-wide.
+class WorkspacePool
+{
+ public:
+  std::unique_ptr<SearchWorkspace> acquire()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (free.empty()) return std::make_unique<SearchWorkspace>();
+    std::unique_ptr<SearchWorkspace> workspace = std::move(free.back());
+    free.pop_back();
+    return workspace;
+  }
+
+  void release(std::unique_ptr<SearchWorkspace> workspace)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    free.push_back(std::move(workspace));
+  }
+
+  static WorkspacePool& shared()
+  {
+    static WorkspacePool pool;
+    return pool;
+  }
+
+ private:
+  std::mutex mutex;
+  std::vector<std::unique_ptr<SearchWorkspace>> free;
+};
+
 // IMPORTANT: Do NOT mark this 'static' in the header unless you also define it
 // inline here. If the definition lives in a .cpp, keep it as a normal
 // declaration like below.
 [[nodiscard]]
+AStarResult aStarTwoLayer(const EdgesView& edgesView,
+                          const NodesView& nodesView, std::uint32_t sourceIdx,
+                          std::uint32_t targetIdx, const AStarParams& params,
+                          SearchWorkspace& workspace,
+                          const SearchOptions& options = {});
+
+// Bidirectional variant: a backward search from the target over incoming
+// edges (EdgesView::in*) meets the forward one. Same costs and result as
+// aStarTwoLayer; usually reached through SearchOptions::direction.
+[[nodiscard]]
+AStarResult aStarBidirectional(const EdgesView& edgesView,
+                               const NodesView& nodesView,
+                               std::uint32_t sourceIdx, std::uint32_t targetIdx,
+                               const AStarParams& params,
+                               SearchWorkspace& workspace,
+                               const SearchOptions& options = {});
+
+// Route between points inside edges (EdgeSnap candidates, one per edge on
+// each side). Every source seeds the head of its edge with the cost of the
+// rest of that edge; the route ends at whichever target is cheapest to
+// reach through its tail plus the part of its edge up to the point. So a
+// point mid-block starts on the right side of a one-way street, and
+// several candidates compete in one search. Forward A* only (direction is
+// ignored); the heuristic is the larger of the straight line to the
+// targets and the landmark bound to their nearest tail.
+[[nodiscard]]
+AStarResult aStarSnapped(const EdgesView& edgesView,
+                         const NodesView& nodesView,
+                         const std::vector<EdgePoint>& sources,
+                         const std::vector<EdgePoint>& targets,
+                         const AStarParams& params, SearchWorkspace& workspace,
+                         const SearchOptions& options = {});
+
+// Convenience overload: uses the calling thread's workspace.
+[[nodiscard]]
 AStarResult aStarTwoLayer(const EdgesView& edgesView,
                           const NodesView& nodesView, std::uint32_t sourceIdx,
                           std::uint32_t targetIdx, const AStarParams& params);
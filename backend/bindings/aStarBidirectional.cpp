@@ -0,0 +1,339 @@
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+
+#include "aStar.hpp"
+#include "searchCommon.hpp"
+
+// ---------------- Bidirectional two-layer A* ----------------
+// Forward search from (s, Ride|Walk) over outgoing edges, backward search
+// from (t, Ride|Walk) over incoming edges. Both sides use the same state
+// keys and edge costs. In the backward search a mode switch is walked in
+// reverse: leaving (u, Walk) backwards means the forward path switched
+// Ride -> Walk at u, so it costs rideToWalkPenaltyS (and vice versa).
+//
+// Potentials: with hT(v) / hS(v) the lower bounds to t / from s,
+// pF(v) = (hT(v) - hS(v)) / 2 and pB = -pF are both feasible, so each side
+// is a Dijkstra on non-negative reduced costs. Keys are g + p, and the
+// search may stop once topF + topB >= mu (best s-t cost seen so far).
+namespace
+{
+template <CostKernel kKernel, class Edges, class StateStore, class OpenQueue>
+AStarResult runBidirectional(const EdgesView& edgesView, const Edges& edges,
+                             const NodesView& nodesView, uint32_t sourceIdx,
+                             uint32_t targetIdx, const AStarParams& params,
+                             const CostModel& costs,
+                             const SearchOptions& options, StateStore& forward,
+                             OpenQueue& forwardPQ, StateStore& backward,
+                             OpenQueue& backwardPQ,
+                             SearchWorkspace& workspace)
+{
+  const double INF = std::numeric_limits<double>::infinity();
+  const uint32_t numNodes = edgesView.numNodes;
+  SearchStats stats;
+  stats.collected = kSearchStats;
+  PhaseTimer timer;
+
+  const TravelTimeBound toTarget(nodesView, options.landmarks, targetIdx,
+                                 sourceIdx, TravelTimeBound::Anchor::Target,
+                                 params);
+  const TravelTimeBound fromSource(nodesView, options.landmarks, sourceIdx,
+                                   targetIdx, TravelTimeBound::Anchor::Source,
+                                   params);
+  auto potential = [&](uint32_t nodeIdx) {
+    return 0.5 * (toTarget(nodeIdx) - fromSource(nodeIdx));
+  };
+
+  forward.reset(StateKey::kLayers * numNodes);
+  backward.reset(StateKey::kLayers * numNodes);
+  forwardPQ.clear();
+  backwardPQ.clear();
+
+  double mu = INF;  // best s-t cost found so far
+  uint32_t meetState = UINT32_MAX;
+
+  auto seed = [&](StateStore& states, OpenQueue& openPQ, uint32_t nodeIdx,
+                  double key) {
+    for (Layer layer : {Layer::Ride, Layer::Walk})
+    {
+      const uint32_t stateIdx = StateKey::idx(nodeIdx, layer);
+      SearchState& state = states.at(stateIdx);
+      state.gCost = 0.0;
+      state.gTime = 0.0;
+      openPQ.push(key, stateIdx, state);
+      if constexpr (kSearchStats) ++stats.pushes;
+    }
+  };
+  seed(forward, forwardPQ, sourceIdx, potential(sourceIdx));
+  seed(backward, backwardPQ, targetIdx, -potential(targetIdx));
+  if (sourceIdx == targetIdx)
+  {
+    mu = 0.0;
+    meetState = StateKey::idx(sourceIdx, Layer::Ride);
+  }
+
+  // Improve a label on one side; record a meeting if the other side has
+  // already reached the same state.
+  auto relax = [&](StateStore& states, OpenQueue& openPQ, StateStore& other,
+                   double keySign, const SearchState& cur, uint32_t curIdx,
+                   uint32_t nextIdx, uint32_t edgeIdx, double timeSec,
+                   double costSec, uint8_t stepLabel) {
+    if constexpr (kSearchStats)
+      if (edgeIdx == UINT32_MAX) ++stats.switchesRelaxed;
+    SearchState& next = states.at(nextIdx);
+    const double tentativeCost = cur.gCost + costSec;
+    if (!(tentativeCost < next.gCost)) return;
+
+    next.gCost = tentativeCost;
+    next.gTime = cur.gTime + timeSec;
+    next.parent = curIdx;
+    next.parentMode = stepLabel;
+    next.parentEdge = edgeIdx;
+    openPQ.push(tentativeCost +
+                    keySign * potential(nextIdx / StateKey::kLayers),
+                nextIdx, next);
+    if constexpr (kSearchStats) ++stats.pushes;
+
+    const double meet = tentativeCost + other.costOf(nextIdx);
+    if (meet < mu)
+    {
+      mu = meet;
+      meetState = nextIdx;
+    }
+  };
+
+  auto countSettled = [&](uint32_t uIdx, uint32_t& sideSettled) {
+    ++(static_cast<Layer>(uIdx % StateKey::kLayers) == Layer::Ride
+           ? stats.settledRide
+           : stats.settledWalk);
+    ++sideSettled;
+    // Both queues before this pop: they only grow between pops
+    stats.maxQueueSize = std::max(
+        stats.maxQueueSize,
+        static_cast<uint32_t>(forwardPQ.size() + backwardPQ.size() + 1));
+  };
+
+  auto settleForward = [&](uint32_t uIdx) {
+    SearchState& cur = forward.at(uIdx);
+    if (cur.closed)
+    {
+      if constexpr (kSearchStats) ++stats.stalePops;
+      return false;
+    }
+    cur.closed = 1;
+    if constexpr (kSearchStats) countSettled(uIdx, stats.settledForward);
+
+    const uint32_t u = uIdx / StateKey::kLayers;
+    const uint32_t begin = edgesView.offsets[u];
+    const uint32_t end = edgesView.offsets[u + 1];
+
+    if (static_cast<Layer>(uIdx % StateKey::kLayers) == Layer::Ride)
+    {
+      for (uint32_t edgeIdx{begin}; edgeIdx < end; ++edgeIdx)
+      {
+        double timeS, penaltyS;
+        uint8_t stepLabel;
+        if constexpr (kSearchStats) ++stats.edgesScanned;
+        if (!costs.ride<kKernel>(edges, edgeIdx, timeS, penaltyS, stepLabel))
+        {
+          if constexpr (kSearchStats) ++stats.edgesFiltered;
+          continue;
+        }
+        relax(forward, forwardPQ, backward, +1.0, cur, uIdx,
+              StateKey::idx(edges.head(edgeIdx), Layer::Ride),
+              edgeIdx, timeS, timeS + penaltyS, stepLabel);
+      }
+      if (params.rideToWalkPenaltyS >= 0.0)
+        relax(forward, forwardPQ, backward, +1.0, cur, uIdx,
+              StateKey::idx(u, Layer::Walk), UINT32_MAX, 0.0,
+              params.rideToWalkPenaltyS, 0);
+    }
+    else
+    {
+      for (uint32_t edgeIdx{begin}; edgeIdx < end; ++edgeIdx)
+      {
+        double timeS;
+        if constexpr (kSearchStats) ++stats.edgesScanned;
+        if (!costs.walk<kKernel>(edges, edgeIdx, timeS))
+        {
+          if constexpr (kSearchStats) ++stats.edgesFiltered;
+          continue;
+        }
+        relax(forward, forwardPQ, backward, +1.0, cur, uIdx,
+              StateKey::idx(edges.head(edgeIdx), Layer::Walk),
+              edgeIdx, timeS, timeS, MODE_FOOT);
+      }
+      if (params.walkToRidePenaltyS >= 0.0)
+        relax(forward, forwardPQ, backward, +1.0, cur, uIdx,
+              StateKey::idx(u, Layer::Ride), UINT32_MAX, 0.0,
+              params.walkToRidePenaltyS, 0);
+    }
+    return true;
+  };
+
+  // Backward labels: parent is the next state towards t and parentEdge the
+  // forward edge that leads there.
+  auto settleBackward = [&](uint32_t uIdx) {
+    SearchState& cur = backward.at(uIdx);
+    if (cur.closed)
+    {
+      if constexpr (kSearchStats) ++stats.stalePops;
+      return false;
+    }
+    cur.closed = 1;
+    if constexpr (kSearchStats) countSettled(uIdx, stats.settledBackward);
+
+    const uint32_t u = uIdx / StateKey::kLayers;
+    const uint32_t begin = edgesView.inOffsets[u];
+    const uint32_t end = edgesView.inOffsets[u + 1];
+
+    if (static_cast<Layer>(uIdx % StateKey::kLayers) == Layer::Ride)
+    {
+      for (uint32_t inIdx{begin}; inIdx < end; ++inIdx)
+      {
+        const uint32_t edgeIdx = edgesView.inEdgeIds[inIdx];
+        double timeS, penaltyS;
+        uint8_t stepLabel;
+        if constexpr (kSearchStats) ++stats.edgesScanned;
+        if (!costs.ride<kKernel>(edges, edgeIdx, timeS, penaltyS, stepLabel))
+        {
+          if constexpr (kSearchStats) ++stats.edgesFiltered;
+          continue;
+        }
+        relax(backward, backwardPQ, forward, -1.0, cur, uIdx,
+              StateKey::idx(edgesView.inSources[inIdx], Layer::Ride), edgeIdx,
+              timeS, timeS + penaltyS, stepLabel);
+      }
+      // Forward path switched Walk -> Ride here
+      if (params.walkToRidePenaltyS >= 0.0)
+        relax(backward, backwardPQ, forward, -1.0, cur, uIdx,
+              StateKey::idx(u, Layer::Walk), UINT32_MAX, 0.0,
+              params.walkToRidePenaltyS, 0);
+    }
+    else
+    {
+      for (uint32_t inIdx{begin}; inIdx < end; ++inIdx)
+      {
+        const uint32_t edgeIdx = edgesView.inEdgeIds[inIdx];
+        double timeS;
+        if constexpr (kSearchStats) ++stats.edgesScanned;
+        if (!costs.walk<kKernel>(edges, edgeIdx, timeS))
+        {
+          if constexpr (kSearchStats) ++stats.edgesFiltered;
+          continue;
+        }
+        relax(backward, backwardPQ, forward, -1.0, cur, uIdx,
+              StateKey::idx(edgesView.inSources[inIdx], Layer::Walk), edgeIdx,
+              timeS, timeS, MODE_FOOT);
+      }
+      // Forward path switched Ride -> Walk here
+      if (params.rideToWalkPenaltyS >= 0.0)
+        relax(backward, backwardPQ, forward, -1.0, cur, uIdx,
+              StateKey::idx(u, Layer::Ride), UINT32_MAX, 0.0,
+              params.rideToWalkPenaltyS, 0);
+    }
+    return true;
+  };
+
+  uint32_t settled = 0;
+  SearchStatus status = SearchStatus::NoRoute;
+  bool stopped = false;
+  timer.lap(stats.setupMs);
+  while (!forwardPQ.empty() || !backwardPQ.empty())
+  {
+    const double topF = forwardPQ.empty() ? INF : forwardPQ.topKey();
+    const double topB = backwardPQ.empty() ? INF : backwardPQ.topKey();
+    if (topF + topB >= mu) break;
+    if (options.limits.reached(settled, status))
+    {
+      stopped = true;
+      break;
+    }
+
+    const bool settledOne = topF <= topB
+                                ? settleForward(forwardPQ.pop().stateKey)
+                                : settleBackward(backwardPQ.pop().stateKey);
+    if (settledOne) ++settled;
+  }
+  timer.lap(stats.searchMs);
+
+  AStarResult result;
+  result.settledStates = settled;
+  result.stats = stats;
+  // A meeting found before the stop is not proven shortest: no route
+  if (meetState == UINT32_MAX || stopped)
+  {
+    result.success = false;
+    result.status = status;
+    return result;
+  }
+
+  // s .. meet from forward parents
+  std::vector<uint32_t>& stateChain = workspace.stateChain;
+  stateChain.clear();
+  for (uint32_t cur{meetState}; cur != UINT32_MAX;
+       cur = forward.at(cur).parent)
+  {
+    stateChain.push_back(cur);
+  }
+  std::reverse(stateChain.begin(), stateChain.end());
+
+  result.pathNodes.reserve(stateChain.size());
+  result.pathNodes.push_back(stateChain.front() / StateKey::kLayers);
+  for (size_t i{1}; i < stateChain.size(); ++i)
+  {
+    const SearchState& cur = forward.at(stateChain[i]);
+    if (cur.parentEdge == UINT32_MAX) continue;  // mode switch
+    appendStep(result, edgesView, cur.parentEdge, cur.parentMode,
+               stateChain[i] / StateKey::kLayers);
+  }
+
+  // meet .. t from backward parents (each label describes its own step)
+  for (uint32_t cur{meetState};;)
+  {
+    const SearchState& label = backward.at(cur);
+    if (label.parent == UINT32_MAX) break;
+    if (label.parentEdge != UINT32_MAX)
+      appendStep(result, edgesView, label.parentEdge, label.parentMode,
+                 label.parent / StateKey::kLayers);
+    cur = label.parent;
+  }
+
+  result.durationS = forward.at(meetState).gTime + backward.at(meetState).gTime;
+  result.costS = mu;
+  result.success = true;
+  result.status = SearchStatus::Found;
+  timer.lap(result.stats.reconstructMs);
+  return result;
+}
+}  // namespace
+
+AStarResult aStarBidirectional(const EdgesView& edgesView,
+                               const NodesView& nodesView, uint32_t sourceIdx,
+                               uint32_t targetIdx, const AStarParams& params,
+                               SearchWorkspace& workspace,
+                               const SearchOptions& options)
+{
+  validateQuery(edgesView, sourceIdx, targetIdx, params);
+  if (!edgesView.inOffsets || !edgesView.inSources || !edgesView.inEdgeIds)
+    throw std::runtime_error("bidirectional search needs the incoming CSR");
+
+  const StateStorage storage =
+      resolveStorage(nodesView, sourceIdx, targetIdx, options);
+  const CostModel costs(params, edgesView);
+
+  return withSearchPolicies(
+      workspace, storage, options.queue,
+      [&](auto& forward, auto& forwardPQ, auto& backward, auto& backwardPQ) {
+        return withCostKernel(costs.kernel(), [&](auto kernel) {
+          return withEdgeLayout(
+              edgesView, options.edgeLayout, [&](const auto& edges) {
+                return runBidirectional<decltype(kernel)::value>(
+                    edgesView, edges, nodesView, sourceIdx, targetIdx, params,
+                    costs, options, forward, forwardPQ, backward, backwardPQ,
+                    workspace);
+              });
+        });
+      });
+}
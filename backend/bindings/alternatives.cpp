@@ -0,0 +1,359 @@
+#include "alternatives.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "searchCommon.hpp"
+
+namespace
+{
+constexpr double kInf = std::numeric_limits<double>::infinity();
+
+// Candidate routes examined per query, accepted or not
+constexpr std::size_t kMaxCandidates = 256;
+
+// Plain Dijkstra in both directions (same relaxations as
+// runBidirectional without potentials). Each side stops once its smallest
+// key passes (1 + maxStretch) * mu. Returns mu, the best s-t cost, and
+// lists the states the forward side settled.
+template <CostKernel kKernel, class Edges, class StateStore, class OpenQueue>
+double exploreBothSides(const EdgesView& edgesView, const Edges& edges,
+                        uint32_t sourceIdx, uint32_t targetIdx,
+                        const AStarParams& params, const CostModel& costs,
+                        double maxStretch, StateStore& forward,
+                        OpenQueue& forwardPQ, StateStore& backward,
+                        OpenQueue& backwardPQ,
+                        std::vector<uint32_t>& forwardSettled)
+{
+  forward.reset(StateKey::kLayers * edgesView.numNodes);
+  backward.reset(StateKey::kLayers * edgesView.numNodes);
+  forwardPQ.clear();
+  backwardPQ.clear();
+  forwardSettled.clear();
+
+  double mu = kInf;
+  auto seed = [&](StateStore& states, OpenQueue& openPQ, uint32_t nodeIdx) {
+    for (Layer layer : {Layer::Ride, Layer::Walk})
+    {
+      const uint32_t stateIdx = StateKey::idx(nodeIdx, layer);
+      SearchState& state = states.at(stateIdx);
+      state.gCost = 0.0;
+      state.gTime = 0.0;
+      openPQ.push(0.0, stateIdx, state);
+    }
+  };
+  seed(forward, forwardPQ, sourceIdx);
+  seed(backward, backwardPQ, targetIdx);
+  if (sourceIdx == targetIdx) mu = 0.0;
+
+  auto relax = [&](StateStore& states, OpenQueue& openPQ, StateStore& other,
+                   const SearchState& cur, uint32_t curIdx, uint32_t nextIdx,
+                   uint32_t edgeIdx, double timeSec, double costSec,
+                   uint8_t stepLabel) {
+    SearchState& next = states.at(nextIdx);
+    const double tentativeCost = cur.gCost + costSec;
+    if (!(tentativeCost < next.gCost)) return;
+
+    next.gCost = tentativeCost;
+    next.gTime = cur.gTime + timeSec;
+    next.parent = curIdx;
+    next.parentMode = stepLabel;
+    next.parentEdge = edgeIdx;
+    openPQ.push(tentativeCost, nextIdx, next);
+    mu = std::min(mu, tentativeCost + other.costOf(nextIdx));
+  };
+
+  auto settleForward = [&](uint32_t uIdx) {
+    SearchState& cur = forward.at(uIdx);
+    if (cur.closed) return;
+    cur.closed = 1;
+    forwardSettled.push_back(uIdx);
+
+    const uint32_t u = uIdx / StateKey::kLayers;
+    const uint32_t begin = edgesView.offsets[u];
+    const uint32_t end = edgesView.offsets[u + 1];
+
+    if (static_cast<Layer>(uIdx % StateKey::kLayers) == Layer::Ride)
+    {
+      for (uint32_t edgeIdx{begin}; edgeIdx < end; ++edgeIdx)
+      {
+        double timeS, penaltyS;
+        uint8_t stepLabel;
+        if (!costs.ride<kKernel>(edges, edgeIdx, timeS, penaltyS, stepLabel))
+          continue;
+        relax(forward, forwardPQ, backward, cur, uIdx,
+              StateKey::idx(edges.head(edgeIdx), Layer::Ride), edgeIdx, timeS,
+              timeS + penaltyS, stepLabel);
+      }
+      if (params.rideToWalkPenaltyS >= 0.0)
+        relax(forward, forwardPQ, backward, cur, uIdx,
+              StateKey::idx(u, Layer::Walk), UINT32_MAX, 0.0,
+              params.rideToWalkPenaltyS, 0);
+    }
+    else
+    {
+      for (uint32_t edgeIdx{begin}; edgeIdx < end; ++edgeIdx)
+      {
+        double timeS;
+        if (!costs.walk<kKernel>(edges, edgeIdx, timeS)) continue;
+        relax(forward, forwardPQ, backward, cur, uIdx,
+              StateKey::idx(edges.head(edgeIdx), Layer::Walk), edgeIdx, timeS,
+              timeS, MODE_FOOT);
+      }
+      if (params.walkToRidePenaltyS >= 0.0)
+        relax(forward, forwardPQ, backward, cur, uIdx,
+              StateKey::idx(u, Layer::Ride), UINT32_MAX, 0.0,
+              params.walkToRidePenaltyS, 0);
+    }
+  };
+
+  // Backward labels point towards t, as in runBidirectional
+  auto settleBackward = [&](uint32_t uIdx) {
+    SearchState& cur = backward.at(uIdx);
+    if (cur.closed) return;
+    cur.closed = 1;
+
+    const uint32_t u = uIdx / StateKey::kLayers;
+    const uint32_t begin = edgesView.inOffsets[u];
+    const uint32_t end = edgesView.inOffsets[u + 1];
+
+    if (static_cast<Layer>(uIdx % StateKey::kLayers) == Layer::Ride)
+    {
+      for (uint32_t inIdx{begin}; inIdx < end; ++inIdx)
+      {
+        const uint32_t edgeIdx = edgesView.inEdgeIds[inIdx];
+        double timeS, penaltyS;
+        uint8_t stepLabel;
+        if (!costs.ride<kKernel>(edges, edgeIdx, timeS, penaltyS, stepLabel))
+          continue;
+        relax(backward, backwardPQ, forward, cur, uIdx,
+              StateKey::idx(edgesView.inSources[inIdx], Layer::Ride), edgeIdx,
+              timeS, timeS + penaltyS, stepLabel);
+      }
+      if (params.walkToRidePenaltyS >= 0.0)
+        relax(backward, backwardPQ, forward, cur, uIdx,
+              StateKey::idx(u, Layer::Walk), UINT32_MAX, 0.0,
+              params.walkToRidePenaltyS, 0);
+    }
+    else
+    {
+      for (uint32_t inIdx{begin}; inIdx < end; ++inIdx)
+      {
+        const uint32_t edgeIdx = edgesView.inEdgeIds[inIdx];
+        double timeS;
+        if (!costs.walk<kKernel>(edges, edgeIdx, timeS)) continue;
+        relax(backward, backwardPQ, forward, cur, uIdx,
+              StateKey::idx(edgesView.inSources[inIdx], Layer::Walk), edgeIdx,
+              timeS, timeS, MODE_FOOT);
+      }
+      if (params.rideToWalkPenaltyS >= 0.0)
+        relax(backward, backwardPQ, forward, cur, uIdx,
+              StateKey::idx(u, Layer::Ride), UINT32_MAX, 0.0,
+              params.rideToWalkPenaltyS, 0);
+    }
+  };
+
+  while (true)
+  {
+    const double bound = (1.0 + maxStretch) * mu;
+    const double topF = forwardPQ.empty() ? kInf : forwardPQ.topKey();
+    const double topB = backwardPQ.empty() ? kInf : backwardPQ.topKey();
+    if (std::min(topF, topB) > bound || (topF == kInf && topB == kInf))
+      break;
+
+    if (topF <= topB)
+      settleForward(forwardPQ.pop().stateKey);
+    else
+      settleBackward(backwardPQ.pop().stateKey);
+  }
+  return mu;
+}
+
+// One state of a candidate route with the cost and time from s
+struct RouteStep
+{
+  uint32_t state;
+  uint32_t edgeIdx;  // edge into this state, UINT32_MAX for s or a switch
+  uint8_t stepLabel;
+  double costS;
+  double timeS;
+};
+
+// s -> via from the forward tree, via -> t from the backward tree
+template <class StateStore>
+void viaRoute(StateStore& forward, StateStore& backward, uint32_t viaState,
+              std::vector<RouteStep>& steps)
+{
+  steps.clear();
+  for (uint32_t cur{viaState}; cur != UINT32_MAX;)
+  {
+    const SearchState& label = forward.at(cur);
+    steps.push_back({cur, UINT32_MAX, 0, label.gCost, label.gTime});
+    if (label.parent != UINT32_MAX)
+    {
+      steps.back().edgeIdx = label.parentEdge;
+      steps.back().stepLabel = label.parentMode;
+    }
+    cur = label.parent;
+  }
+  std::reverse(steps.begin(), steps.end());
+
+  const SearchState& viaBackward = backward.at(viaState);
+  const double viaCost = steps.back().costS + viaBackward.gCost;
+  const double viaTime = steps.back().timeS + viaBackward.gTime;
+  for (uint32_t cur{viaState};;)
+  {
+    const SearchState& label = backward.at(cur);
+    if (label.parent == UINT32_MAX) break;
+    const SearchState& next = backward.at(label.parent);
+    steps.push_back({label.parent, label.parentEdge, label.parentMode,
+                     viaCost - next.gCost, viaTime - next.gTime});
+    cur = label.parent;
+  }
+}
+
+AStarResult toResult(const EdgesView& edgesView,
+                     const std::vector<RouteStep>& steps)
+{
+  AStarResult result;
+  result.pathNodes.push_back(steps.front().state / StateKey::kLayers);
+  for (std::size_t i{1}; i < steps.size(); ++i)
+  {
+    if (steps[i].edgeIdx == UINT32_MAX) continue;  // mode switch
+    appendStep(result, edgesView, steps[i].edgeIdx, steps[i].stepLabel,
+               steps[i].state / StateKey::kLayers);
+  }
+  result.durationS = steps.back().timeS;
+  result.costS = steps.back().costS;
+  result.success = true;
+  result.status = SearchStatus::Found;
+  return result;
+}
+
+bool visitsNodeTwice(const std::vector<RouteStep>& steps)
+{
+  std::unordered_set<uint32_t> seen;
+  uint32_t prevNode = UINT32_MAX;
+  for (const RouteStep& step : steps)
+  {
+    const uint32_t nodeIdx = step.state / StateKey::kLayers;
+    if (nodeIdx == prevNode) continue;  // mode switch in place
+    if (!seen.insert(nodeIdx).second) return true;
+    prevNode = nodeIdx;
+  }
+  return false;
+}
+}  // namespace
+
+std::vector<AStarResult> alternativeRoutes(
+    const EdgesView& edgesView, uint32_t sourceIdx, uint32_t targetIdx,
+    const AStarParams& params, SearchWorkspace& workspace,
+    const SearchOptions& options, const AlternativeOptions& alternatives)
+{
+  validateQuery(edgesView, sourceIdx, targetIdx, params);
+  if (!edgesView.inOffsets || !edgesView.inSources || !edgesView.inEdgeIds)
+    throw std::runtime_error("alternative routes need the incoming CSR");
+  if (!(alternatives.maxStretch >= 0.0) || !(alternatives.maxOverlap >= 0.0) ||
+      !(alternatives.localOptimality >= 0.0))
+    throw std::runtime_error(
+        "maxStretch, maxOverlap and localOptimality must be >= 0");
+
+  const CostModel costs(params, edgesView);
+
+  std::vector<AStarResult> routes;
+  withSearchPolicies(
+      workspace, StateStorage::Dense, options.queue,
+      [&](auto& forward, auto& forwardPQ, auto& backward, auto& backwardPQ) {
+        std::vector<uint32_t> settled;
+        const double mu = withCostKernel(costs.kernel(), [&](auto kernel) {
+          return withEdgeLayout(
+              edgesView, options.edgeLayout, [&](const auto& edges) {
+                return exploreBothSides<decltype(kernel)::value>(
+                    edgesView, edges, sourceIdx, targetIdx, params, costs,
+                    alternatives.maxStretch, forward, forwardPQ, backward,
+                    backwardPQ, settled);
+              });
+        });
+        if (mu == kInf || alternatives.maxRoutes == 0) return;
+
+        // A plateau is a stretch both trees share: forward parent of v is
+        // u and backward parent of u is v. Its cost up to each state is
+        // summed in forward settle order, so parents come first.
+        auto onBothTrees = [&](uint32_t stateIdx) {
+          return forward.at(stateIdx).closed && backward.at(stateIdx).closed;
+        };
+        std::unordered_map<uint32_t, double> plateauTo;
+        for (uint32_t stateIdx : settled)
+        {
+          if (!backward.at(stateIdx).closed) continue;
+          const SearchState& label = forward.at(stateIdx);
+          const uint32_t parent = label.parent;
+          const bool extends = parent != UINT32_MAX && onBothTrees(parent) &&
+                               backward.at(parent).parent == stateIdx;
+          plateauTo[stateIdx] =
+              extends ? plateauTo[parent] + label.gCost -
+                            forward.at(parent).gCost
+                      : 0.0;
+        }
+
+        // One candidate per plateau, at its t end (every state on a plateau
+        // gives the same route), cheapest route first
+        const double bound = (1.0 + alternatives.maxStretch) * mu;
+        const double minPlateau = alternatives.localOptimality * mu;
+        std::vector<std::pair<double, uint32_t>> candidates;
+        for (const auto& [stateIdx, plateauCost] : plateauTo)
+        {
+          const uint32_t next = backward.at(stateIdx).parent;
+          if (next != UINT32_MAX && onBothTrees(next) &&
+              forward.at(next).parent == stateIdx)
+            continue;  // not the end of its plateau
+          const double total =
+              forward.at(stateIdx).gCost + backward.at(stateIdx).gCost;
+          if (total <= bound && plateauCost >= minPlateau)
+            candidates.emplace_back(total, stateIdx);
+        }
+        std::sort(candidates.begin(), candidates.end());
+
+        std::unordered_set<uint32_t> routeEdges;  // edges of kept routes
+        std::vector<RouteStep> steps;
+        std::size_t examined = 0;
+
+        for (const auto& [total, viaState] : candidates)
+        {
+          if (routes.size() >= alternatives.maxRoutes ||
+              ++examined > kMaxCandidates)
+            break;
+
+          viaRoute(forward, backward, viaState, steps);
+          if (!routes.empty())
+          {
+            if (visitsNodeTwice(steps)) continue;
+
+            double lengthM = 0.0;
+            double sharedM = 0.0;
+            for (const RouteStep& step : steps)
+            {
+              if (step.edgeIdx == UINT32_MAX) continue;
+              const double len = edgesView.lengthsMeters[step.edgeIdx];
+              lengthM += len;
+              if (routeEdges.count(step.edgeIdx)) sharedM += len;
+            }
+            if (sharedM > alternatives.maxOverlap * lengthM) continue;
+          }
+
+          for (const RouteStep& step : steps)
+          {
+            if (step.edgeIdx != UINT32_MAX) routeEdges.insert(step.edgeIdx);
+          }
+          routes.push_back(toResult(edgesView, steps));
+        }
+      });
+  return routes;
+}
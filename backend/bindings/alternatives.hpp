@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "aStar.hpp"
+#include "route.hpp"
+
+// ---------------- Alternative routes ----------------
+// Plateau alternatives from one forward and one backward Dijkstra, both
+// run until their keys pass (1 + maxStretch) * best cost. A plateau is a
+// stretch of states on which the two shortest path trees agree; the route
+// through it (s -> plateau on the forward tree, plateau -> t on the
+// backward tree) is optimal along the whole plateau. Candidates are tried
+// cheapest first and kept if
+//   - the route costs at most (1 + maxStretch) * best,
+//   - the plateau spans at least localOptimality * best cost,
+//   - at most maxOverlap of its length is on routes already kept,
+//   - it does not visit a node twice.
+
+struct AlternativeOptions
+{
+  std::uint32_t maxRoutes{3};  // including the best route
+  double maxStretch{0.25};
+  double maxOverlap{0.6};
+  double localOptimality{0.25};
+};
+
+// Best route first, then up to maxRoutes - 1 alternatives by cost. Empty if
+// t is unreachable. Needs the incoming CSR.
+[[nodiscard]]
+std::vector<AStarResult> alternativeRoutes(
+    const EdgesView& edgesView, std::uint32_t sourceIdx,
+    std::uint32_t targetIdx, const AStarParams& params,
+    SearchWorkspace& workspace, const SearchOptions& options = {},
+    const AlternativeOptions& alternatives = {});
@@ -0,0 +1,109 @@
+#include "batch.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+RouteBatch findPathsBatch(const EdgesView& edgesView,
+                          const NodesView& nodesView, const CchView* cch,
+                          const std::vector<BatchProfile>& profiles,
+                          const std::vector<BatchQuery>& queries,
+                          unsigned numThreads)
+{
+  for (const BatchQuery& query : queries)
+  {
+    if (query.profile >= profiles.size())
+      throw std::runtime_error("batch query names an unknown profile");
+    if (profiles[query.profile].cchMetric && !cch)
+      throw std::runtime_error("batch profile needs the cch");
+  }
+
+  // Searches fill per-query results; the flat arrays are built afterwards
+  std::vector<AStarResult> results(queries.size());
+  std::vector<std::string> errors(queries.size());
+  std::atomic<std::size_t> nextQuery{0};
+
+  auto worker = [&]() {
+    WorkspacePool& pool = WorkspacePool::shared();
+    std::unique_ptr<SearchWorkspace> workspace = pool.acquire();
+    CchScratch scratch;  // allocated on the first CCH query only
+
+    for (std::size_t i = nextQuery++; i < queries.size(); i = nextQuery++)
+    {
+      const BatchQuery& query = queries[i];
+      const BatchProfile& profile = profiles[query.profile];
+      try
+      {
+        if (profile.cchMetric)
+          results[i] = cchQuery(*cch, *profile.cchMetric, edgesView,
+                                query.sourceIdx, query.targetIdx,
+                                profile.params, scratch);
+        else
+          results[i] = aStarTwoLayer(edgesView, nodesView, query.sourceIdx,
+                                     query.targetIdx, profile.params,
+                                     *workspace, profile.options);
+      } catch (const std::exception& e)
+      {
+        errors[i] = e.what();
+      }
+    }
+
+    pool.release(std::move(workspace));
+  };
+
+  // More threads only on request: each one is outside any pool the
+  // caller runs on
+  numThreads = static_cast<unsigned>(
+      std::max<std::size_t>(1, std::min<std::size_t>(numThreads,
+                                                      queries.size())));
+
+  std::vector<std::thread> threads;
+  threads.reserve(numThreads - 1);
+  for (unsigned i{1}; i < numThreads; ++i) threads.emplace_back(worker);
+  worker();  // the calling thread takes queries too
+  for (std::thread& thread : threads) thread.join();
+
+  // A bad query (index out of range, invalid speeds) fails the batch the
+  // same way it would fail findPath.
+  for (const std::string& error : errors)
+  {
+    if (!error.empty()) throw std::runtime_error(error);
+  }
+
+  const double INF = std::numeric_limits<double>::infinity();
+  RouteBatch batch;
+  std::size_t totalNodes = 0;
+  for (const AStarResult& result : results)
+    totalNodes += result.pathNodes.size();
+
+  batch.pathOffsets.reserve(results.size() + 1);
+  batch.path.reserve(totalNodes);
+  batch.modes.reserve(totalNodes);
+  batch.pathOffsets.push_back(0);
+  for (const AStarResult& result : results)
+  {
+    if (!result.pathNodes.empty())
+    {
+      batch.path.insert(batch.path.end(), result.pathNodes.begin(),
+                        result.pathNodes.end());
+      batch.modes.push_back(0);
+      batch.modes.insert(batch.modes.end(), result.pathModes.begin(),
+                         result.pathModes.end());
+    }
+    batch.pathOffsets.push_back(static_cast<uint32_t>(batch.path.size()));
+
+    batch.success.push_back(result.success ? 1 : 0);
+    batch.durationsS.push_back(result.success ? result.durationS : INF);
+    batch.distancesM.push_back(result.success ? result.distanceM : INF);
+    batch.distancesBikePreferred.push_back(result.distanceBikePreferred);
+    batch.distancesBikeNonPreferred.push_back(
+        result.distanceBikeNonPreferred);
+    batch.distancesWalk.push_back(result.distanceWalk);
+  }
+  return batch;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "aStar.hpp"
+#include "cch.hpp"
+#include "route.hpp"
+
+// ---------------- Batched route queries ----------------
+// Many (source, target) pairs in one call, spread over threads. Each query
+// names a profile; a profile is parsed once however many queries use it.
+
+struct BatchProfile
+{
+  AStarParams params;
+  SearchOptions options;
+  // Non-null: answer this profile's queries with the CCH instead of A*
+  std::shared_ptr<const CchMetric> cchMetric;
+};
+
+struct BatchQuery
+{
+  std::uint32_t sourceIdx;
+  std::uint32_t targetIdx;
+  std::uint32_t profile;  // index into the profiles
+};
+
+// Routes of query i are path[pathOffsets[i] .. pathOffsets[i + 1]).
+// modes runs alongside path: modes[k] labels the step that ends at path[k]
+// (0 for the first node of each route). Failed queries have an empty
+// range, success 0 and infinite duration and distance.
+struct RouteBatch
+{
+  std::vector<std::uint32_t> pathOffsets;  // numQueries + 1
+  std::vector<std::uint32_t> path;
+  std::vector<std::uint8_t> modes;
+
+  std::vector<std::uint8_t> success;
+  std::vector<double> durationsS;
+  std::vector<double> distancesM;
+  std::vector<double> distancesBikePreferred;
+  std::vector<double> distancesBikeNonPreferred;
+  std::vector<double> distancesWalk;
+};
+
+// numThreads counts the calling thread (0 = 1: that thread only). cch may
+// be nullptr if no profile has a cchMetric.
+[[nodiscard]]
+RouteBatch findPathsBatch(const EdgesView& edgesView,
+                          const NodesView& nodesView, const CchView* cch,
+                          const std::vector<BatchProfile>& profiles,
+                          const std::vector<BatchQuery>& queries,
+                          unsigned numThreads = 0);
@@ -2,7 +2,8 @@
   "targets": [
     {
       "target_name": "kd_snap",
-      "sources": [ "kd_snap.cpp" ],
+      "sources": [ "kd_snap.cpp", "graphLoader.cpp",
+                   "../../ingest/writeBins.cpp" ],
       "include_dirs": [
         "<!@(node -p \"require('node-addon-api').include\")",
         "/opt/homebrew/include",
@@ -27,7 +28,11 @@
     },
     {
       "target_name": "route",
-      "sources": [ "route.cpp", "aStar.cpp" ],
+      "sources": [ "route.cpp", "graphLoader.cpp", "aStar.cpp",
+                   "aStarBidirectional.cpp", "alternatives.cpp", "batch.cpp",
+                   "cch.cpp", "isochrone.cpp", "matrix.cpp", "routeCache.cpp",
+                   "routePool.cpp", "routeGeometry.cpp", "edgeSnap.cpp",
+                   "../../ingest/writeBins.cpp" ],
             "include_dirs": [
         "<!@(node -p \"require('node-addon-api').include\")",
         "/opt/homebrew/include",
@@ -0,0 +1,669 @@
+#include "cch.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+#include "binHeaders.hpp"
+#include "edgeSnap.hpp"
+#include "graphLoader.hpp"
+#include "searchCommon.hpp"
+
+uint32_t CchView::findArc(uint32_t lower, uint32_t higher) const
+{
+  const uint32_t* begin = head + firstOut[lower];
+  const uint32_t* end = head + firstOut[lower + 1];
+  const uint32_t* it = std::lower_bound(begin, end, higher);
+  if (it == end || *it != higher) return UINT32_MAX;
+  return static_cast<uint32_t>(it - head);
+}
+
+CchView loadCch(const std::string& filePath, const EdgesView& edgesView)
+{
+  auto mapping = mapReadonlySp(filePath);
+  const char* cursor = static_cast<const char*>(mapping->base);
+  const char* endPtr = cursor + mapping->size;
+
+  auto requireBytes = [&](size_t bytes) {
+    if (cursor + bytes > endPtr)
+    {
+      throw std::runtime_error("cch bin truncated: " + filePath);
+    }
+  };
+
+  requireBytes(sizeof(ingest::CchHeader));
+  const auto* header = reinterpret_cast<const ingest::CchHeader*>(cursor);
+  if (std::memcmp(header->magic, "MMAPCCHO", 8) != 0)
+  {
+    throw std::runtime_error("bad cch header: " + filePath);
+  }
+  if (header->numNodes != edgesView.numNodes ||
+      header->numEdges != edgesView.numEdges)
+  {
+    throw std::runtime_error("cch bin does not match the graph: " + filePath);
+  }
+  cursor += sizeof(*header);
+
+  CchView cch;
+  cch.hold = mapping;
+  cch.numNodes = header->numNodes;
+  cch.numStates = 2 * header->numNodes;
+  cch.numArcs = header->numArcs;
+
+  requireBytes(sizeof(uint32_t) * cch.numNodes);
+  cch.nodeRank = reinterpret_cast<const uint32_t*>(cursor);
+  cursor += sizeof(uint32_t) * cch.numNodes;
+
+  requireBytes(sizeof(uint32_t) * (size_t(cch.numStates) + 1));
+  cch.firstOut = reinterpret_cast<const uint32_t*>(cursor);
+  cursor += sizeof(uint32_t) * (size_t(cch.numStates) + 1);
+
+  requireBytes(sizeof(uint32_t) * size_t(cch.numArcs));
+  cch.head = reinterpret_cast<const uint32_t*>(cursor);
+  cursor += sizeof(uint32_t) * size_t(cch.numArcs);
+
+  if (cch.firstOut[0] != 0 || cch.firstOut[cch.numStates] != cch.numArcs)
+  {
+    throw std::runtime_error("bad cch offsets: " + filePath);
+  }
+
+  // Node order must be a permutation
+  std::vector<uint8_t> rankUsed(cch.numNodes, 0);
+  for (uint32_t v{0}; v < cch.numNodes; ++v)
+  {
+    const uint32_t rank = cch.nodeRank[v];
+    if (rank >= cch.numNodes || rankUsed[rank])
+      throw std::runtime_error("bad cch node order: " + filePath);
+    rankUsed[rank] = 1;
+  }
+
+  // Elimination tree: parent = lowest upward neighbor
+  cch.parent.assign(cch.numStates, UINT32_MAX);
+  for (uint32_t x{0}; x < cch.numStates; ++x)
+  {
+    const uint32_t begin = cch.firstOut[x];
+    const uint32_t end = cch.firstOut[x + 1];
+    for (uint32_t a{begin}; a < end; ++a)
+    {
+      if (cch.head[a] <= x || cch.head[a] >= cch.numStates ||
+          (a > begin && cch.head[a] <= cch.head[a - 1]))
+        throw std::runtime_error("bad cch arcs: " + filePath);
+    }
+    if (begin < end) cch.parent[x] = cch.head[begin];
+  }
+
+  // Input arcs of the state graph
+  auto arcOf = [&](uint32_t a, uint32_t b) {
+    if (a == b) return UINT32_MAX;
+    const uint32_t arc = cch.findArc(std::min(a, b), std::max(a, b));
+    if (arc == UINT32_MAX)
+      throw std::runtime_error("cch bin misses a graph edge: " + filePath);
+    return arc;
+  };
+  cch.rideArc.assign(edgesView.numEdges, UINT32_MAX);
+  cch.walkArc.assign(edgesView.numEdges, UINT32_MAX);
+  cch.switchArc.assign(cch.numNodes, UINT32_MAX);
+  for (uint32_t u{0}; u < cch.numNodes; ++u)
+  {
+    const uint32_t ride = cch.vertex(u, Layer::Ride);
+    const uint32_t walk = cch.vertex(u, Layer::Walk);
+    cch.switchArc[u] = arcOf(ride, walk);
+    for (uint32_t e{edgesView.offsets[u]}; e < edgesView.offsets[u + 1]; ++e)
+    {
+      const uint32_t v = edgesView.neighbors[e];
+      if (edgesView.modeMask[e] & EDGE_MASK_BIKE)
+        cch.rideArc[e] = arcOf(ride, cch.vertex(v, Layer::Ride));
+      if (edgesView.modeMask[e] & EDGE_MASK_FOOT)
+        cch.walkArc[e] = arcOf(walk, cch.vertex(v, Layer::Walk));
+    }
+  }
+
+  return cch;
+}
+
+// ---------------- Customization ----------------
+
+std::shared_ptr<const CchMetric> customizeCch(const CchView& cch,
+                                              const EdgesView& edgesView,
+                                              const AStarParams& params)
+{
+  const float INF = std::numeric_limits<float>::infinity();
+  auto metric = std::make_shared<CchMetric>();
+  metric->up.assign(cch.numArcs, INF);
+  metric->down.assign(cch.numArcs, INF);
+  metric->upVia.assign(cch.numArcs, CchMetric::kViaNone);
+  metric->downVia.assign(cch.numArcs, CchMetric::kViaNone);
+  float* up = metric->up.data();
+  float* down = metric->down.data();
+  uint32_t* upVia = metric->upVia.data();
+  uint32_t* downVia = metric->downVia.data();
+
+  // Input arcs: cheapest parallel edge per direction
+  auto input = [&](uint32_t arc, uint32_t from, uint32_t to, double cost,
+                   uint32_t via) {
+    const float weight = static_cast<float>(cost);
+    float& slot = from < to ? up[arc] : down[arc];
+    uint32_t& slotVia = from < to ? upVia[arc] : downVia[arc];
+    if (weight < slot)
+    {
+      slot = weight;
+      slotVia = via;
+    }
+  };
+
+  const CostModel costs(params, edgesView);
+  const SoaEdges edges(edgesView);
+  for (uint32_t u{0}; u < cch.numNodes; ++u)
+  {
+    const uint32_t ride = cch.vertex(u, Layer::Ride);
+    const uint32_t walk = cch.vertex(u, Layer::Walk);
+    if (params.rideToWalkPenaltyS >= 0.0)
+      input(cch.switchArc[u], ride, walk, params.rideToWalkPenaltyS,
+            CchMetric::kViaSwitch);
+    if (params.walkToRidePenaltyS >= 0.0)
+      input(cch.switchArc[u], walk, ride, params.walkToRidePenaltyS,
+            CchMetric::kViaSwitch);
+
+    for (uint32_t e{edgesView.offsets[u]}; e < edgesView.offsets[u + 1]; ++e)
+    {
+      const uint32_t v = edgesView.neighbors[e];
+      double timeS, penaltyS;
+      uint8_t stepLabel;
+      if (cch.rideArc[e] != UINT32_MAX &&
+          costs.ride(edges, e, timeS, penaltyS, stepLabel))
+        input(cch.rideArc[e], ride, cch.vertex(v, Layer::Ride),
+              timeS + penaltyS, CchMetric::kViaEdge | e);
+      if (cch.walkArc[e] != UINT32_MAX && costs.walk(edges, e, timeS))
+        input(cch.walkArc[e], walk, cch.vertex(v, Layer::Walk), timeS,
+              CchMetric::kViaEdge | e);
+    }
+  }
+
+  // Lower triangles in rank order: once u is reached, both arcs (u, v) and
+  // (u, w) are final and improve (v, w) through u.
+  for (uint32_t u{0}; u < cch.numStates; ++u)
+  {
+    const uint32_t end = cch.firstOut[u + 1];
+    for (uint32_t i{cch.firstOut[u]}; i < end; ++i)
+    {
+      const float upUV = up[i];
+      const float downUV = down[i];
+      if (upUV == INF && downUV == INF) continue;
+
+      // Every later head w of u needs the arc (v, w): the bin must be
+      // chordal. loadCch does not check that, so it is checked here. Once
+      // v's last head is >= u's, the scan for w cannot leave v's row.
+      const uint32_t v = cch.head[i];
+      uint32_t k = cch.firstOut[v];
+      const uint32_t endV = cch.firstOut[v + 1];
+      if (i + 1 < end && (k == endV || cch.head[endV - 1] < cch.head[end - 1]))
+        throw std::runtime_error("cch bin is not chordal at state " +
+                                 std::to_string(v));
+      for (uint32_t j{i + 1}; j < end; ++j)
+      {
+        const uint32_t w = cch.head[j];
+        while (cch.head[k] < w) ++k;
+        if (cch.head[k] != w)
+          throw std::runtime_error("cch bin is not chordal: no arc (" +
+                                   std::to_string(v) + ", " +
+                                   std::to_string(w) + ")");
+
+        const float viaUp = downUV + up[j];  // v -> u -> w
+        if (viaUp < up[k])
+        {
+          up[k] = viaUp;
+          upVia[k] = u;
+        }
+        const float viaDown = down[j] + upUV;  // w -> u -> v
+        if (viaDown < down[k])
+        {
+          down[k] = viaDown;
+          downVia[k] = u;
+        }
+      }
+    }
+  }
+
+  return metric;
+}
+
+std::shared_ptr<const CchMetric> CchMetricCache::get(
+    const CchView& cch, const EdgesView& edgesView, const AStarParams& params)
+{
+  std::vector<double> key = profileKey(params);
+  std::promise<std::shared_ptr<const CchMetric>> promise;
+  std::shared_future<std::shared_ptr<const CchMetric>> metric;
+  uint64_t ownId = 0;  // != 0 if this call customizes
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = std::find_if(entries.begin(), entries.end(),
+                           [&](const Entry& entry) { return entry.key == key; });
+    if (it != entries.end())
+    {
+      entries.splice(entries.begin(), entries, it);
+      metric = it->metric;
+    }
+    else
+    {
+      ownId = ++nextId;
+      metric = promise.get_future().share();
+      entries.push_front(Entry{std::move(key), metric, ownId});
+      if (entries.size() > capacity) entries.pop_back();
+    }
+  }
+
+  if (ownId != 0)
+  {
+    try
+    {
+      promise.set_value(customizeCch(cch, edgesView, params));
+    } catch (...)
+    {
+      // Waiters get the error; later calls try again
+      promise.set_exception(std::current_exception());
+      std::lock_guard<std::mutex> lock(mutex);
+      entries.remove_if([&](const Entry& entry) { return entry.id == ownId; });
+    }
+  }
+  return metric.get();
+}
+
+void CchMetricCache::clear()
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  entries.clear();
+}
+
+// ---------------- Query ----------------
+
+void CchScratch::reset(uint32_t numStates)
+{
+  if (forward.size() != numStates)
+  {
+    const Label empty{0.0f, UINT32_MAX, UINT32_MAX, 0};
+    forward.assign(numStates, empty);
+    backward.assign(numStates, empty);
+    generation = 0;
+  }
+  if (++generation == 0)
+  {
+    for (Label& label : forward) label.stamp = 0;
+    for (Label& label : backward) label.stamp = 0;
+    generation = 1;
+  }
+}
+
+namespace
+{
+constexpr float kInf = std::numeric_limits<float>::infinity();
+
+float distOf(const CchScratch::Label& label, uint32_t generation)
+{
+  return label.stamp == generation ? label.dist : kInf;
+}
+
+// Upward sweep along the elimination tree from both layers of one node.
+// Ride and walk vertex of a node are adjacent ranks joined by the switch
+// arc, so the walk vertex is the ride vertex's parent and one chain covers
+// both starts.
+void sweep(const CchView& cch, const std::vector<float>& weights,
+           std::vector<CchScratch::Label>& labels, uint32_t generation,
+           uint32_t nodeIdx, std::vector<uint32_t>& chain)
+{
+  const uint32_t start = cch.vertex(nodeIdx, Layer::Ride);
+  labels[start] = {0.0f, UINT32_MAX, UINT32_MAX, generation};
+  labels[start + 1] = {0.0f, UINT32_MAX, UINT32_MAX, generation};
+
+  chain.clear();
+  for (uint32_t x{start}; x != UINT32_MAX; x = cch.parent[x])
+  {
+    chain.push_back(x);
+    const float dist = distOf(labels[x], generation);
+    if (dist == kInf) continue;
+
+    for (uint32_t a{cch.firstOut[x]}; a < cch.firstOut[x + 1]; ++a)
+    {
+      const float next = dist + weights[a];
+      CchScratch::Label& label = labels[cch.head[a]];
+      if (next < distOf(label, generation))
+        label = {next, a, x, generation};
+    }
+  }
+}
+
+// A sweep start inside an edge: the vertex at the edge's end, the cost of
+// the share travelled to reach it, and the snapped point it stands for.
+struct Seed
+{
+  uint32_t vertex;
+  float dist;
+  uint32_t point;
+};
+
+// sweep() from several starts. Their chains join towards the root, so the
+// union is relaxed in rank order; a seed label keeps its point in tail.
+void sweepSeeds(const CchView& cch, const std::vector<float>& weights,
+                std::vector<CchScratch::Label>& labels, uint32_t generation,
+                const std::vector<Seed>& seeds, std::vector<uint32_t>& chain)
+{
+  chain.clear();
+  for (const Seed& seed : seeds)
+  {
+    CchScratch::Label& label = labels[seed.vertex];
+    if (seed.dist < distOf(label, generation))
+      label = {seed.dist, UINT32_MAX, seed.point, generation};
+    for (uint32_t x{seed.vertex}; x != UINT32_MAX; x = cch.parent[x])
+      chain.push_back(x);
+  }
+  std::sort(chain.begin(), chain.end());
+  chain.erase(std::unique(chain.begin(), chain.end()), chain.end());
+
+  for (uint32_t x : chain)
+  {
+    const float dist = distOf(labels[x], generation);
+    if (dist == kInf) continue;
+
+    for (uint32_t a{cch.firstOut[x]}; a < cch.firstOut[x + 1]; ++a)
+    {
+      const float next = dist + weights[a];
+      CchScratch::Label& label = labels[cch.head[a]];
+      if (next < distOf(label, generation))
+        label = {next, a, x, generation};
+    }
+  }
+}
+
+// Expand one CCH arc walked lower -> higher (upward) or back into graph
+// edges, in travel order.
+struct Unpacker
+{
+  const CchView& cch;
+  const CchMetric& metric;
+  const EdgesView& edgesView;
+  const CostModel costs;
+  AStarResult& result;
+
+  struct Item
+  {
+    uint32_t arc;
+    uint32_t lower;
+    uint32_t higher;
+    bool upward;
+  };
+  std::vector<Item> stack;
+
+  void run(uint32_t arc, uint32_t lower, uint32_t higher, bool upward)
+  {
+    stack.push_back({arc, lower, higher, upward});
+    while (!stack.empty())
+    {
+      const Item item = stack.back();
+      stack.pop_back();
+
+      const uint32_t via =
+          item.upward ? metric.upVia[item.arc] : metric.downVia[item.arc];
+      if (via == CchMetric::kViaSwitch) continue;  // no distance
+      if (via & CchMetric::kViaEdge)
+      {
+        emitEdge(via & ~CchMetric::kViaEdge, static_cast<Layer>(item.lower & 1));
+        continue;
+      }
+
+      // Shortcut through the lower vertex `via`; push in reverse order
+      const uint32_t toLower = cch.findArc(via, item.lower);
+      const uint32_t toHigher = cch.findArc(via, item.higher);
+      if (item.upward)
+      {
+        stack.push_back({toHigher, via, item.higher, true});
+        stack.push_back({toLower, via, item.lower, false});
+      }
+      else
+      {
+        stack.push_back({toLower, via, item.lower, true});
+        stack.push_back({toHigher, via, item.higher, false});
+      }
+    }
+  }
+
+  void emitEdge(uint32_t edgeIdx, Layer layer)
+  {
+    double timeS = 0.0;
+    uint8_t stepLabel = MODE_FOOT;
+    if (layer == Layer::Ride)
+    {
+      double penaltyS;
+      costs.ride(SoaEdges(edgesView), edgeIdx, timeS, penaltyS, stepLabel);
+    }
+    else
+    {
+      costs.walk(SoaEdges(edgesView), edgeIdx, timeS);
+    }
+    appendStep(result, edgesView, edgeIdx, stepLabel,
+               edgesView.neighbors[edgeIdx]);
+    result.durationS += timeS;
+  }
+};
+}  // namespace
+
+AStarResult cchQuery(const CchView& cch, const CchMetric& metric,
+                     const EdgesView& edgesView, uint32_t sourceIdx,
+                     uint32_t targetIdx, const AStarParams& params,
+                     CchScratch& scratch)
+{
+  validateQuery(edgesView, sourceIdx, targetIdx, params);
+  if (cch.numStates != 2 * edgesView.numNodes)
+    throw std::runtime_error("cch does not match the graph");
+
+  scratch.reset(cch.numStates);
+  const uint32_t generation = scratch.generation;
+
+  sweep(cch, metric.up, scratch.forward, generation, sourceIdx,
+        scratch.chain);
+  sweep(cch, metric.down, scratch.backward, generation, targetIdx,
+        scratch.chain);
+
+  // The backward chain ends in the common ancestors; the best meeting
+  // vertex is on it.
+  float best = kInf;
+  uint32_t meet = UINT32_MAX;
+  for (uint32_t x : scratch.chain)
+  {
+    const float total = distOf(scratch.forward[x], generation) +
+                        distOf(scratch.backward[x], generation);
+    if (total < best)
+    {
+      best = total;
+      meet = x;
+    }
+  }
+
+  AStarResult result;
+  if (meet == UINT32_MAX)
+  {
+    result.success = false;
+    return result;
+  }
+
+  Unpacker unpacker{
+      cch, metric, edgesView, CostModel(params, edgesView), result, {}};
+  result.pathNodes.push_back(sourceIdx);
+  result.costS = best;
+
+  // s .. meet: upward arcs, collected from the meeting vertex down
+  std::vector<uint32_t>& forwardArcs = scratch.chain;
+  forwardArcs.clear();
+  for (uint32_t x{meet}; scratch.forward[x].arc != UINT32_MAX;
+       x = scratch.forward[x].tail)
+  {
+    forwardArcs.push_back(x);
+  }
+  for (auto it = forwardArcs.rbegin(); it != forwardArcs.rend(); ++it)
+  {
+    const CchScratch::Label& label = scratch.forward[*it];
+    unpacker.run(label.arc, label.tail, *it, true);
+  }
+
+  // meet .. t: the same arcs walked downward
+  for (uint32_t x{meet}; scratch.backward[x].arc != UINT32_MAX;
+       x = scratch.backward[x].tail)
+  {
+    const CchScratch::Label& label = scratch.backward[x];
+    unpacker.run(label.arc, label.tail, x, false);
+  }
+
+  result.success = true;
+  result.status = SearchStatus::Found;
+  return result;
+}
+
+AStarResult cchSnappedQuery(const CchView& cch, const CchMetric& metric,
+                            const EdgesView& edgesView,
+                            const std::vector<EdgePoint>& sources,
+                            const std::vector<EdgePoint>& targets,
+                            const AStarParams& params, CchScratch& scratch)
+{
+  validateSnappedQuery(edgesView, sources, targets, params);
+  if (cch.numStates != 2 * edgesView.numNodes)
+    throw std::runtime_error("cch does not match the graph");
+
+  const CostModel costs(params, edgesView);
+  const SoaEdges edges(edgesView);
+  scratch.reset(cch.numStates);
+  const uint32_t generation = scratch.generation;
+
+  // Sources enter at the heads of their edges, targets leave from the
+  // tails of theirs; both layers, as far as the layer may use the edge
+  std::vector<Seed> forwardSeeds, backwardSeeds;
+  double costS, timeS;
+  uint8_t stepLabel;
+  for (uint32_t s{0}; s < sources.size(); ++s)
+  {
+    const EdgePoint& from = sources[s];
+    for (Layer layer : {Layer::Ride, Layer::Walk})
+    {
+      if (partialEdgeCost(costs, edges, from.edgeIdx, layer,
+                          1.0 - from.offset, costS, timeS, stepLabel))
+        forwardSeeds.push_back(
+            {cch.vertex(edgesView.neighbors[from.edgeIdx], layer),
+             static_cast<float>(costS), s});
+    }
+  }
+  for (uint32_t t{0}; t < targets.size(); ++t)
+  {
+    const EdgePoint& to = targets[t];
+    for (Layer layer : {Layer::Ride, Layer::Walk})
+    {
+      if (partialEdgeCost(costs, edges, to.edgeIdx, layer, to.offset, costS,
+                          timeS, stepLabel))
+        backwardSeeds.push_back(
+            {cch.vertex(edgeTail(edgesView, to.edgeIdx), layer),
+             static_cast<float>(costS), t});
+    }
+  }
+
+  sweepSeeds(cch, metric.up, scratch.forward, generation, forwardSeeds,
+             scratch.chain);
+  sweepSeeds(cch, metric.down, scratch.backward, generation, backwardSeeds,
+             scratch.chain);
+
+  // Both points on one edge, target ahead: no node in between. Offered
+  // first, so a node route must be strictly cheaper (as in aStarSnapped).
+  float best = kInf;
+  PartialStep direct;
+  double directTimeS{0.0};
+  for (const EdgePoint& from : sources)
+  {
+    for (const EdgePoint& to : targets)
+    {
+      if (to.edgeIdx != from.edgeIdx || to.offset < from.offset) continue;
+      for (Layer layer : {Layer::Ride, Layer::Walk})
+      {
+        if (!partialEdgeCost(costs, edges, to.edgeIdx, layer,
+                             to.offset - from.offset, costS, timeS,
+                             stepLabel) ||
+            !(static_cast<float>(costS) < best))
+          continue;
+        best = static_cast<float>(costS);
+        direct = PartialStep{to.edgeIdx, from.offset, to.offset, stepLabel};
+        directTimeS = timeS;
+      }
+    }
+  }
+
+  uint32_t meet = UINT32_MAX;
+  for (uint32_t x : scratch.chain)
+  {
+    const float total = distOf(scratch.forward[x], generation) +
+                        distOf(scratch.backward[x], generation);
+    if (total < best)
+    {
+      best = total;
+      meet = x;
+    }
+  }
+
+  AStarResult result;
+  if (meet == UINT32_MAX && direct.present())
+  {
+    result.sourceStep = direct;
+    addStepDistance(result,
+                    (direct.toOffset - direct.fromOffset) *
+                        edgesView.lengthsMeters[direct.edgeIdx],
+                    direct.mode);
+    result.durationS = directTimeS;
+  }
+  else if (meet == UINT32_MAX)
+  {
+    result.success = false;
+    return result;
+  }
+  else
+  {
+    Unpacker unpacker{cch, metric, edgesView, costs, result, {}};
+
+    // source point .. meet: upward arcs, collected from the meeting vertex
+    // down to the seed
+    std::vector<uint32_t>& forwardArcs = scratch.chain;
+    forwardArcs.clear();
+    uint32_t x{meet};
+    for (; scratch.forward[x].arc != UINT32_MAX; x = scratch.forward[x].tail)
+      forwardArcs.push_back(x);
+    const EdgePoint& from = sources[scratch.forward[x].tail];
+    partialEdgeCost(costs, edges, from.edgeIdx, static_cast<Layer>(x & 1),
+                    1.0 - from.offset, costS, timeS, stepLabel);
+    result.sourceStep = PartialStep{from.edgeIdx, from.offset, 1.0, stepLabel};
+    addStepDistance(result,
+                    (1.0 - from.offset) * edgesView.lengthsMeters[from.edgeIdx],
+                    stepLabel);
+    result.durationS += timeS;
+    result.pathNodes.push_back(edgesView.neighbors[from.edgeIdx]);
+
+    for (auto it = forwardArcs.rbegin(); it != forwardArcs.rend(); ++it)
+    {
+      const CchScratch::Label& label = scratch.forward[*it];
+      unpacker.run(label.arc, label.tail, *it, true);
+    }
+
+    // meet .. target point: the same arcs walked downward
+    for (x = meet; scratch.backward[x].arc != UINT32_MAX;
+         x = scratch.backward[x].tail)
+    {
+      const CchScratch::Label& label = scratch.backward[x];
+      unpacker.run(label.arc, label.tail, x, false);
+    }
+    const EdgePoint& to = targets[scratch.backward[x].tail];
+    partialEdgeCost(costs, edges, to.edgeIdx, static_cast<Layer>(x & 1),
+                    to.offset, costS, timeS, stepLabel);
+    result.targetStep = PartialStep{to.edgeIdx, 0.0, to.offset, stepLabel};
+    addStepDistance(result, to.offset * edgesView.lengthsMeters[to.edgeIdx],
+                    stepLabel);
+    result.durationS += timeS;
+  }
+
+  result.costS = best;
+  result.success = true;
+  result.status = SearchStatus::Found;
+  return result;
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "aStar.hpp"
+#include "route.hpp"
+
+// ---------------- Customizable Contraction Hierarchies ----------------
+// Three phases over the two-layer (node, layer) state graph:
+//   1. offline (ingest/buildCch): nested dissection order + chordal upward
+//      graph, independent of speeds, surfaces and preferences
+//   2. customization: arc weights for one AStarParams profile, cached
+//   3. query: elimination tree walk from s and t, no priority queue
+// State (v, layer) is CCH vertex 2 * nodeRank[v] + layer; every arc runs
+// from a lower to a higher vertex and carries a weight for each direction.
+
+// graph_cch.bin mapped, plus lookups derived at load time
+struct CchView
+{
+  std::shared_ptr<MappedFile> hold;  // keep mapping alive
+  uint32_t numNodes{0};
+  uint32_t numStates{0};  // 2 * numNodes, 0 if no CCH is loaded
+  uint32_t numArcs{0};
+  const uint32_t* nodeRank{nullptr};  // N
+  const uint32_t* firstOut{nullptr};  // 2N+1
+  const uint32_t* head{nullptr};      // M, higher vertex, sorted per tail
+
+  std::vector<uint32_t> parent;     // 2N, elimination tree (UINT32_MAX root)
+  std::vector<uint32_t> rideArc;    // E, arc of the edge's ride copy
+  std::vector<uint32_t> walkArc;    // E, arc of the edge's walk copy
+  std::vector<uint32_t> switchArc;  // N, arc between the two layers
+
+  uint32_t vertex(uint32_t nodeIdx, Layer layer) const
+  {
+    return 2 * nodeRank[nodeIdx] + static_cast<uint32_t>(layer);
+  }
+  // Arc id of lower -> higher, or UINT32_MAX
+  uint32_t findArc(uint32_t lower, uint32_t higher) const;
+};
+
+// Must have been built from the given edges bin.
+CchView loadCch(const std::string& filePath, const EdgesView& edgesView);
+
+// Arc weights for one profile. via* records how the weight was reached so
+// a path can be unpacked into graph edges.
+struct CchMetric
+{
+  inline static constexpr uint32_t kViaNone = UINT32_MAX;
+  inline static constexpr uint32_t kViaSwitch = UINT32_MAX - 1;
+  inline static constexpr uint32_t kViaEdge = 0x80000000u;  // | edge id
+
+  std::vector<float> up;    // lower -> higher, seconds of cost
+  std::vector<float> down;  // higher -> lower
+  std::vector<uint32_t> upVia;    // kVia* or the middle (lowest) vertex
+  std::vector<uint32_t> downVia;
+};
+
+std::shared_ptr<const CchMetric> customizeCch(const CchView& cch,
+                                              const EdgesView& edgesView,
+                                              const AStarParams& params);
+
+// Customized metrics by profileKey(), least recently used dropped first.
+// Concurrent requests for a new profile customize it once.
+class CchMetricCache
+{
+ public:
+  explicit CchMetricCache(std::size_t capacityIn = 4) : capacity(capacityIn) {}
+
+  std::shared_ptr<const CchMetric> get(const CchView& cch,
+                                       const EdgesView& edgesView,
+                                       const AStarParams& params);
+  void clear();
+
+ private:
+  struct Entry
+  {
+    std::vector<double> key;
+    std::shared_future<std::shared_ptr<const CchMetric>> metric;
+    uint64_t id;
+  };
+
+  std::size_t capacity;
+  uint64_t nextId{0};
+  std::mutex mutex;
+  std::list<Entry> entries;  // most recently used first
+};
+
+// Per-thread query labels, valid for the current generation only.
+class CchScratch
+{
+ public:
+  struct Label
+  {
+    float dist;
+    uint32_t arc;   // arc used to reach this vertex
+    uint32_t tail;  // vertex the arc was relaxed from
+    uint32_t stamp;
+  };
+
+  std::vector<Label> forward;
+  std::vector<Label> backward;
+  std::vector<uint32_t> chain;  // elimination tree walk
+  uint32_t generation{0};
+
+  void reset(uint32_t numStates);
+
+  static CchScratch& forThisThread()
+  {
+    static thread_local CchScratch scratch;
+    return scratch;
+  }
+};
+
+// Same result shape as aStarTwoLayer for the same params.
+[[nodiscard]]
+AStarResult cchQuery(const CchView& cch, const CchMetric& metric,
+                     const EdgesView& edgesView, uint32_t sourceIdx,
+                     uint32_t targetIdx, const AStarParams& params,
+                     CchScratch& scratch);
+
+// aStarSnapped on the hierarchy: the sweeps start at the heads of the
+// source edges and the tails of the target edges, each charged its share
+// of the edge. Same result shape as aStarSnapped.
+[[nodiscard]]
+AStarResult cchSnappedQuery(const CchView& cch, const CchMetric& metric,
+                            const EdgesView& edgesView,
+                            const std::vector<EdgePoint>& sources,
+                            const std::vector<EdgePoint>& targets,
+                            const AStarParams& params, CchScratch& scratch);
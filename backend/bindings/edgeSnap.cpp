@@ -0,0 +1,187 @@
+#include "edgeSnap.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+EdgePosition edgePosition(const NodesView& nodesView, uint32_t tail,
+                          uint32_t head, double offset)
+{
+  // Linear in both frames: the projection is equirectangular
+  auto lerp = [offset](double from, double to) {
+    return from + offset * (to - from);
+  };
+  return EdgePosition{lerp(nodesView.lat_f32[tail], nodesView.lat_f32[head]),
+                      lerp(nodesView.lon_f32[tail], nodesView.lon_f32[head]),
+                      lerp(nodesView.xM[tail], nodesView.xM[head]),
+                      lerp(nodesView.yM[tail], nodesView.yM[head])};
+}
+
+EdgeSnapIndex::EdgeSnapIndex(const NodesView& nodesView,
+                             const EdgesView& edgesView, double cellMIn)
+    : cellM(cellMIn)
+{
+  const uint32_t numNodes = edgesView.numNodes;
+  const uint32_t numEdges = edgesView.numEdges;
+  if (numNodes == 0 || numEdges == 0) return;
+
+  const auto [minXIt, maxXIt] =
+      std::minmax_element(nodesView.xM, nodesView.xM + numNodes);
+  const auto [minYIt, maxYIt] =
+      std::minmax_element(nodesView.yM, nodesView.yM + numNodes);
+  minX = *minXIt;
+  minY = *minYIt;
+  const double spanX = double(*maxXIt) - minX;
+  const double spanY = double(*maxYIt) - minY;
+
+  // Large sparse extracts: coarsen until the grid is no bigger than the
+  // edge list
+  auto dimension = [&](double span) {
+    return static_cast<uint32_t>(span / cellM) + 1;
+  };
+  while (double(dimension(spanX)) * dimension(spanY) > 4.0 * numEdges + 1024)
+    cellM *= 2.0;
+  cols = dimension(spanX);
+  rows = dimension(spanY);
+
+  // Cells covered by the bounding box of edge u -> v
+  auto forEachCell = [&](uint32_t u, uint32_t v, auto&& fn) {
+    const auto cell = [&](float value, double origin, uint32_t limit) {
+      const auto at = static_cast<uint32_t>((value - origin) / cellM);
+      return std::min(at, limit - 1);
+    };
+    const uint32_t x0 =
+        cell(std::min(nodesView.xM[u], nodesView.xM[v]), minX, cols);
+    const uint32_t x1 =
+        cell(std::max(nodesView.xM[u], nodesView.xM[v]), minX, cols);
+    const uint32_t y0 =
+        cell(std::min(nodesView.yM[u], nodesView.yM[v]), minY, rows);
+    const uint32_t y1 =
+        cell(std::max(nodesView.yM[u], nodesView.yM[v]), minY, rows);
+    for (uint32_t y{y0}; y <= y1; ++y)
+      for (uint32_t x{x0}; x <= x1; ++x) fn(y * cols + x);
+  };
+
+  // Two passes over the edges: count per cell, then fill (CSR)
+  cellOffsets.assign(std::size_t(cols) * rows + 1, 0);
+  for (uint32_t u{0}; u < numNodes; ++u)
+    for (uint32_t e{edgesView.offsets[u]}; e < edgesView.offsets[u + 1]; ++e)
+      forEachCell(u, edgesView.neighbors[e],
+                  [&](std::size_t c) { ++cellOffsets[c + 1]; });
+  for (std::size_t c{1}; c < cellOffsets.size(); ++c)
+    cellOffsets[c] += cellOffsets[c - 1];
+
+  entries.resize(cellOffsets.back());
+  std::vector<uint32_t> cursor(cellOffsets.begin(), cellOffsets.end() - 1);
+  for (uint32_t u{0}; u < numNodes; ++u)
+    for (uint32_t e{edgesView.offsets[u]}; e < edgesView.offsets[u + 1]; ++e)
+      forEachCell(u, edgesView.neighbors[e], [&](std::size_t c) {
+        entries[cursor[c]++] = Entry{e, u};
+      });
+}
+
+std::vector<EdgeSnap> EdgeSnapIndex::nearest(const NodesView& nodesView,
+                                             const EdgesView& edgesView,
+                                             double lat, double lon,
+                                             const SnapOptions& options) const
+{
+  std::vector<EdgeSnap> found;
+  if (entries.empty() || !std::isfinite(lat) || !std::isfinite(lon))
+    return found;
+
+  const double qx = (lon - nodesView.originLon) * nodesView.metersPerDegX;
+  const double qy = (lat - nodesView.originLat) * nodesView.metersPerDegY;
+  const auto cx = static_cast<int64_t>(std::floor((qx - minX) / cellM));
+  const auto cy = static_cast<int64_t>(std::floor((qy - minY) / cellM));
+
+  double best = std::numeric_limits<double>::infinity();
+  auto scanCell = [&](int64_t x, int64_t y) {
+    if (x < 0 || y < 0 || x >= int64_t(cols) || y >= int64_t(rows)) return;
+    const std::size_t c = std::size_t(y) * cols + std::size_t(x);
+    for (uint32_t i{cellOffsets[c]}; i < cellOffsets[c + 1]; ++i)
+    {
+      const Entry entry = entries[i];
+      if ((edgesView.modeMask[entry.edgeIdx] & options.modeMask) == 0)
+        continue;
+
+      const uint32_t head = edgesView.neighbors[entry.edgeIdx];
+      const double ax = nodesView.xM[entry.tail];
+      const double ay = nodesView.yM[entry.tail];
+      const double dx = nodesView.xM[head] - ax;
+      const double dy = nodesView.yM[head] - ay;
+      const double len2 = dx * dx + dy * dy;
+      double t = 0.0;
+      if (len2 > 0.0)
+        t = std::clamp(((qx - ax) * dx + (qy - ay) * dy) / len2, 0.0, 1.0);
+      const double distanceM =
+          std::hypot(qx - (ax + t * dx), qy - (ay + t * dy));
+      if (distanceM > options.radiusM) continue;
+
+      best = std::min(best, distanceM);
+      EdgeSnap snap;
+      snap.edgeIdx = entry.edgeIdx;
+      snap.tail = entry.tail;
+      snap.head = head;
+      snap.offset = t;
+      snap.distanceM = distanceM;
+      found.push_back(snap);
+    }
+  };
+
+  // Rings of cells around the query's cell. Every cell of ring r is at
+  // least (r - 1) * cellM away, so stop once that exceeds the reach.
+  const auto maxRing = static_cast<int64_t>(options.radiusM / cellM) + 1;
+  for (int64_t r{0}; r <= maxRing; ++r)
+  {
+    const double reach = std::min(options.radiusM, best + options.slackM);
+    if (r > 0 && double(r - 1) * cellM > reach) break;
+    if (r == 0)
+    {
+      scanCell(cx, cy);
+      continue;
+    }
+    for (int64_t x{cx - r}; x <= cx + r; ++x)
+    {
+      scanCell(x, cy - r);
+      scanCell(x, cy + r);
+    }
+    for (int64_t y{cy - r + 1}; y <= cy + r - 1; ++y)
+    {
+      scanCell(cx - r, y);
+      scanCell(cx + r, y);
+    }
+  }
+
+  // Long edges sit in several cells
+  std::sort(found.begin(), found.end(),
+            [](const EdgeSnap& a, const EdgeSnap& b) {
+              return a.edgeIdx < b.edgeIdx;
+            });
+  found.erase(std::unique(found.begin(), found.end(),
+                          [](const EdgeSnap& a, const EdgeSnap& b) {
+                            return a.edgeIdx == b.edgeIdx;
+                          }),
+              found.end());
+  std::stable_sort(found.begin(), found.end(),
+                   [](const EdgeSnap& a, const EdgeSnap& b) {
+                     return a.distanceM < b.distanceM;
+                   });
+
+  const double reach = best + options.slackM;
+  std::size_t keep{0};
+  while (keep < found.size() && keep < options.maxCandidates &&
+         found[keep].distanceM <= reach)
+    ++keep;
+  found.resize(keep);
+
+  for (EdgeSnap& snap : found)
+  {
+    const EdgePosition at =
+        edgePosition(nodesView, snap.tail, snap.head, snap.offset);
+    snap.lat = at.lat;
+    snap.lon = at.lon;
+  }
+  return found;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "route.hpp"
+
+// ---------------- Edge snapping ----------------
+// Projects a query point onto the nearest edge segments instead of the
+// nearest node, so a route can start or end mid-block (aStarSnapped).
+// Edges are straight segments between their end nodes in the planar frame
+// of NodesView; the index is a uniform grid over their bounding boxes.
+// Plain C++, read-only after construction (safe to share across threads).
+
+struct EdgeSnap
+{
+  std::uint32_t edgeIdx{UINT32_MAX};
+  std::uint32_t tail{UINT32_MAX};
+  std::uint32_t head{UINT32_MAX};
+  double offset{0.0};     // 0 = tail, 1 = head, along the segment
+  double distanceM{0.0};  // query point to the projected point
+  double lat{0.0};        // projected point
+  double lon{0.0};
+};
+
+struct SnapOptions
+{
+  double radiusM{100.0};  // no candidate farther than this
+  // Candidates within slackM of the nearest one are kept too (both
+  // directions of the nearest street, a parallel cycleway, a corner).
+  double slackM{5.0};
+  std::uint32_t maxCandidates{8};
+  std::uint8_t modeMask{0x3};  // edges usable by any of these (bit0 = bike)
+};
+
+// A point along an edge, in degrees and in the planar frame
+struct EdgePosition
+{
+  double lat;
+  double lon;
+  double xM;
+  double yM;
+};
+
+// Tail node of a CSR edge (binary search over the offsets). Inline: the
+// snapped searches use it without linking the snap index.
+[[nodiscard]]
+inline std::uint32_t edgeTail(const EdgesView& edgesView,
+                              std::uint32_t edgeIdx)
+{
+  const std::uint32_t* rowEnd = std::upper_bound(
+      edgesView.offsets, edgesView.offsets + edgesView.numNodes + 1, edgeIdx);
+  return static_cast<std::uint32_t>(rowEnd - edgesView.offsets - 1);
+}
+
+[[nodiscard]]
+EdgePosition edgePosition(const NodesView& nodesView, std::uint32_t tail,
+                          std::uint32_t head, double offset);
+
+class EdgeSnapIndex
+{
+ public:
+  inline static constexpr double kDefaultCellM = 64.0;
+
+  EdgeSnapIndex() = default;
+  EdgeSnapIndex(const NodesView& nodesView, const EdgesView& edgesView,
+                double cellM = kDefaultCellM);
+
+  bool empty() const { return entries.empty(); }
+
+  // Directed edges near (lat, lon), nearest first; ties keep edge order.
+  // Empty if nothing lies within options.radiusM.
+  [[nodiscard]]
+  std::vector<EdgeSnap> nearest(const NodesView& nodesView,
+                                const EdgesView& edgesView, double lat,
+                                double lon, const SnapOptions& options) const;
+
+ private:
+  struct Entry
+  {
+    std::uint32_t edgeIdx;
+    std::uint32_t tail;
+  };
+
+  double minX{0.0};
+  double minY{0.0};
+  double cellM{kDefaultCellM};
+  std::uint32_t cols{0};
+  std::uint32_t rows{0};
+  std::vector<std::uint32_t> cellOffsets;  // cols * rows + 1
+  std::vector<Entry> entries;              // grouped by cell
+};
@@ -0,0 +1,520 @@
+// graphLoader.cpp — map the graph bins written by ingest/ into typed views.
+
+#include "graphLoader.hpp"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+#include "binHeaders.hpp"
+#include "utils.hpp"
+#include "writeBins.hpp"
+
+// Return a shared_ptr directly (no by-value temporary)
+std::shared_ptr<MappedFile> mapReadonlySp(const std::string& filePath,
+                                          bool copyOnWrite)
+{
+  auto mapping = std::make_shared<MappedFile>();
+
+  const int fileHandle = ::open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fileHandle < 0)
+  {
+    throw std::system_error(errno, std::generic_category(),
+                            "open failed: " + filePath);
+  }
+  mapping->fileHandle = fileHandle;
+
+  struct stat fileStat{};
+  if (::fstat(fileHandle, &fileStat) != 0)
+  {
+    ::close(fileHandle);
+    mapping->fileHandle = -1;
+    throw std::system_error(errno, std::generic_category(),
+                            "fstat failed: " + filePath);
+  }
+
+  mapping->size = static_cast<size_t>(fileStat.st_size);
+  if (mapping->size == 0)
+  {
+    // You can choose to allow empty files; here we treat it as an error.
+    ::close(fileHandle);
+    mapping->fileHandle = -1;
+    throw std::runtime_error("mmap failed: file is empty: " + filePath);
+  }
+
+  const int protection = copyOnWrite ? PROT_READ | PROT_WRITE : PROT_READ;
+  void* mappedAddress =
+      ::mmap(nullptr, mapping->size, protection, MAP_PRIVATE, fileHandle, 0);
+  if (mappedAddress == MAP_FAILED)
+  {
+    ::close(fileHandle);
+    mapping->fileHandle = -1;
+    throw std::system_error(errno, std::generic_category(),
+                            "mmap failed: " + filePath);
+  }
+
+  mapping->base = mappedAddress;
+  return mapping;
+}
+
+NodesView mapNodes(const std::string& filePath, bool copyOnWrite)
+{
+  auto mapping = mapReadonlySp(filePath, copyOnWrite);
+  const char* cursor = static_cast<const char*>(mapping->base);
+  const char* endPtr = cursor + mapping->size;
+
+  auto requireBytes = [&](size_t bytes) {
+    if (cursor + bytes > endPtr)
+    {
+      throw std::runtime_error("nodes bin truncated");
+    }
+  };
+
+  // Header
+  requireBytes(sizeof(ingest::NodesHeader));
+  const auto* header = reinterpret_cast<const ingest::NodesHeader*>(cursor);
+  if (std::memcmp(header->magic, "MMAPNODE", 8) != 0)
+  {
+    throw std::runtime_error("bad nodes header");
+  }
+  cursor += sizeof(*header);
+
+  NodesView nodesView;
+  nodesView.hold = mapping;
+  nodesView.numNodes = header->numNodes;
+
+  // IDs
+  requireBytes(sizeof(uint64_t) * nodesView.numNodes);
+  nodesView.ids = reinterpret_cast<const uint64_t*>(cursor);
+  cursor += sizeof(uint64_t) * nodesView.numNodes;
+
+  // Coordinates
+  requireBytes(sizeof(float) * nodesView.numNodes * 2);
+  nodesView.lat_f32 = reinterpret_cast<const float*>(cursor);
+  cursor += sizeof(float) * nodesView.numNodes;
+  nodesView.lon_f32 = reinterpret_cast<const float*>(cursor);
+  cursor += sizeof(float) * nodesView.numNodes;
+  return nodesView;
+}
+
+NodesView loadNodes(const std::string& filePath)
+{
+  NodesView nodesView = mapNodes(filePath);
+  attachPlanarCoords(nodesView);
+  return nodesView;
+}
+
+void attachPlanarCoords(NodesView& nodesView)
+{
+  const uint32_t numNodes = nodesView.numNodes;
+  auto planar = std::make_shared<std::vector<float>>(size_t(numNodes) * 2);
+  if (numNodes > 0)
+  {
+    constexpr double kDegToRad = 3.14159265358979323846 / 180.0;
+    constexpr double kEarthRadiusMeters = 6371000.0;  // as haversineMeters
+    // Relative margin for the float rounding of coordinates and of the
+    // edge lengths buildGraph stores.
+    constexpr double kRoundingSlack = 1e-5;
+
+    const auto [minLat, maxLat] = std::minmax_element(
+        nodesView.lat_f32, nodesView.lat_f32 + numNodes);
+    const auto [minLon, maxLon] = std::minmax_element(
+        nodesView.lon_f32, nodesView.lon_f32 + numNodes);
+    const double originLat = 0.5 * (double(*minLat) + *maxLat);
+    const double originLon = 0.5 * (double(*minLon) + *maxLon);
+    const double poleward =
+        std::fabs(*minLat) > std::fabs(*maxLat) ? *minLat : *maxLat;
+
+    double metersPerDegY = kEarthRadiusMeters * kDegToRad;
+    double metersPerDegX = metersPerDegY * std::cos(poleward * kDegToRad);
+
+    // A chord along the poleward parallel is shorter than the parallel
+    // itself, so the projection above still overstates long east-west
+    // spans. Shrink both axes by the worst haversine / planar ratio over
+    // the bounding box: the full poleward edge and the diagonals.
+    auto ratio = [&](double lat1, double lon1, double lat2, double lon2) {
+      const double planarM =
+          std::hypot((lon2 - lon1) * metersPerDegX,
+                     (lat2 - lat1) * metersPerDegY);
+      return planarM > 0.0
+                 ? utils::haversineMeters(lat1, lon1, lat2, lon2) / planarM
+                 : 1.0;
+    };
+    const double scale =
+        std::min({1.0, ratio(poleward, *minLon, poleward, *maxLon),
+                  ratio(*minLat, *minLon, *maxLat, *maxLon),
+                  ratio(*minLat, *maxLon, *maxLat, *minLon)}) *
+        (1.0 - kRoundingSlack);
+    metersPerDegX *= scale;
+    metersPerDegY *= scale;
+
+    for (uint32_t i{0}; i < numNodes; ++i)
+    {
+      (*planar)[i] = static_cast<float>(
+          (double(nodesView.lon_f32[i]) - originLon) * metersPerDegX);
+      (*planar)[numNodes + i] = static_cast<float>(
+          (double(nodesView.lat_f32[i]) - originLat) * metersPerDegY);
+    }
+    nodesView.originLat = originLat;
+    nodesView.originLon = originLon;
+    nodesView.metersPerDegX = metersPerDegX;
+    nodesView.metersPerDegY = metersPerDegY;
+  }
+  nodesView.xM = planar->data();
+  nodesView.yM = planar->data() + numNodes;
+  nodesView.planarHold = std::move(planar);
+}
+
+EdgesView loadEdges(const std::string& filePath)
+{
+  auto mapping = mapReadonlySp(filePath);
+  const char* cursor = static_cast<const char*>(mapping->base);
+  const char* endPtr = cursor + mapping->size;
+
+  auto requireBytes = [&](size_t bytes) {
+    if (cursor + bytes > endPtr)
+    {
+      throw std::runtime_error("edges bin truncated: " + filePath);
+    }
+  };
+
+  // --- Header ---
+  requireBytes(sizeof(ingest::EdgesHeader));
+  const auto* header = reinterpret_cast<const ingest::EdgesHeader*>(cursor);
+
+  // accept both
+  const bool okMagic = (std::memcmp(header->magic, "MMAPGRPH", 8) == 0) ||
+                       (std::memcmp(header->magic, "MMAPEDGE", 8) == 0);
+  if (!okMagic)
+  {
+    throw std::runtime_error("bad edges header: " + filePath);
+  }
+  if (header->lengthType != 0)
+  {
+    throw std::runtime_error(
+        "unsupported lengthType (expected float32 meters): " + filePath);
+  }
+  cursor += sizeof(*header);
+
+  // --- Lengths block (6×u32) ---
+  requireBytes(6 * sizeof(uint32_t));
+  uint32_t offsetsSize, neighborsSize, lengthsSize, surfacePrimarySize,
+      modeMasksSize;
+
+  std::memcpy(&offsetsSize, cursor, 4);
+  cursor += 4;
+  std::memcpy(&neighborsSize, cursor, 4);
+  cursor += 4;
+  std::memcpy(&lengthsSize, cursor, 4);
+  cursor += 4;
+  std::memcpy(&surfacePrimarySize, cursor, 4);
+  cursor += 4;
+  std::memcpy(&modeMasksSize, cursor, 4);
+  cursor += 4;
+
+  // Basic consistency
+  if (offsetsSize != header->numNodes + 1 ||
+      neighborsSize != header->numEdges || lengthsSize != header->numEdges)
+  {
+    throw std::runtime_error("lengths block mismatch: " + filePath);
+  }
+  if (header->hasSurfacePrimary && surfacePrimarySize != header->numEdges)
+  {
+    throw std::runtime_error("primary length mismatch: " + filePath);
+  }
+  if (header->hasModeMask && modeMasksSize != header->numEdges)
+  {
+    throw std::runtime_error("modeMask length mismatch: " + filePath);
+  }
+
+  // --- Views ---
+  EdgesView edgesView;
+  edgesView.hold = mapping;
+  edgesView.numNodes = header->numNodes;
+  edgesView.numEdges = header->numEdges;
+
+  requireBytes(sizeof(uint32_t) * offsetsSize);
+  edgesView.offsets = reinterpret_cast<const uint32_t*>(cursor);
+  cursor += sizeof(uint32_t) * offsetsSize;
+
+  requireBytes(sizeof(uint32_t) * neighborsSize);
+  edgesView.neighbors = reinterpret_cast<const uint32_t*>(cursor);
+  cursor += sizeof(uint32_t) * neighborsSize;
+
+  requireBytes(sizeof(float) * lengthsSize);
+  edgesView.lengthsMeters = reinterpret_cast<const float*>(cursor);
+  cursor += sizeof(float) * lengthsSize;
+
+  if (header->hasSurfacePrimary)
+  {
+    requireBytes(sizeof(uint8_t) * surfacePrimarySize);
+    edgesView.surfacePrimary = reinterpret_cast<const uint8_t*>(cursor);
+    cursor += sizeof(uint8_t) * surfacePrimarySize;
+  }
+
+  if (header->hasModeMask)
+  {
+    requireBytes(sizeof(uint8_t) * modeMasksSize);
+    edgesView.modeMask = reinterpret_cast<const uint8_t*>(cursor);
+    cursor += sizeof(uint8_t) * modeMasksSize;
+  }
+
+  // Required fields sanity
+  if (!edgesView.modeMask)
+  {
+    throw std::runtime_error("edges bin missing modeMask: " + filePath);
+  }
+
+  if (edgesView.offsets[0] != 0 ||
+      edgesView.offsets[edgesView.numNodes] != edgesView.numEdges)
+  {
+    throw std::runtime_error("bad CSR offsets: " + filePath);
+  }
+
+  // --- Reverse CSR (incoming edges) ---
+  if (header->extraSections & ingest::EDGES_SECTION_REVERSE_CSR)
+  {
+    const size_t fileOffset =
+        static_cast<size_t>(cursor - static_cast<const char*>(mapping->base));
+    cursor += (8 - fileOffset % 8) % 8;
+
+    requireBytes(2 * sizeof(uint32_t));
+    uint32_t inOffsetsSize, inEdgesSize;
+    std::memcpy(&inOffsetsSize, cursor, 4);
+    cursor += 4;
+    std::memcpy(&inEdgesSize, cursor, 4);
+    cursor += 4;
+    if (inOffsetsSize != header->numNodes + 1 ||
+        inEdgesSize != header->numEdges)
+    {
+      throw std::runtime_error("reverse CSR size mismatch: " + filePath);
+    }
+
+    requireBytes(sizeof(uint32_t) * inOffsetsSize);
+    edgesView.inOffsets = reinterpret_cast<const uint32_t*>(cursor);
+    cursor += sizeof(uint32_t) * inOffsetsSize;
+
+    requireBytes(sizeof(uint32_t) * inEdgesSize);
+    edgesView.inSources = reinterpret_cast<const uint32_t*>(cursor);
+    cursor += sizeof(uint32_t) * inEdgesSize;
+
+    requireBytes(sizeof(uint32_t) * inEdgesSize);
+    edgesView.inEdgeIds = reinterpret_cast<const uint32_t*>(cursor);
+    cursor += sizeof(uint32_t) * inEdgesSize;
+
+    if (edgesView.inOffsets[0] != 0 ||
+        edgesView.inOffsets[edgesView.numNodes] != edgesView.numEdges)
+    {
+      throw std::runtime_error("bad reverse CSR offsets: " + filePath);
+    }
+  }
+  else
+  {
+    // Older bins: build it once on load (bidirectional search needs it)
+    auto reverse = std::make_shared<ReverseCsr>();
+    ingest::buildReverseCsr(
+        edgesView.numNodes,
+        std::vector<uint32_t>(edgesView.offsets,
+                              edgesView.offsets + edgesView.numNodes + 1),
+        std::vector<uint32_t>(edgesView.neighbors,
+                              edgesView.neighbors + edgesView.numEdges),
+        reverse->offsets, reverse->sources, reverse->edgeIds);
+    edgesView.inOffsets = reverse->offsets.data();
+    edgesView.inSources = reverse->sources.data();
+    edgesView.inEdgeIds = reverse->edgeIds.data();
+    edgesView.reverseHold = std::move(reverse);
+    std::cerr << "[graph] edges bin has no reverse CSR, built in memory\n";
+  }
+
+  // --- Packed adjacency records ---
+  if (header->extraSections & ingest::EDGES_SECTION_PACKED)
+  {
+    const size_t fileOffset =
+        static_cast<size_t>(cursor - static_cast<const char*>(mapping->base));
+    cursor += (8 - fileOffset % 8) % 8;
+
+    requireBytes(2 * sizeof(uint32_t));
+    uint32_t numRecords;
+    std::memcpy(&numRecords, cursor, 4);
+    cursor += 8;  // numRecords, reserved
+    if (numRecords != header->numEdges)
+    {
+      throw std::runtime_error("packed edges size mismatch: " + filePath);
+    }
+
+    requireBytes(sizeof(ingest::PackedEdge) * numRecords);
+    edgesView.packed = reinterpret_cast<const ingest::PackedEdge*>(cursor);
+    cursor += sizeof(ingest::PackedEdge) * numRecords;
+  }
+  else if (edgesView.surfacePrimary)
+  {
+    // Older bins: pack once on load if the graph fits the record
+    auto packed = std::make_shared<std::vector<ingest::PackedEdge>>();
+    const uint32_t numEdges = edgesView.numEdges;
+    if (ingest::buildPackedEdges(
+            edgesView.numNodes,
+            std::vector<uint32_t>(edgesView.neighbors,
+                                  edgesView.neighbors + numEdges),
+            std::vector<float>(edgesView.lengthsMeters,
+                               edgesView.lengthsMeters + numEdges),
+            std::vector<uint8_t>(edgesView.surfacePrimary,
+                                 edgesView.surfacePrimary + numEdges),
+            std::vector<uint8_t>(edgesView.modeMask,
+                                 edgesView.modeMask + numEdges),
+            *packed))
+    {
+      edgesView.packed = packed->data();
+      edgesView.packedHold = std::move(packed);
+      std::cerr << "[graph] edges bin has no packed records, built in "
+                   "memory\n";
+    }
+  }
+
+  return edgesView;
+}
+
+LandmarksView loadLandmarks(const std::string& filePath,
+                            const EdgesView& edgesView)
+{
+  auto mapping = mapReadonlySp(filePath);
+  const char* base = static_cast<const char*>(mapping->base);
+  const char* cursor = base;
+  const char* endPtr = cursor + mapping->size;
+
+  auto requireBytes = [&](size_t bytes) {
+    if (cursor + bytes > endPtr)
+    {
+      throw std::runtime_error("landmarks bin truncated: " + filePath);
+    }
+  };
+
+  requireBytes(sizeof(ingest::LandmarksHeader));
+  const auto* header = reinterpret_cast<const ingest::LandmarksHeader*>(cursor);
+  if (std::memcmp(header->magic, "MMAPLMRK", 8) != 0)
+  {
+    throw std::runtime_error("bad landmarks header: " + filePath);
+  }
+  if (header->distanceType != 0)
+  {
+    throw std::runtime_error("unsupported landmark distanceType: " + filePath);
+  }
+  // Equal counts are not enough: tables from an older edges bin of the
+  // same size overestimate distances and make the heuristic inadmissible.
+  if (header->numNodes != edgesView.numNodes ||
+      header->numEdges != edgesView.numEdges ||
+      header->edgesChecksum !=
+          ingest::edgesChecksum(edgesView.numNodes, edgesView.numEdges,
+                                edgesView.offsets, edgesView.neighbors,
+                                edgesView.lengthsMeters, edgesView.modeMask))
+  {
+    throw std::runtime_error("landmarks bin does not match the graph: " +
+                             filePath);
+  }
+  cursor += sizeof(*header);
+
+  LandmarksView landmarksView;
+  landmarksView.hold = mapping;
+  landmarksView.numNodes = header->numNodes;
+  landmarksView.numLandmarks = header->numLandmarks;
+
+  const size_t numLandmarks = header->numLandmarks;
+  requireBytes(sizeof(uint32_t) * numLandmarks);
+  landmarksView.nodes = reinterpret_cast<const uint32_t*>(cursor);
+  cursor += sizeof(uint32_t) * numLandmarks;
+  cursor += (8 - static_cast<size_t>(cursor - base) % 8) % 8;
+
+  const size_t tableSize = numLandmarks * header->numNodes;
+  requireBytes(sizeof(float) * tableSize);
+  landmarksView.fromLandmark = reinterpret_cast<const float*>(cursor);
+  cursor += sizeof(float) * tableSize;
+
+  requireBytes(sizeof(float) * tableSize);
+  landmarksView.toLandmark = reinterpret_cast<const float*>(cursor);
+  cursor += sizeof(float) * tableSize;
+
+  for (size_t i{0}; i < numLandmarks; ++i)
+  {
+    if (landmarksView.nodes[i] >= landmarksView.numNodes)
+      throw std::runtime_error("landmark node out of range: " + filePath);
+  }
+
+  return landmarksView;
+}
+
+SpatialView loadSpatial(const std::string& filePath,
+                        const NodesView& nodesView)
+{
+  auto mapping = mapReadonlySp(filePath);
+  const char* cursor = static_cast<const char*>(mapping->base);
+  const char* endPtr = cursor + mapping->size;
+
+  if (mapping->size < sizeof(ingest::SpatialHeader))
+  {
+    throw std::runtime_error("spatial bin truncated: " + filePath);
+  }
+  const auto* header = reinterpret_cast<const ingest::SpatialHeader*>(cursor);
+  if (std::memcmp(header->magic, "MMAPSPAT", 8) != 0)
+  {
+    throw std::runtime_error("bad spatial header: " + filePath);
+  }
+  if (header->version != ingest::kSpatialVersion)
+  {
+    throw std::runtime_error("unsupported spatial bin version: " + filePath);
+  }
+  // The checksum reads every coordinate once; kd_snap pages them in for
+  // its queries and typed arrays anyway.
+  if (header->numNodes != nodesView.numNodes ||
+      header->nodesChecksum !=
+          ingest::nodesCoordChecksum(nodesView.lat_f32, nodesView.lon_f32,
+                                     nodesView.numNodes))
+  {
+    throw std::runtime_error("spatial bin does not match the nodes: " +
+                             filePath);
+  }
+  cursor += sizeof(*header);
+
+  const size_t numKdNodes = header->numNodes;
+  if (cursor + sizeof(ingest::KdTreeNode) * numKdNodes > endPtr)
+  {
+    throw std::runtime_error("spatial bin truncated: " + filePath);
+  }
+  if (header->rootIndex >= static_cast<int64_t>(numKdNodes) ||
+      (header->rootIndex < 0) != (numKdNodes == 0))
+  {
+    throw std::runtime_error("spatial root out of range: " + filePath);
+  }
+
+  // Records are followed without checks at query time: point indices
+  // must name a node, and children precede their parent (build() writes
+  // them in post-order), which also rules out cycles.
+  const auto* kdNodes = reinterpret_cast<const ingest::KdTreeNode*>(cursor);
+  for (size_t i{0}; i < numKdNodes; ++i)
+  {
+    const ingest::KdTreeNode& node = kdNodes[i];
+    auto badChild = [&](int32_t child) {
+      return child != -1 && (child < 0 || static_cast<size_t>(child) >= i);
+    };
+    if (node.pointIndex >= numKdNodes || node.splitAxis > 1 ||
+        badChild(node.leftChild) || badChild(node.rightChild))
+    {
+      throw std::runtime_error("bad spatial tree node " + std::to_string(i) +
+                               ": " + filePath);
+    }
+  }
+
+  SpatialView spatialView;
+  spatialView.hold = mapping;
+  spatialView.numNodes = header->numNodes;
+  spatialView.rootIndex = header->rootIndex;
+  spatialView.kdNodes = kdNodes;
+  return spatialView;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "route.hpp"
+
+// ---------------- Graph bin loaders ----------------
+// Plain C++ (no N-API) so the ingest tools and benchmarks can map the same
+// files the addon does. All loaders throw std::runtime_error /
+// std::system_error on a missing, truncated or inconsistent file.
+
+// copyOnWrite also maps the pages writable (MAP_PRIVATE either way): they
+// stay shared with the page cache until written, and a write never reaches
+// the file. For memory handed to JS as a typed array, which cannot be
+// made read-only.
+std::shared_ptr<MappedFile> mapReadonlySp(const std::string& filePath,
+                                          bool copyOnWrite = false);
+
+// ids, lat and lon straight from the mapping; nothing on the heap.
+NodesView mapNodes(const std::string& filePath, bool copyOnWrite = false);
+
+// mapNodes plus the planar coordinates (attachPlanarCoords).
+NodesView loadNodes(const std::string& filePath);
+EdgesView loadEdges(const std::string& filePath);
+
+// Equirectangular projection of every node around the graph's centre, with
+// the east-west scale taken at the latitude farthest from the equator and
+// both axes then shrunk by the smallest haversine / planar ratio over the
+// bounding box (less a 1e-5 margin for float rounding). The straight-line
+// distance between projected points is then a lower bound on the
+// great-circle distance and on every edge length: a consistent heuristic
+// at the cost of one sqrt.
+void attachPlanarCoords(NodesView& nodesView);
+
+// Landmark tables must have been computed on the given edges bin (same
+// counts and edgesChecksum); stale tables throw.
+LandmarksView loadLandmarks(const std::string& filePath,
+                            const EdgesView& edgesView);
+
+// The tree must have been built on the coordinates of the given nodes bin
+// (same version, node count and nodesCoordChecksum); a stale one throws,
+// and so does a record with a point or child index out of range.
+SpatialView loadSpatial(const std::string& filePath,
+                        const NodesView& nodesView);
@@ -0,0 +1,427 @@
+#include "isochrone.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "searchCommon.hpp"
+
+namespace
+{
+constexpr double kInf = std::numeric_limits<double>::infinity();
+constexpr double kDegToRad = 3.14159265358979323846 / 180.0;
+constexpr double kMetersPerDegLat = 6371000.0 * kDegToRad;
+
+// Empty cells around the reachable area, so closing and tracing never reach
+// the grid border.
+constexpr int32_t kGridPad = 3;
+// Coarser cells are used if the area would need more than this many.
+constexpr double kMaxGridCells = 4.0e6;
+
+// Dijkstra from originIdx over states whose travel time stays within
+// maxBudgetS. Appends each node once, when its first layer settles (its
+// cheapest state), with that state's travel time.
+template <CostKernel kKernel, class Edges, class StateStore, class OpenQueue>
+void settleWithinBudget(const EdgesView& edgesView, const Edges& edges,
+                        uint32_t originIdx, double maxBudgetS,
+                        const AStarParams& params, const CostModel& costs,
+                        StateStore& states, OpenQueue& openPQ,
+                        Isochrone& out)
+{
+  const uint32_t S_ride = StateKey::idx(originIdx, Layer::Ride);
+  const uint32_t S_walk = StateKey::idx(originIdx, Layer::Walk);
+
+  states.reset(StateKey::kLayers * edgesView.numNodes);
+  SearchState& sourceRide = states.at(S_ride);
+  sourceRide.gCost = 0.0;
+  sourceRide.gTime = 0.0;
+  SearchState& sourceWalk = states.at(S_walk);
+  sourceWalk.gCost = 0.0;
+  sourceWalk.gTime = 0.0;
+
+  openPQ.clear();
+  openPQ.push(0.0, S_ride, sourceRide);
+  openPQ.push(0.0, S_walk, sourceWalk);
+
+  // Time only grows along a route, so states over budget are never queued
+  auto relax = [&](const SearchState& cur, uint32_t curIdx, uint32_t nextIdx,
+                   uint32_t edgeIdx, double timeS, double penaltyS,
+                   uint8_t stepLabel) {
+    const double tentativeTime = cur.gTime + timeS;
+    if (tentativeTime > maxBudgetS) return;
+
+    SearchState& next = states.at(nextIdx);
+    const double tentativeCost = cur.gCost + timeS + penaltyS;
+    if (tentativeCost < next.gCost)
+    {
+      next.gCost = tentativeCost;
+      next.gTime = tentativeTime;
+      next.parent = curIdx;
+      next.parentMode = stepLabel;
+      next.parentEdge = edgeIdx;
+      openPQ.push(tentativeCost, nextIdx, next);
+    }
+  };
+
+  while (!openPQ.empty())
+  {
+    const uint32_t uIdx = openPQ.pop().stateKey;
+    const uint32_t u = uIdx / StateKey::kLayers;
+    const Layer layer = static_cast<Layer>(uIdx % StateKey::kLayers);
+    SearchState& cur = states.at(uIdx);
+    if (cur.closed) continue;
+    cur.closed = 1;
+
+    if (!states.at(uIdx ^ 1u).closed)
+    {
+      out.nodes.push_back(u);
+      out.durationsS.push_back(cur.gTime);
+    }
+
+    const uint32_t begin = edgesView.offsets[u];
+    const uint32_t end = edgesView.offsets[u + 1];
+
+    if (layer == Layer::Ride)
+    {
+      for (uint32_t edgeIdx{begin}; edgeIdx < end; ++edgeIdx)
+      {
+        double timeS, penaltyS;
+        uint8_t stepLabel;
+        if (!costs.ride<kKernel>(edges, edgeIdx, timeS, penaltyS, stepLabel))
+          continue;
+        relax(cur, uIdx, StateKey::idx(edges.head(edgeIdx), Layer::Ride),
+              edgeIdx, timeS, penaltyS, stepLabel);
+      }
+      if (params.rideToWalkPenaltyS >= 0.0)
+        relax(cur, uIdx, StateKey::idx(u, Layer::Walk), UINT32_MAX, 0.0,
+              params.rideToWalkPenaltyS, 0);
+    }
+    else
+    {
+      for (uint32_t edgeIdx{begin}; edgeIdx < end; ++edgeIdx)
+      {
+        double timeS;
+        if (!costs.walk<kKernel>(edges, edgeIdx, timeS)) continue;
+        relax(cur, uIdx, StateKey::idx(edges.head(edgeIdx), Layer::Walk),
+              edgeIdx, timeS, 0.0, MODE_FOOT);
+      }
+      if (params.walkToRidePenaltyS >= 0.0)
+        relax(cur, uIdx, StateKey::idx(u, Layer::Ride), UINT32_MAX, 0.0,
+              params.walkToRidePenaltyS, 0);
+    }
+  }
+}
+
+// Lat/lon grid over the reachable nodes; each cell keeps the shortest
+// travel time of the nodes inside it. Cells are square in meters at the
+// area's mid latitude.
+struct ContourGrid
+{
+  int32_t cols{0};
+  int32_t rows{0};
+  double originLon{0.0};  // south-west corner of cell (0, 0)
+  double originLat{0.0};
+  double cellLon{0.0};
+  double cellLat{0.0};
+  std::vector<double> bestTimeS;  // rows * cols, row 0 southmost
+
+  ContourGrid(const NodesView& nodesView, const Isochrone& reached,
+              double cellSizeM)
+  {
+    float minLat = nodesView.lat_f32[reached.nodes.front()];
+    float maxLat = minLat;
+    float minLon = nodesView.lon_f32[reached.nodes.front()];
+    float maxLon = minLon;
+    for (uint32_t nodeIdx : reached.nodes)
+    {
+      minLat = std::min(minLat, nodesView.lat_f32[nodeIdx]);
+      maxLat = std::max(maxLat, nodesView.lat_f32[nodeIdx]);
+      minLon = std::min(minLon, nodesView.lon_f32[nodeIdx]);
+      maxLon = std::max(maxLon, nodesView.lon_f32[nodeIdx]);
+    }
+
+    const double midLat = 0.5 * (double(minLat) + maxLat);
+    const double metersPerDegLon =
+        kMetersPerDegLat * std::max(0.01, std::cos(midLat * kDegToRad));
+    const double spanX = (double(maxLon) - minLon) * metersPerDegLon;
+    const double spanY = (double(maxLat) - minLat) * kMetersPerDegLat;
+    cellSizeM = std::max(cellSizeM, std::sqrt(spanX * spanY / kMaxGridCells));
+
+    cellLon = cellSizeM / metersPerDegLon;
+    cellLat = cellSizeM / kMetersPerDegLat;
+    originLon = minLon - kGridPad * cellLon;
+    originLat = minLat - kGridPad * cellLat;
+    cols = static_cast<int32_t>(spanX / cellSizeM) + 1 + 2 * kGridPad;
+    rows = static_cast<int32_t>(spanY / cellSizeM) + 1 + 2 * kGridPad;
+
+    bestTimeS.assign(std::size_t(cols) * rows, kInf);
+    for (std::size_t i{0}; i < reached.nodes.size(); ++i)
+    {
+      const uint32_t nodeIdx = reached.nodes[i];
+      const auto col = std::clamp<int32_t>(
+          int32_t((nodesView.lon_f32[nodeIdx] - originLon) / cellLon), 0,
+          cols - 1);
+      const auto row = std::clamp<int32_t>(
+          int32_t((nodesView.lat_f32[nodeIdx] - originLat) / cellLat), 0,
+          rows - 1);
+      double& best = bestTimeS[std::size_t(row) * cols + col];
+      best = std::min(best, reached.durationsS[i]);
+    }
+  }
+
+  // Cells reached within budgetS, closed (3x3 dilation, then erosion) so
+  // street blocks without nodes do not show up as holes.
+  std::vector<uint8_t> insideCells(double budgetS) const
+  {
+    std::vector<uint8_t> inside(bestTimeS.size());
+    for (std::size_t i{0}; i < inside.size(); ++i)
+      inside[i] = bestTimeS[i] <= budgetS;
+
+    auto morph = [&](const std::vector<uint8_t>& in, bool dilate) {
+      std::vector<uint8_t> result(in.size(), 0);
+      for (int32_t row{1}; row + 1 < rows; ++row)
+      {
+        for (int32_t col{1}; col + 1 < cols; ++col)
+        {
+          bool any = false;
+          bool all = true;
+          for (int32_t dy{-1}; dy <= 1; ++dy)
+          {
+            for (int32_t dx{-1}; dx <= 1; ++dx)
+            {
+              const bool cell = in[std::size_t(row + dy) * cols + col + dx];
+              any |= cell;
+              all &= cell;
+            }
+          }
+          result[std::size_t(row) * cols + col] = dilate ? any : all;
+        }
+      }
+      return result;
+    };
+    return morph(morph(inside, true), false);
+  }
+};
+
+// One directed cell side on the boundary, inside cells on its left.
+// Directions: 0 east, 1 north, 2 west, 3 south.
+struct BoundaryEdge
+{
+  int32_t x;
+  int32_t y;
+  uint8_t dir;
+};
+
+constexpr int32_t kStepX[4] = {1, 0, -1, 0};
+constexpr int32_t kStepY[4] = {0, 1, 0, -1};
+
+// Ring of grid corners, one per change of direction (not repeated at the
+// end).
+using GridRing = std::vector<std::pair<int32_t, int32_t>>;
+
+// Outlines of the inside cells. At a corner shared by two diagonal cells
+// the trace turns left, so every ring is simple; rings may touch at such
+// corners.
+std::vector<GridRing> traceRings(const std::vector<uint8_t>& inside,
+                                 int32_t cols, int32_t rows)
+{
+  auto isInside = [&](int32_t col, int32_t row) {
+    return col >= 0 && row >= 0 && col < cols && row < rows &&
+           inside[std::size_t(row) * cols + col];
+  };
+
+  std::vector<BoundaryEdge> edges;
+  for (int32_t row{0}; row < rows; ++row)
+  {
+    for (int32_t col{0}; col < cols; ++col)
+    {
+      if (!isInside(col, row)) continue;
+      if (!isInside(col, row - 1)) edges.push_back({col, row, 0});
+      if (!isInside(col + 1, row)) edges.push_back({col + 1, row, 1});
+      if (!isInside(col, row + 1)) edges.push_back({col + 1, row + 1, 2});
+      if (!isInside(col - 1, row)) edges.push_back({col, row + 1, 3});
+    }
+  }
+
+  // Edges sorted by start corner; a corner starts at most two of them
+  const int64_t stride = int64_t(cols) + 1;
+  auto cornerId = [&](int32_t x, int32_t y) { return int64_t(y) * stride + x; };
+  std::sort(edges.begin(), edges.end(),
+            [&](const BoundaryEdge& a, const BoundaryEdge& b) {
+              return cornerId(a.x, a.y) < cornerId(b.x, b.y);
+            });
+  auto firstAt = [&](int64_t corner) {
+    return static_cast<std::size_t>(
+        std::lower_bound(edges.begin(), edges.end(), corner,
+                         [&](const BoundaryEdge& e, int64_t id) {
+                           return cornerId(e.x, e.y) < id;
+                         }) -
+        edges.begin());
+  };
+
+  std::vector<uint8_t> used(edges.size(), 0);
+  std::vector<GridRing> rings;
+  for (std::size_t start{0}; start < edges.size(); ++start)
+  {
+    if (used[start]) continue;
+
+    GridRing ring;
+    std::size_t cur = start;
+    while (!used[cur])
+    {
+      used[cur] = 1;
+      const BoundaryEdge& edge = edges[cur];
+      const int32_t endX = edge.x + kStepX[edge.dir];
+      const int32_t endY = edge.y + kStepY[edge.dir];
+
+      std::size_t next = firstAt(cornerId(endX, endY));
+      const std::size_t other = next + 1;
+      if (other < edges.size() && edges[other].x == endX &&
+          edges[other].y == endY &&
+          edges[other].dir == (edge.dir + 1) % 4)
+        next = other;  // saddle corner: keep turning left
+
+      if (edges[next].dir != edge.dir) ring.emplace_back(endX, endY);
+      cur = next;
+    }
+    rings.push_back(std::move(ring));
+  }
+  return rings;
+}
+
+// Twice the signed area in grid units (> 0 for counterclockwise)
+double signedArea2(const GridRing& ring)
+{
+  double area = 0.0;
+  for (std::size_t i{0}; i < ring.size(); ++i)
+  {
+    const auto& [x0, y0] = ring[i];
+    const auto& [x1, y1] = ring[(i + 1) % ring.size()];
+    area += double(x0) * y1 - double(x1) * y0;
+  }
+  return area;
+}
+
+bool containsPoint(const GridRing& ring, double px, double py)
+{
+  bool inside = false;
+  for (std::size_t i{0}, j{ring.size() - 1}; i < ring.size(); j = i++)
+  {
+    const double xi = ring[i].first, yi = ring[i].second;
+    const double xj = ring[j].first, yj = ring[j].second;
+    if ((yi > py) != (yj > py) &&
+        px < (xj - xi) * (py - yi) / (yj - yi) + xi)
+      inside = !inside;
+  }
+  return inside;
+}
+
+// Group traced rings into polygons (each hole joins the smallest outer
+// ring around it) and convert corners to lon/lat.
+std::vector<IsochronePolygon> buildPolygons(const ContourGrid& grid,
+                                            std::vector<GridRing> rings)
+{
+  std::vector<std::size_t> outers;
+  std::vector<std::size_t> holes;
+  std::vector<double> areas(rings.size());
+  for (std::size_t i{0}; i < rings.size(); ++i)
+  {
+    areas[i] = signedArea2(rings[i]);
+    (areas[i] > 0.0 ? outers : holes).push_back(i);
+  }
+
+  std::vector<std::vector<std::size_t>> holesOf(outers.size());
+  for (std::size_t hole : holes)
+  {
+    // Centre of the inside cell left of the hole's first side
+    const GridRing& ring = rings[hole];
+    const auto [x0, y0] = ring[0];
+    const auto [x1, y1] = ring[1];
+    const int32_t dx = (x1 > x0) - (x1 < x0);
+    const int32_t dy = (y1 > y0) - (y1 < y0);
+    const double px = x0 + 0.5 * dx - 0.5 * dy;
+    const double py = y0 + 0.5 * dy + 0.5 * dx;
+
+    std::size_t owner = outers.size();
+    for (std::size_t k{0}; k < outers.size(); ++k)
+    {
+      if (!containsPoint(rings[outers[k]], px, py)) continue;
+      if (owner == outers.size() || areas[outers[k]] < areas[outers[owner]])
+        owner = k;
+    }
+    if (owner < outers.size()) holesOf[owner].push_back(hole);
+  }
+
+  auto toLonLat = [&](const GridRing& ring) {
+    IsochroneRing out;
+    out.reserve(2 * ring.size() + 2);
+    for (const auto& [x, y] : ring)
+    {
+      out.push_back(grid.originLon + x * grid.cellLon);
+      out.push_back(grid.originLat + y * grid.cellLat);
+    }
+    out.push_back(out[0]);
+    out.push_back(out[1]);
+    return out;
+  };
+
+  std::vector<IsochronePolygon> polygons(outers.size());
+  for (std::size_t k{0}; k < outers.size(); ++k)
+  {
+    polygons[k].rings.push_back(toLonLat(rings[outers[k]]));
+    for (std::size_t hole : holesOf[k])
+      polygons[k].rings.push_back(toLonLat(rings[hole]));
+  }
+  return polygons;
+}
+}  // namespace
+
+Isochrone computeIsochrone(const EdgesView& edgesView,
+                           const NodesView& nodesView, uint32_t originIdx,
+                           const std::vector<double>& budgetsS,
+                           const AStarParams& params,
+                           SearchWorkspace& workspace,
+                           const SearchOptions& options, double cellSizeM)
+{
+  validateQuery(edgesView, originIdx, originIdx, params);
+  if (budgetsS.empty()) throw std::runtime_error("budgetsS must not be empty");
+  for (double budgetS : budgetsS)
+  {
+    if (!std::isfinite(budgetS) || budgetS <= 0.0)
+      throw std::runtime_error("budgetsS must be finite and > 0");
+  }
+  if (!std::isfinite(cellSizeM) || cellSizeM <= 0.0)
+    throw std::runtime_error("cellSizeM must be finite and > 0");
+
+  const double maxBudgetS = *std::max_element(budgetsS.begin(), budgetsS.end());
+  const CostModel costs(params, edgesView);
+
+  Isochrone result;
+  withSearchPolicies(
+      workspace, StateStorage::Dense, options.queue,
+      [&](auto& states, auto& openPQ, auto& /*backwardStates*/,
+          auto& /*backwardPQ*/) {
+        withCostKernel(costs.kernel(), [&](auto kernel) {
+          withEdgeLayout(edgesView, options.edgeLayout, [&](const auto& edges) {
+            settleWithinBudget<decltype(kernel)::value>(
+                edgesView, edges, originIdx, maxBudgetS, params, costs,
+                states, openPQ, result);
+          });
+        });
+      });
+
+  const ContourGrid grid(nodesView, result, cellSizeM);
+  for (double budgetS : budgetsS)
+  {
+    IsochroneBand band;
+    band.budgetS = budgetS;
+    band.polygons = buildPolygons(
+        grid, traceRings(grid.insideCells(budgetS), grid.cols, grid.rows));
+    result.bands.push_back(std::move(band));
+  }
+  return result;
+}
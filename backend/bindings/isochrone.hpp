@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "aStar.hpp"
+#include "route.hpp"
+
+// ---------------- Isochrones ----------------
+// Time-bounded Dijkstra from one node over the two-layer graph, with the
+// same costs as aStarTwoLayer. A node is reachable if the cheapest route
+// found to it takes at most the largest budget; each budget is then turned
+// into polygons by rasterizing the reachable nodes onto a grid and tracing
+// the cell outlines.
+
+// Closed ring of lon, lat pairs (first pair repeated at the end).
+// Outer rings run counterclockwise, holes clockwise (RFC 7946).
+using IsochroneRing = std::vector<double>;
+
+struct IsochronePolygon
+{
+  std::vector<IsochroneRing> rings;  // outer ring first, then its holes
+};
+
+struct IsochroneBand
+{
+  double budgetS{0.0};
+  std::vector<IsochronePolygon> polygons;
+};
+
+struct Isochrone
+{
+  // Nodes settled within the largest budget, in settle order
+  std::vector<std::uint32_t> nodes;
+  std::vector<double> durationsS;
+
+  std::vector<IsochroneBand> bands;  // same order as the budgets passed in
+};
+
+// cellSizeM is the contour grid resolution; gaps of up to two cells between
+// reachable nodes (blocks without nodes) are closed before tracing.
+[[nodiscard]]
+Isochrone computeIsochrone(const EdgesView& edgesView,
+                           const NodesView& nodesView, std::uint32_t originIdx,
+                           const std::vector<double>& budgetsS,
+                           const AStarParams& params,
+                           SearchWorkspace& workspace,
+                           const SearchOptions& options = {},
+                           double cellSizeM = 100.0);
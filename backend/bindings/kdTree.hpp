@@ -0,0 +1,226 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "binHeaders.hpp"
+
+// ---------------- Packed KD-tree for 2D lat/lon --------------------
+// Nodes live in one array, built here or mapped from graph_spatial.bin
+// (same record layout); the coordinate arrays stay with the caller (heap
+// or a mapped graph_nodes.bin) and are passed to every call. Plain C++ so
+// benchmarks can build it without N-API.
+namespace kd2d
+{
+
+enum class SplitAxis : uint8_t
+{
+  Latitude = 0,
+  Longitude = 1
+};
+
+// splitAxis holds a SplitAxis
+using KDNode = ingest::KdTreeNode;
+
+class PackedKDTree
+{
+ public:
+  void build(const float* latitudeDegrees, const float* longitudeDegrees,
+             uint32_t totalPoints)
+  {
+    clear();
+    if (totalPoints == 0) return;
+
+    pointIndexScratch.resize(totalPoints);
+    for (uint32_t i = 0; i < totalPoints; ++i) pointIndexScratch[i] = i;
+
+    ownedNodes.reserve(totalPoints);
+    rootNodeIndex = static_cast<int32_t>(buildRecursive(
+        0, totalPoints, /*depth=*/0, latitudeDegrees, longitudeDegrees));
+    kdNodes = ownedNodes.data();
+    numKdNodes = static_cast<uint32_t>(ownedNodes.size());
+  }
+
+  // Uses nodes the caller keeps alive (a mapped graph_spatial.bin), as
+  // laid out by build(): no copy, no partitioning.
+  void adopt(const KDNode* nodes, uint32_t count, int32_t rootIndex)
+  {
+    clear();
+    kdNodes = nodes;
+    numKdNodes = count;
+    rootNodeIndex = rootIndex;
+  }
+
+  bool empty() const { return numKdNodes == 0; }
+
+  // For serialization: nodes(), size() and root() round-trip via adopt().
+  const KDNode* nodes() const { return kdNodes; }
+  uint32_t size() const { return numKdNodes; }
+  int32_t root() const { return rootNodeIndex; }
+
+  // Returns original point index, or UINT32_MAX if empty.
+  uint32_t nearestNeighbor(float queryLatitudeDegrees,
+                           float queryLongitudeDegrees,
+                           const float* latitudeDegrees,
+                           const float* longitudeDegrees) const
+  {
+    if (empty()) return UINT32_MAX;
+
+    const double kDegToRad = 3.14159265358979323846 / 180.0;
+    const double cosQueryLatitude = std::cos(queryLatitudeDegrees * kDegToRad);
+
+    uint32_t bestPointIndex = UINT32_MAX;
+    double bestDistanceSquared = std::numeric_limits<double>::infinity();
+
+    nearestRecursive(rootNodeIndex, queryLatitudeDegrees, queryLongitudeDegrees,
+                     cosQueryLatitude, latitudeDegrees, longitudeDegrees,
+                     bestPointIndex, bestDistanceSquared);
+    return bestPointIndex;
+  }
+
+ private:
+  std::vector<KDNode> ownedNodes;           // empty for an adopted tree
+  std::vector<uint32_t> pointIndexScratch;  // used during build partitioning
+  const KDNode* kdNodes = nullptr;
+  uint32_t numKdNodes = 0;
+  int32_t rootNodeIndex = -1;
+
+  void clear()
+  {
+    ownedNodes.clear();
+    pointIndexScratch.clear();
+    kdNodes = nullptr;
+    numKdNodes = 0;
+    rootNodeIndex = -1;
+  }
+
+  static inline double equirectangularDistanceSquared(double latA, double lonA,
+                                                      double latB, double lonB,
+                                                      double cosLatA)
+  {
+    const double deltaLat = latB - latA;
+    const double deltaLonScaled = (lonB - lonA) * cosLatA;
+    return deltaLat * deltaLat + deltaLonScaled * deltaLonScaled;
+  }
+
+  uint32_t buildRecursive(uint32_t startInclusive, uint32_t endExclusive,
+                          uint32_t treeDepth,
+                          const float* latitudeDegrees,
+                          const float* longitudeDegrees)
+  {
+    if (startInclusive >= endExclusive) return UINT32_MAX;
+
+    const SplitAxis chosenAxis =
+        (treeDepth & 1) ? SplitAxis::Longitude : SplitAxis::Latitude;
+
+    const uint32_t medianIndex = (startInclusive + endExclusive) / 2;
+
+    // Partition around median along the chosen axis.
+    auto lessOnAxis = [&](uint32_t a, uint32_t b) {
+      if (chosenAxis == SplitAxis::Latitude)
+        return latitudeDegrees[a] < latitudeDegrees[b];
+      else
+        return longitudeDegrees[a] < longitudeDegrees[b];
+    };
+    std::nth_element(pointIndexScratch.begin() + startInclusive,
+                     pointIndexScratch.begin() + medianIndex,
+                     pointIndexScratch.begin() + endExclusive, lessOnAxis);
+
+    const uint32_t pointIndexAtNode = pointIndexScratch[medianIndex];
+
+    // Build children first so their indices are known.
+    int32_t leftChildIndex = -1;
+    int32_t rightChildIndex = -1;
+
+    if (medianIndex > startInclusive)
+    {
+      leftChildIndex = static_cast<int32_t>(
+          buildRecursive(startInclusive, medianIndex, treeDepth + 1,
+                         latitudeDegrees, longitudeDegrees));
+    }
+    if (medianIndex + 1 < endExclusive)
+    {
+      rightChildIndex = static_cast<int32_t>(
+          buildRecursive(medianIndex + 1, endExclusive, treeDepth + 1,
+                         latitudeDegrees, longitudeDegrees));
+    }
+
+    const int32_t myNodeIndex = static_cast<int32_t>(ownedNodes.size());
+    ownedNodes.push_back(KDNode{pointIndexAtNode, leftChildIndex,
+                                rightChildIndex,
+                                static_cast<uint8_t>(chosenAxis)});
+    return static_cast<uint32_t>(myNodeIndex);
+  }
+
+  void nearestRecursive(int32_t nodeIndex, float queryLatitudeDegrees,
+                        float queryLongitudeDegrees, double cosQueryLatitude,
+                        const float* latitudeDegrees,
+                        const float* longitudeDegrees,
+                        uint32_t& bestPointIndex,
+                        double& bestDistanceSquared) const
+  {
+    if (nodeIndex < 0) return;
+
+    const KDNode& node = kdNodes[static_cast<size_t>(nodeIndex)];
+    const uint32_t nodePointIndex = node.pointIndex;
+
+    // 1) Check the point at this node
+    const double distanceSquared = equirectangularDistanceSquared(
+        queryLatitudeDegrees, queryLongitudeDegrees,
+        latitudeDegrees[nodePointIndex], longitudeDegrees[nodePointIndex],
+        cosQueryLatitude);
+
+    if (distanceSquared < bestDistanceSquared)
+    {
+      bestDistanceSquared = distanceSquared;
+      bestPointIndex = nodePointIndex;
+    }
+
+    // 2) Decide which child to explore first (near side) and compute split
+    // delta^2
+    int32_t nearChildIndex = node.leftChild;
+    int32_t farChildIndex = node.rightChild;
+    double splitDeltaSquared;
+
+    if (node.splitAxis == static_cast<uint8_t>(SplitAxis::Latitude))
+    {
+      const float splitLatitude = latitudeDegrees[nodePointIndex];
+      const bool goLeftFirst = (queryLatitudeDegrees < splitLatitude);
+      nearChildIndex = goLeftFirst ? node.leftChild : node.rightChild;
+      farChildIndex = goLeftFirst ? node.rightChild : node.leftChild;
+      const double deltaLat = queryLatitudeDegrees - splitLatitude;
+      splitDeltaSquared = deltaLat * deltaLat;  // degrees^2
+    }
+    else
+    {
+      const float splitLongitude = longitudeDegrees[nodePointIndex];
+      const bool goLeftFirst = (queryLongitudeDegrees < splitLongitude);
+      nearChildIndex = goLeftFirst ? node.leftChild : node.rightChild;
+      farChildIndex = goLeftFirst ? node.rightChild : node.leftChild;
+      const double deltaLonScaled =
+          (queryLongitudeDegrees - splitLongitude) * cosQueryLatitude;
+      splitDeltaSquared = deltaLonScaled * deltaLonScaled;  // scaled degrees^2
+    }
+
+    // 3) Explore near side
+    if (nearChildIndex >= 0)
+    {
+      nearestRecursive(nearChildIndex, queryLatitudeDegrees,
+                       queryLongitudeDegrees, cosQueryLatitude, latitudeDegrees,
+                       longitudeDegrees, bestPointIndex, bestDistanceSquared);
+    }
+
+    // 4) Explore far side only if it can contain a closer point
+    if (farChildIndex >= 0 && splitDeltaSquared < bestDistanceSquared)
+    {
+      nearestRecursive(farChildIndex, queryLatitudeDegrees,
+                       queryLongitudeDegrees, cosQueryLatitude, latitudeDegrees,
+                       longitudeDegrees, bestPointIndex, bestDistanceSquared);
+    }
+  }
+};
+
+}  // namespace kd2d
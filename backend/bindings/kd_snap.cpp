@@ -1,5 +1,6 @@
-// kd_snap.cpp — loads graph_nodes.bin (fixed layout) and builds a packed 2D
-// KD-tree. Exports:
+// kd_snap.cpp — maps graph_nodes.bin (graphLoader's mapNodes) and the
+// packed 2D KD-tree over it from graph_spatial.bin, building the tree in
+// memory if that file is missing or stale. Exports:
 //   findNearest(lat, lon) -> idx
 //   getNode(idx) -> { idx, lat, lon }
 //   getLatArray() / getLonArray() -> zero-copy Float32Array views
@@ -8,236 +9,25 @@
 #include <napi.h>
 #include <unistd.h>
 
-#include <algorithm>
-#include <cmath>
 #include <cstdint>
 #include <cstdlib>
-#include <cstring>
-#include <fstream>
 #include <iostream>
-#include <limits>
 #include <stdexcept>
 #include <string>
-#include <utility>
-#include <vector>
 
-// ---------------- graph_nodes.bin layout ---------------------------
-// Header (16 bytes total):
-//   magic[8]   : "MMAPNODE"
-//   numNodes   : uint32_t (N)
-//   reserved   : uint32_t (padding)
-struct NodesHeader
-{
-  char magic[8];
-  uint32_t numNodes;
-  uint32_t reserved;
-};
-static_assert(sizeof(NodesHeader) == 16, "NodesHeader must be 16 bytes");
-
-// ---------------- Raw in-memory storage ----------------------------
-static std::vector<uint64_t> gOsmNodeIds;    // ids[N] (not exposed, but loaded)
-static std::vector<float> gLatitudeDegrees;  // lat[N] in degrees
-static std::vector<float> gLongitudeDegrees;  // lon[N] in degrees
-
-// ---------------- Packed KD-tree for 2D lat/lon --------------------
-namespace kd2d
-{
-
-enum class SplitAxis : uint8_t
-{
-  Latitude = 0,
-  Longitude = 1
-};
-
-struct KDNode
-{
-  uint32_t pointIndex;  // index into gLatitudeDegrees/gLongitudeDegrees
-  int32_t leftChild;    // -1 if none
-  int32_t rightChild;   // -1 if none
-  SplitAxis splitAxis;  // which coordinate this node splits on
-};
-
-class PackedKDTree
-{
- public:
-  void build(const std::vector<float>& latitudeDegrees,
-             const std::vector<float>& longitudeDegrees)
-  {
-    clear();
-    const uint32_t totalPoints = static_cast<uint32_t>(latitudeDegrees.size());
-    if (totalPoints == 0) return;
-
-    pointIndexScratch.resize(totalPoints);
-    for (uint32_t i = 0; i < totalPoints; ++i) pointIndexScratch[i] = i;
-
-    rootNodeIndex = static_cast<int32_t>(buildRecursive(
-        0, totalPoints, /*depth=*/0, latitudeDegrees, longitudeDegrees));
-  }
-
-  bool empty() const { return kdNodes.empty(); }
-
-  // Returns original point index, or UINT32_MAX if empty.
-  uint32_t nearestNeighbor(float queryLatitudeDegrees,
-                           float queryLongitudeDegrees,
-                           const std::vector<float>& latitudeDegrees,
-                           const std::vector<float>& longitudeDegrees) const
-  {
-    if (empty()) return UINT32_MAX;
-
-    const double kDegToRad = 3.14159265358979323846 / 180.0;
-    const double cosQueryLatitude = std::cos(queryLatitudeDegrees * kDegToRad);
-
-    uint32_t bestPointIndex = UINT32_MAX;
-    double bestDistanceSquared = std::numeric_limits<double>::infinity();
-
-    nearestRecursive(rootNodeIndex, queryLatitudeDegrees, queryLongitudeDegrees,
-                     cosQueryLatitude, latitudeDegrees, longitudeDegrees,
-                     bestPointIndex, bestDistanceSquared);
-    return bestPointIndex;
-  }
-
- private:
-  std::vector<KDNode> kdNodes;
-  std::vector<uint32_t> pointIndexScratch;  // used during build partitioning
-  int32_t rootNodeIndex = -1;
-
-  void clear()
-  {
-    kdNodes.clear();
-    pointIndexScratch.clear();
-    rootNodeIndex = -1;
-  }
-
-  static inline double equirectangularDistanceSquared(double latA, double lonA,
-                                                      double latB, double lonB,
-                                                      double cosLatA)
-  {
-    const double deltaLat = latB - latA;
-    const double deltaLonScaled = (lonB - lonA) * cosLatA;
-    return deltaLat * deltaLat + deltaLonScaled * deltaLonScaled;
-  }
-
-  uint32_t buildRecursive(uint32_t startInclusive, uint32_t endExclusive,
-                          uint32_t treeDepth,
-                          const std::vector<float>& latitudeDegrees,
-                          const std::vector<float>& longitudeDegrees)
-  {
-    if (startInclusive >= endExclusive) return UINT32_MAX;
-
-    const SplitAxis chosenAxis =
-        (treeDepth & 1) ? SplitAxis::Longitude : SplitAxis::Latitude;
-
-    const uint32_t medianIndex = (startInclusive + endExclusive) / 2;
-
-    // Partition around median along the chosen axis.
-    auto lessOnAxis = [&](uint32_t a, uint32_t b) {
-      if (chosenAxis == SplitAxis::Latitude)
-        return latitudeDegrees[a] < latitudeDegrees[b];
-      else
-        return longitudeDegrees[a] < longitudeDegrees[b];
-    };
-    std::nth_element(pointIndexScratch.begin() + startInclusive,
-                     pointIndexScratch.begin() + medianIndex,
-                     pointIndexScratch.begin() + endExclusive, lessOnAxis);
-
-    const uint32_t pointIndexAtNode = pointIndexScratch[medianIndex];
-
-    // Build children first so their indices are known.
-    int32_t leftChildIndex = -1;
-    int32_t rightChildIndex = -1;
-
-    if (medianIndex > startInclusive)
-    {
-      leftChildIndex = static_cast<int32_t>(
-          buildRecursive(startInclusive, medianIndex, treeDepth + 1,
-                         latitudeDegrees, longitudeDegrees));
-    }
-    if (medianIndex + 1 < endExclusive)
-    {
-      rightChildIndex = static_cast<int32_t>(
-          buildRecursive(medianIndex + 1, endExclusive, treeDepth + 1,
-                         latitudeDegrees, longitudeDegrees));
-    }
-
-    const int32_t myNodeIndex = static_cast<int32_t>(kdNodes.size());
-    kdNodes.push_back(
-        KDNode{pointIndexAtNode, leftChildIndex, rightChildIndex, chosenAxis});
-    return static_cast<uint32_t>(myNodeIndex);
-  }
+#include "graphLoader.hpp"
+#include "kdTree.hpp"
 
-  void nearestRecursive(int32_t nodeIndex, float queryLatitudeDegrees,
-                        float queryLongitudeDegrees, double cosQueryLatitude,
-                        const std::vector<float>& latitudeDegrees,
-                        const std::vector<float>& longitudeDegrees,
-                        uint32_t& bestPointIndex,
-                        double& bestDistanceSquared) const
-  {
-    if (nodeIndex < 0) return;
-
-    const KDNode& node = kdNodes[static_cast<size_t>(nodeIndex)];
-    const uint32_t nodePointIndex = node.pointIndex;
-
-    // 1) Check the point at this node
-    const double distanceSquared = equirectangularDistanceSquared(
-        queryLatitudeDegrees, queryLongitudeDegrees,
-        latitudeDegrees[nodePointIndex], longitudeDegrees[nodePointIndex],
-        cosQueryLatitude);
-
-    if (distanceSquared < bestDistanceSquared)
-    {
-      bestDistanceSquared = distanceSquared;
-      bestPointIndex = nodePointIndex;
-    }
+// ---------------- Mapped nodes ----------------
+// The same file route.node maps: both mappings share the page cache, and
+// the ids section is never touched, so it is never resident.
+static NodesView gNodes;
 
-    // 2) Decide which child to explore first (near side) and compute split
-    // delta^2
-    int32_t nearChildIndex = node.leftChild;
-    int32_t farChildIndex = node.rightChild;
-    double splitDeltaSquared;
-
-    if (node.splitAxis == SplitAxis::Latitude)
-    {
-      const float splitLatitude = latitudeDegrees[nodePointIndex];
-      const bool goLeftFirst = (queryLatitudeDegrees < splitLatitude);
-      nearChildIndex = goLeftFirst ? node.leftChild : node.rightChild;
-      farChildIndex = goLeftFirst ? node.rightChild : node.leftChild;
-      const double deltaLat = queryLatitudeDegrees - splitLatitude;
-      splitDeltaSquared = deltaLat * deltaLat;  // degrees^2
-    }
-    else
-    {
-      const float splitLongitude = longitudeDegrees[nodePointIndex];
-      const bool goLeftFirst = (queryLongitudeDegrees < splitLongitude);
-      nearChildIndex = goLeftFirst ? node.leftChild : node.rightChild;
-      farChildIndex = goLeftFirst ? node.rightChild : node.leftChild;
-      const double deltaLonScaled =
-          (queryLongitudeDegrees - splitLongitude) * cosQueryLatitude;
-      splitDeltaSquared = deltaLonScaled * deltaLonScaled;  // scaled degrees^2
-    }
-
-    // 3) Explore near side
-    if (nearChildIndex >= 0)
-    {
-      nearestRecursive(nearChildIndex, queryLatitudeDegrees,
-                       queryLongitudeDegrees, cosQueryLatitude, latitudeDegrees,
-                       longitudeDegrees, bestPointIndex, bestDistanceSquared);
-    }
-
-    // 4) Explore far side only if it can contain a closer point
-    if (farChildIndex >= 0 && splitDeltaSquared < bestDistanceSquared)
-    {
-      nearestRecursive(farChildIndex, queryLatitudeDegrees,
-                       queryLongitudeDegrees, cosQueryLatitude, latitudeDegrees,
-                       longitudeDegrees, bestPointIndex, bestDistanceSquared);
-    }
-  }
-};
-
-}  // namespace kd2d
-
-// Single global KD-tree instance
+// Single global KD-tree instance, over gSpatial when that is loaded
 static kd2d::PackedKDTree gKdTree;
+static SpatialView gSpatial;
 static std::string gNodesPath;
+static std::string gSpatialPath;
 
 static std::string resolvePath(const std::string& filePath)
 {
@@ -249,44 +39,39 @@ static std::string resolvePath(const std::string& filePath)
   return filePath;
 }
 
-// ---------------- Loader for the exact binary layout ----------------
-static bool loadFromGraphNodes(const std::string& filePath)
+static std::string siblingPath(const std::string& filePath,
+                               const std::string& fileName)
 {
-  std::ifstream input(filePath, std::ios::binary);
-  if (!input) return false;
-
-  NodesHeader header{};
-  input.read(reinterpret_cast<char*>(&header), sizeof(header));
-  if (!input)
-    throw std::runtime_error("graph_nodes.bin: failed to read 16-byte header");
+  const size_t slash = filePath.find_last_of('/');
+  if (slash == std::string::npos) return fileName;
+  return filePath.substr(0, slash + 1) + fileName;
+}
 
-  if (std::memcmp(header.magic, "MMAPNODE", 8) != 0)
+// graph_spatial.bin (ingest/buildSpatial) next to the nodes bin saves the
+// build; without a usable one the tree is built as before.
+static void loadKdTree(const std::string& nodesPath)
+{
+  gSpatialPath = siblingPath(nodesPath, "graph_spatial.bin");
+  try
+  {
+    gSpatial = loadSpatial(gSpatialPath, gNodes);
+    gKdTree.adopt(gSpatial.kdNodes, gSpatial.numNodes, gSpatial.rootIndex);
+    std::cerr << "[kd_snap] mapped " << gSpatialPath << "\n";
+  } catch (const std::exception& e)
   {
-    throw std::runtime_error(
-        "graph_nodes.bin: bad magic (expected \"MMAPNODE\")");
+    gSpatial = SpatialView{};
+    std::cerr << "[kd_snap] building KD-tree (" << e.what() << ")\n";
+    gKdTree.build(gNodes.lat_f32, gNodes.lon_f32, gNodes.numNodes);
   }
-  const uint32_t nodeCount = header.numNodes;
-
-  // Read NodeIDs (N * uint64)
-  gOsmNodeIds.resize(nodeCount);
-  input.read(reinterpret_cast<char*>(gOsmNodeIds.data()),
-             static_cast<std::streamsize>(sizeof(uint64_t)) * nodeCount);
-  if (!input) throw std::runtime_error("graph_nodes.bin: truncated NodeIDs[]");
-
-  // Read Latitudes (N * float)
-  gLatitudeDegrees.resize(nodeCount);
-  input.read(reinterpret_cast<char*>(gLatitudeDegrees.data()),
-             static_cast<std::streamsize>(sizeof(float)) * nodeCount);
-  if (!input) throw std::runtime_error("graph_nodes.bin: truncated lat[]");
+}
 
-  // Read Longitudes (N * float)
-  gLongitudeDegrees.resize(nodeCount);
-  input.read(reinterpret_cast<char*>(gLongitudeDegrees.data()),
-             static_cast<std::streamsize>(sizeof(float)) * nodeCount);
-  if (!input) throw std::runtime_error("graph_nodes.bin: truncated lon[]");
+static bool loadFromGraphNodes(const std::string& filePath)
+{
+  if (::access(filePath.c_str(), R_OK) != 0) return false;
 
-  // Build KD-tree
-  gKdTree.build(gLatitudeDegrees, gLongitudeDegrees);
+  // Copy-on-write: getLatArray/getLonArray hand these pages to JS
+  gNodes = mapNodes(filePath, /*copyOnWrite=*/true);
+  loadKdTree(filePath);
   return true;
 }
 
@@ -300,7 +85,7 @@ Napi::Value findNearest(const Napi::CallbackInfo& info)
         .ThrowAsJavaScriptException();
     return env.Null();
   }
-  if (gLatitudeDegrees.empty())
+  if (gNodes.numNodes == 0)
   {
     Napi::Error::New(env, "KD-tree not loaded").ThrowAsJavaScriptException();
     return env.Null();
@@ -313,7 +98,7 @@ Napi::Value findNearest(const Napi::CallbackInfo& info)
 
   const uint32_t nearestIndex =
       gKdTree.nearestNeighbor(queryLatitudeDegrees, queryLongitudeDegrees,
-                              gLatitudeDegrees, gLongitudeDegrees);
+                              gNodes.lat_f32, gNodes.lon_f32);
 
   if (nearestIndex == UINT32_MAX)
   {
@@ -333,7 +118,7 @@ Napi::Value getNode(const Napi::CallbackInfo& info)
     return env.Null();
   }
   const uint32_t pointIndex = info[0].As<Napi::Number>().Uint32Value();
-  if (pointIndex >= gLatitudeDegrees.size())
+  if (pointIndex >= gNodes.numNodes)
   {
     Napi::RangeError::New(env, "Index out of range")
         .ThrowAsJavaScriptException();
@@ -342,38 +127,35 @@ Napi::Value getNode(const Napi::CallbackInfo& info)
 
   Napi::Object nodeObj = Napi::Object::New(env);
   nodeObj.Set("idx", Napi::Number::New(env, pointIndex));
-  nodeObj.Set("lat", Napi::Number::New(env, gLatitudeDegrees[pointIndex]));
-  nodeObj.Set("lon", Napi::Number::New(env, gLongitudeDegrees[pointIndex]));
-  // If you want to expose OSM id too:
-  // nodeObj.Set("id", Napi::BigInt::New(env, gOsmNodeIds[pointIndex]));
+  nodeObj.Set("lat", Napi::Number::New(env, gNodes.lat_f32[pointIndex]));
+  nodeObj.Set("lon", Napi::Number::New(env, gNodes.lon_f32[pointIndex]));
+  // If you want to expose OSM id too (mapped, paged in on first use):
+  // nodeObj.Set("id", Napi::BigInt::New(env, gNodes.ids[pointIndex]));
   return nodeObj;
 }
 
-Napi::Value GetLatArray(const Napi::CallbackInfo& info)
+// Float32Array over one mapped coordinate array. The mapping lives as long
+// as gNodes (the whole process), so the finalizer has nothing to free.
+static Napi::Float32Array mappedFloat32Array(Napi::Env env,
+                                             const float* values)
 {
-  Napi::Env env = info.Env();
-  if (gLatitudeDegrees.empty()) return Napi::Float32Array::New(env, 0);
+  if (gNodes.numNodes == 0) return Napi::Float32Array::New(env, 0);
 
   Napi::ArrayBuffer backingBuffer = Napi::ArrayBuffer::New(
-      env, static_cast<void*>(gLatitudeDegrees.data()),
-      gLatitudeDegrees.size() * sizeof(float),
+      env, const_cast<float*>(values), gNodes.numNodes * sizeof(float),
       [](Napi::Env, void*) {});  // no-op finalizer: we keep ownership
 
-  return Napi::Float32Array::New(env, gLatitudeDegrees.size(), backingBuffer,
-                                 0);
+  return Napi::Float32Array::New(env, gNodes.numNodes, backingBuffer, 0);
 }
 
-Napi::Value GetLonArray(const Napi::CallbackInfo& info)
+Napi::Value GetLatArray(const Napi::CallbackInfo& info)
 {
-  Napi::Env env = info.Env();
-  if (gLongitudeDegrees.empty()) return Napi::Float32Array::New(env, 0);
-
-  Napi::ArrayBuffer backingBuffer = Napi::ArrayBuffer::New(
-      env, static_cast<void*>(gLongitudeDegrees.data()),
-      gLongitudeDegrees.size() * sizeof(float), [](Napi::Env, void*) {});
+  return mappedFloat32Array(info.Env(), gNodes.lat_f32);
+}
 
-  return Napi::Float32Array::New(env, gLongitudeDegrees.size(), backingBuffer,
-                                 0);
+Napi::Value GetLonArray(const Napi::CallbackInfo& info)
+{
+  return mappedFloat32Array(info.Env(), gNodes.lon_f32);
 }
 
 Napi::Value GetGraphInfo(const Napi::CallbackInfo& info)
@@ -381,10 +163,11 @@ Napi::Value GetGraphInfo(const Napi::CallbackInfo& info)
   Napi::Env env = info.Env();
   Napi::Object out = Napi::Object::New(env);
 
-  out.Set("loaded", Napi::Boolean::New(env, !gLatitudeDegrees.empty()));
-  out.Set("numNodes",
-          Napi::Number::New(env, static_cast<double>(gLatitudeDegrees.size())));
+  out.Set("loaded", Napi::Boolean::New(env, gNodes.numNodes > 0));
+  out.Set("numNodes", Napi::Number::New(env, gNodes.numNodes));
   out.Set("nodesPath", Napi::String::New(env, gNodesPath));
+  out.Set("spatialMapped", Napi::Boolean::New(env, gSpatial.hold != nullptr));
+  out.Set("spatialPath", Napi::String::New(env, gSpatialPath));
 
   return out;
 }
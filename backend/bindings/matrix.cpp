@@ -0,0 +1,229 @@
+#include "matrix.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "searchCommon.hpp"
+
+namespace
+{
+constexpr double kInf = std::numeric_limits<double>::infinity();
+
+// Dijkstra from sourceIdx until every node flagged in isTarget is settled
+// (numTargetNodes distinct nodes). Same relaxations as runAStar with a zero
+// heuristic, so each settled node carries the cost aStarTwoLayer finds.
+template <CostKernel kKernel, class Edges, class StateStore, class OpenQueue>
+void settleTargets(const EdgesView& edgesView, const Edges& edges,
+                   uint32_t sourceIdx, const std::vector<uint8_t>& isTarget,
+                   uint32_t numTargetNodes, const AStarParams& params,
+                   const CostModel& costs, StateStore& states,
+                   OpenQueue& openPQ)
+{
+  const uint32_t S_ride = StateKey::idx(sourceIdx, Layer::Ride);
+  const uint32_t S_walk = StateKey::idx(sourceIdx, Layer::Walk);
+
+  states.reset(StateKey::kLayers * edgesView.numNodes);
+  SearchState& sourceRide = states.at(S_ride);
+  sourceRide.gCost = 0.0;
+  sourceRide.gTime = 0.0;
+  SearchState& sourceWalk = states.at(S_walk);
+  sourceWalk.gCost = 0.0;
+  sourceWalk.gTime = 0.0;
+
+  openPQ.clear();
+  openPQ.push(0.0, S_ride, sourceRide);
+  openPQ.push(0.0, S_walk, sourceWalk);
+
+  auto relax = [&](const SearchState& cur, uint32_t curIdx, uint32_t nextIdx,
+                   uint32_t edgeIdx, double timeS, double penaltyS,
+                   uint8_t stepLabel) {
+    SearchState& next = states.at(nextIdx);
+    const double tentativeCost = cur.gCost + timeS + penaltyS;
+    if (tentativeCost < next.gCost)
+    {
+      next.gCost = tentativeCost;
+      next.gTime = cur.gTime + timeS;
+      next.parent = curIdx;
+      next.parentMode = stepLabel;
+      next.parentEdge = edgeIdx;
+      openPQ.push(tentativeCost, nextIdx, next);
+    }
+  };
+
+  uint32_t remaining = numTargetNodes;
+  while (remaining > 0 && !openPQ.empty())
+  {
+    const uint32_t uIdx = openPQ.pop().stateKey;
+    const uint32_t u = uIdx / StateKey::kLayers;
+    const Layer layer = static_cast<Layer>(uIdx % StateKey::kLayers);
+    SearchState& cur = states.at(uIdx);
+    if (cur.closed) continue;
+    cur.closed = 1;
+
+    // First layer of a target node to settle: that node is done
+    if (isTarget[u] && !states.at(uIdx ^ 1u).closed) --remaining;
+
+    const uint32_t begin = edgesView.offsets[u];
+    const uint32_t end = edgesView.offsets[u + 1];
+
+    if (layer == Layer::Ride)
+    {
+      for (uint32_t edgeIdx{begin}; edgeIdx < end; ++edgeIdx)
+      {
+        double timeS, penaltyS;
+        uint8_t stepLabel;
+        if (!costs.ride<kKernel>(edges, edgeIdx, timeS, penaltyS, stepLabel))
+          continue;
+        relax(cur, uIdx, StateKey::idx(edges.head(edgeIdx), Layer::Ride),
+              edgeIdx, timeS, penaltyS, stepLabel);
+      }
+      if (params.rideToWalkPenaltyS >= 0.0)
+        relax(cur, uIdx, StateKey::idx(u, Layer::Walk), UINT32_MAX, 0.0,
+              params.rideToWalkPenaltyS, 0);
+    }
+    else
+    {
+      for (uint32_t edgeIdx{begin}; edgeIdx < end; ++edgeIdx)
+      {
+        double timeS;
+        if (!costs.walk<kKernel>(edges, edgeIdx, timeS)) continue;
+        relax(cur, uIdx, StateKey::idx(edges.head(edgeIdx), Layer::Walk),
+              edgeIdx, timeS, 0.0, MODE_FOOT);
+      }
+      if (params.walkToRidePenaltyS >= 0.0)
+        relax(cur, uIdx, StateKey::idx(u, Layer::Ride), UINT32_MAX, 0.0,
+              params.walkToRidePenaltyS, 0);
+    }
+  }
+}
+
+// Read one matrix row off the settled labels. A target's route ends in the
+// cheaper of its settled layers; its length is summed along the parents.
+template <class StateStore>
+void fillRow(const EdgesView& edgesView, StateStore& states,
+             const std::vector<uint32_t>& targets, double* durationsS,
+             double* distancesM)
+{
+  for (std::size_t j{0}; j < targets.size(); ++j)
+  {
+    uint32_t best = UINT32_MAX;
+    for (Layer layer : {Layer::Ride, Layer::Walk})
+    {
+      const uint32_t key = StateKey::idx(targets[j], layer);
+      const SearchState& state = states.at(key);
+      if (!state.closed) continue;
+      if (best == UINT32_MAX || state.gCost < states.at(best).gCost)
+        best = key;
+    }
+
+    if (best == UINT32_MAX)
+    {
+      durationsS[j] = kInf;
+      distancesM[j] = kInf;
+      continue;
+    }
+
+    double meters = 0.0;
+    for (uint32_t cur{best}; cur != UINT32_MAX;)
+    {
+      const SearchState& state = states.at(cur);
+      if (state.parentEdge != UINT32_MAX)
+        meters += edgesView.lengthsMeters[state.parentEdge];
+      cur = state.parent;
+    }
+    durationsS[j] = states.at(best).gTime;
+    distancesM[j] = meters;
+  }
+}
+}  // namespace
+
+TravelMatrix computeTravelMatrix(const EdgesView& edgesView,
+                                 const std::vector<uint32_t>& sources,
+                                 const std::vector<uint32_t>& targets,
+                                 const AStarParams& params,
+                                 const SearchOptions& options,
+                                 unsigned numThreads)
+{
+  const uint32_t numNodes = edgesView.numNodes;
+  for (uint32_t sourceIdx : sources)
+  {
+    if (sourceIdx >= numNodes) throw std::runtime_error("source out of range");
+  }
+  for (uint32_t targetIdx : targets)
+  {
+    if (targetIdx >= numNodes) throw std::runtime_error("target out of range");
+  }
+  // Speeds are checked the same way as for a single route
+  if (!sources.empty() && !targets.empty())
+    validateQuery(edgesView, sources.front(), targets.front(), params);
+  if (options.edgeLayout == EdgeLayout::Packed && !edgesView.packed)
+    throw std::runtime_error("edgeLayout packed: graph has no packed edges");
+
+  TravelMatrix matrix;
+  matrix.numSources = static_cast<uint32_t>(sources.size());
+  matrix.numTargets = static_cast<uint32_t>(targets.size());
+  const std::size_t numCells = sources.size() * targets.size();
+  matrix.durationsS.assign(numCells, kInf);
+  matrix.distancesM.assign(numCells, kInf);
+  if (numCells == 0) return matrix;
+
+  std::vector<uint8_t> isTarget(numNodes, 0);
+  uint32_t numTargetNodes = 0;
+  for (uint32_t targetIdx : targets)
+  {
+    if (!isTarget[targetIdx]) ++numTargetNodes;
+    isTarget[targetIdx] = 1;
+  }
+
+  const CostModel costs(params, edgesView);
+  std::atomic<std::size_t> nextRow{0};
+
+  // Rows are independent; each thread takes the next unclaimed one.
+  auto worker = [&]() {
+    WorkspacePool& pool = WorkspacePool::shared();
+    std::unique_ptr<SearchWorkspace> workspace = pool.acquire();
+
+    withSearchPolicies(
+        *workspace, StateStorage::Dense, options.queue,
+        [&](auto& states, auto& openPQ, auto& /*backwardStates*/,
+            auto& /*backwardPQ*/) {
+          withCostKernel(costs.kernel(), [&](auto kernel) {
+            withEdgeLayout(
+                edgesView, options.edgeLayout, [&](const auto& edges) {
+                  for (std::size_t row = nextRow++; row < sources.size();
+                       row = nextRow++)
+                  {
+                    settleTargets<decltype(kernel)::value>(
+                        edgesView, edges, sources[row], isTarget,
+                        numTargetNodes, params, costs, states, openPQ);
+                    const std::size_t at = row * targets.size();
+                    fillRow(edgesView, states, targets,
+                            matrix.durationsS.data() + at,
+                            matrix.distancesM.data() + at);
+                  }
+                });
+          });
+        });
+
+    pool.release(std::move(workspace));
+  };
+
+  // More threads only on request: each one is outside any pool the
+  // caller runs on
+  numThreads = static_cast<unsigned>(std::min<std::size_t>(
+      std::max(1u, numThreads), sources.size()));
+
+  std::vector<std::thread> threads;
+  threads.reserve(numThreads - 1);
+  for (unsigned i{1}; i < numThreads; ++i) threads.emplace_back(worker);
+  worker();  // the calling thread takes rows too
+  for (std::thread& thread : threads) thread.join();
+
+  return matrix;
+}
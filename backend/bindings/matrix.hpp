@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "aStar.hpp"
+#include "route.hpp"
+
+// ---------------- Many-to-many travel-time matrix ----------------
+// One Dijkstra per source over the two-layer graph with the same costs as
+// aStarTwoLayer; a row stops as soon as every target node is settled.
+// Each cell describes the route aStarTwoLayer would return for that pair.
+
+struct TravelMatrix
+{
+  std::uint32_t numSources{0};
+  std::uint32_t numTargets{0};
+
+  // Row-major, cell (i, j) at i * numTargets + j; +inf if unreachable
+  std::vector<double> durationsS;
+  std::vector<double> distancesM;
+};
+
+// All rows, spread over numThreads threads, the calling one included
+// (0 = 1: the calling thread only).
+// Threads borrow workspaces from a process-wide pool, so repeated calls do
+// not reallocate the 2 * numNodes labels.
+[[nodiscard]]
+TravelMatrix computeTravelMatrix(const EdgesView& edgesView,
+                                 const std::vector<std::uint32_t>& sources,
+                                 const std::vector<std::uint32_t>& targets,
+                                 const AStarParams& params,
+                                 const SearchOptions& options = {},
+                                 unsigned numThreads = 0);
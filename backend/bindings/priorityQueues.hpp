@@ -0,0 +1,267 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "searchWorkspace.hpp"
+
+// ---------------- Open-set policies for the two-layer search ----------------
+// All policies share one interface so the search loop is written once:
+//   clear()                         drop everything, keep capacity
+//   empty()
+//   size()                          queued entries (stale ones included)
+//   push(priorityF, stateKey, st)   insert, or lower the key if queued
+//   pop() -> QueueEntry             smallest key first
+//   topKey()                        lower bound on the smallest key
+// Lazy policies may return an entry for a state that was already settled;
+// the search skips those via SearchState::closed.
+
+struct QueueEntry
+{
+  double priorityF;
+  std::uint32_t stateKey;
+};
+
+enum class QueuePolicy : std::uint8_t
+{
+  Binary = 0,  // binary heap, lazy deletion (re-push on improvement)
+  Dary4 = 1,   // indexed 4-ary heap with decrease-key
+  Radix = 2    // monotone radix heap over millisecond-quantized keys
+};
+
+// Build-time default; override with -DROUTE_DEFAULT_QUEUE=QueuePolicy::Binary
+#ifndef ROUTE_DEFAULT_QUEUE
+#define ROUTE_DEFAULT_QUEUE QueuePolicy::Dary4
+#endif
+
+// Binary min-heap with duplicates. Every improvement pushes a new entry;
+// stale ones are skipped when popped.
+class BinaryHeapQueue
+{
+ public:
+  void clear() { heap.clear(); }
+  bool empty() const { return heap.empty(); }
+  std::size_t size() const { return heap.size(); }
+
+  void push(double priorityF, std::uint32_t stateKey, SearchState& /*state*/)
+  {
+    heap.push_back(QueueEntry{priorityF, stateKey});
+    std::push_heap(heap.begin(), heap.end(), greater);
+  }
+
+  double topKey() const { return heap.front().priorityF; }
+
+  QueueEntry pop()
+  {
+    std::pop_heap(heap.begin(), heap.end(), greater);
+    const QueueEntry top = heap.back();
+    heap.pop_back();
+    return top;
+  }
+
+ private:
+  static bool greater(const QueueEntry& a, const QueueEntry& b) noexcept
+  {
+    return a.priorityF > b.priorityF;
+  }
+
+  std::vector<QueueEntry> heap;
+};
+
+// Indexed d-ary min-heap. Each queued state records its slot in
+// SearchState::heapPos, so an improved label moves the existing entry up
+// instead of adding a duplicate. Arity 4 keeps siblings in one cache line.
+template <std::uint32_t Arity>
+class IndexedDaryHeap
+{
+  static_assert(Arity >= 2, "heap arity must be >= 2");
+
+ public:
+  // Stale heapPos values need no reset: state stores hand out fresh records
+  // (heapPos = kNotInHeap) on a state's first touch in the next query.
+  void clear() { heap.clear(); }
+  bool empty() const { return heap.empty(); }
+  std::size_t size() const { return heap.size(); }
+
+  void push(double priorityF, std::uint32_t stateKey, SearchState& state)
+  {
+    std::uint32_t pos = state.heapPos;
+    if (pos == kNotInHeap)
+    {
+      pos = static_cast<std::uint32_t>(heap.size());
+      heap.push_back(Slot{priorityF, stateKey, &state});
+      state.heapPos = pos;
+    }
+    else
+    {
+      if (priorityF >= heap[pos].priorityF) return;
+      heap[pos].priorityF = priorityF;
+    }
+    siftUp(pos);
+  }
+
+  double topKey() const { return heap.front().priorityF; }
+
+  QueueEntry pop()
+  {
+    const Slot top = heap.front();
+    top.state->heapPos = kNotInHeap;
+
+    const Slot last = heap.back();
+    heap.pop_back();
+    if (!heap.empty())
+    {
+      heap.front() = last;
+      last.state->heapPos = 0;
+      siftDown(0);
+    }
+    return QueueEntry{top.priorityF, top.stateKey};
+  }
+
+ private:
+  inline static constexpr std::uint32_t kNotInHeap = SearchState::kNotInHeap;
+
+  struct Slot
+  {
+    double priorityF;
+    std::uint32_t stateKey;
+    SearchState* state;  // stable for the whole query (see state stores)
+  };
+
+  void place(std::uint32_t pos, const Slot& slot)
+  {
+    heap[pos] = slot;
+    slot.state->heapPos = pos;
+  }
+
+  void siftUp(std::uint32_t pos)
+  {
+    const Slot moving = heap[pos];
+    while (pos > 0)
+    {
+      const std::uint32_t parentPos = (pos - 1) / Arity;
+      if (heap[parentPos].priorityF <= moving.priorityF) break;
+      place(pos, heap[parentPos]);
+      pos = parentPos;
+    }
+    place(pos, moving);
+  }
+
+  void siftDown(std::uint32_t pos)
+  {
+    const Slot moving = heap[pos];
+    const std::uint32_t size = static_cast<std::uint32_t>(heap.size());
+    for (;;)
+    {
+      const std::uint32_t firstChild = pos * Arity + 1;
+      if (firstChild >= size) break;
+      const std::uint32_t lastChild = std::min(firstChild + Arity, size);
+
+      std::uint32_t best = firstChild;
+      for (std::uint32_t c{firstChild + 1}; c < lastChild; ++c)
+      {
+        if (heap[c].priorityF < heap[best].priorityF) best = c;
+      }
+      if (heap[best].priorityF >= moving.priorityF) break;
+      place(pos, heap[best]);
+      pos = best;
+    }
+    place(pos, moving);
+  }
+
+  std::vector<Slot> heap;
+};
+
+// Radix heap (Ahuja et al.) over integer keys. Valid because A* with a
+// consistent heuristic pops f in non-decreasing order. Keys are quantized
+// to milliseconds, so ordering is exact up to that quantum; a key below the
+// last popped one (inconsistent heuristic, rounding) is clamped up to it.
+class RadixHeapQueue
+{
+ public:
+  inline static constexpr double kTicksPerSecond = 1000.0;
+
+  void clear()
+  {
+    for (auto& bucket : buckets) bucket.clear();
+    lastTicks = 0;
+    count = 0;
+  }
+  bool empty() const { return count == 0; }
+  std::size_t size() const { return count; }
+
+  void push(double priorityF, std::uint32_t stateKey, SearchState& /*state*/)
+  {
+    std::uint32_t ticks = toTicks(priorityF);
+    if (ticks < lastTicks) ticks = lastTicks;
+    buckets[bucketIndex(ticks)].push_back(Item{ticks, stateKey, priorityF});
+    ++count;
+  }
+
+  // Exact up to the quantum: every queued key is >= lastTicks afterwards.
+  double topKey()
+  {
+    normalize();
+    return static_cast<double>(lastTicks) / kTicksPerSecond;
+  }
+
+  QueueEntry pop()
+  {
+    normalize();
+    const Item item = buckets[0].back();
+    buckets[0].pop_back();
+    --count;
+    return QueueEntry{item.priorityF, item.stateKey};
+  }
+
+ private:
+  struct Item
+  {
+    std::uint32_t ticks;
+    std::uint32_t stateKey;
+    double priorityF;
+  };
+
+  // Make bucket 0 non-empty. The new minimum becomes the reference and every
+  // item of the first non-empty bucket lands in a strictly lower one.
+  void normalize()
+  {
+    if (!buckets[0].empty()) return;
+
+    std::size_t i{1};
+    while (buckets[i].empty()) ++i;
+
+    std::vector<Item>& from = buckets[i];
+    std::uint32_t minTicks = from.front().ticks;
+    for (const Item& item : from) minTicks = std::min(minTicks, item.ticks);
+    lastTicks = minTicks;
+    for (const Item& item : from)
+      buckets[bucketIndex(item.ticks)].push_back(item);
+    from.clear();
+  }
+
+  static std::uint32_t toTicks(double priorityF) noexcept
+  {
+    constexpr double kMaxTicks =
+        static_cast<double>(std::numeric_limits<std::uint32_t>::max() - 1);
+    const double ticks = priorityF * kTicksPerSecond;
+    if (!(ticks > 0.0)) return 0;
+    return ticks >= kMaxTicks ? static_cast<std::uint32_t>(kMaxTicks)
+                              : static_cast<std::uint32_t>(ticks);
+  }
+
+  // 0 for ticks == lastTicks, else 1 + index of the highest differing bit.
+  std::size_t bucketIndex(std::uint32_t ticks) const noexcept
+  {
+    const std::uint32_t diff = ticks ^ lastTicks;
+    return diff == 0 ? 0 : 32 - static_cast<std::size_t>(__builtin_clz(diff));
+  }
+
+  std::array<std::vector<Item>, 33> buckets;
+  std::uint32_t lastTicks{0};
+  std::size_t count{0};
+};
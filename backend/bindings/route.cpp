@@ -3,222 +3,45 @@
 
 #include "route.hpp"
 
-#include <fcntl.h>
 #include <limits.h>
 #include <napi.h>
-#include <sys/stat.h>
-#include <unistd.h>
+#include <stdlib.h>
 
-#include <cstring>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
 #include <iostream>
+#include <memory>
 #include <optional>
 #include <string>
-#include <system_error>
+#include <thread>
 #include <utility>
 
 #include "aStar.hpp"
-#include "binHeaders.hpp"
-
-// Return a shared_ptr directly (no by-value temporary)
-static std::shared_ptr<MappedFile> mapReadonlySp(const std::string& filePath)
-{
-  auto mapping = std::make_shared<MappedFile>();
-
-  const int fileHandle = ::open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
-  if (fileHandle < 0)
-  {
-    throw std::system_error(errno, std::generic_category(),
-                            "open failed: " + filePath);
-  }
-  mapping->fileHandle = fileHandle;
-
-  struct stat fileStat{};
-  if (::fstat(fileHandle, &fileStat) != 0)
-  {
-    ::close(fileHandle);
-    mapping->fileHandle = -1;
-    throw std::system_error(errno, std::generic_category(),
-                            "fstat failed: " + filePath);
-  }
-
-  mapping->size = static_cast<size_t>(fileStat.st_size);
-  if (mapping->size == 0)
-  {
-    // You can choose to allow empty files; here we treat it as an error.
-    ::close(fileHandle);
-    mapping->fileHandle = -1;
-    throw std::runtime_error("mmap failed: file is empty: " + filePath);
-  }
-
-  void* mappedAddress =
-      ::mmap(nullptr, mapping->size, PROT_READ, MAP_PRIVATE, fileHandle, 0);
-  if (mappedAddress == MAP_FAILED)
-  {
-    ::close(fileHandle);
-    mapping->fileHandle = -1;
-    throw std::system_error(errno, std::generic_category(),
-                            "mmap failed: " + filePath);
-  }
-
-  mapping->base = mappedAddress;
-  return mapping;
-}
-
-static NodesView loadNodes(const std::string& filePath)
-{
-  auto mapping = mapReadonlySp(filePath);
-  const char* cursor = static_cast<const char*>(mapping->base);
-  const char* endPtr = cursor + mapping->size;
-
-  auto requireBytes = [&](size_t bytes) {
-    if (cursor + bytes > endPtr)
-    {
-      throw std::runtime_error("nodes bin truncated");
-    }
-  };
-
-  // Header
-  requireBytes(sizeof(ingest::NodesHeader));
-  const auto* header = reinterpret_cast<const ingest::NodesHeader*>(cursor);
-  if (std::memcmp(header->magic, "MMAPNODE", 8) != 0)
-  {
-    throw std::runtime_error("bad nodes header");
-  }
-  cursor += sizeof(*header);
-
-  NodesView nodesView;
-  nodesView.hold = mapping;
-  nodesView.numNodes = header->numNodes;
-
-  // IDs
-  requireBytes(sizeof(uint64_t) * nodesView.numNodes);
-  nodesView.ids = reinterpret_cast<const uint64_t*>(cursor);
-  cursor += sizeof(uint64_t) * nodesView.numNodes;
-
-  // Coordinates
-  requireBytes(sizeof(float) * nodesView.numNodes * 2);
-  nodesView.lat_f32 = reinterpret_cast<const float*>(cursor);
-  cursor += sizeof(float) * nodesView.numNodes;
-  nodesView.lon_f32 = reinterpret_cast<const float*>(cursor);
-  cursor += sizeof(float) * nodesView.numNodes;
-
-  return nodesView;
-}
-
-static EdgesView loadEdges(const std::string& filePath)
-{
-  auto mapping = mapReadonlySp(filePath);
-  const char* cursor = static_cast<const char*>(mapping->base);
-  const char* endPtr = cursor + mapping->size;
-
-  auto requireBytes = [&](size_t bytes) {
-    if (cursor + bytes > endPtr)
-    {
-      throw std::runtime_error("edges bin truncated: " + filePath);
-    }
-  };
-
-  // --- Header ---
-  requireBytes(sizeof(ingest::EdgesHeader));
-  const auto* header = reinterpret_cast<const ingest::EdgesHeader*>(cursor);
-
-  // accept both
-  const bool okMagic = (std::memcmp(header->magic, "MMAPGRPH", 8) == 0) ||
-                       (std::memcmp(header->magic, "MMAPEDGE", 8) == 0);
-  if (!okMagic)
-  {
-    throw std::runtime_error("bad edges header: " + filePath);
-  }
-  if (header->lengthType != 0)
-  {
-    throw std::runtime_error(
-        "unsupported lengthType (expected float32 meters): " + filePath);
-  }
-  cursor += sizeof(*header);
-
-  // --- Lengths block (6×u32) ---
-  requireBytes(6 * sizeof(uint32_t));
-  uint32_t offsetsSize, neighborsSize, lengthsSize, surfacePrimarySize,
-      modeMasksSize;
-
-  std::memcpy(&offsetsSize, cursor, 4);
-  cursor += 4;
-  std::memcpy(&neighborsSize, cursor, 4);
-  cursor += 4;
-  std::memcpy(&lengthsSize, cursor, 4);
-  cursor += 4;
-  std::memcpy(&surfacePrimarySize, cursor, 4);
-  cursor += 4;
-  std::memcpy(&modeMasksSize, cursor, 4);
-  cursor += 4;
-
-  // Basic consistency
-  if (offsetsSize != header->numNodes + 1 ||
-      neighborsSize != header->numEdges || lengthsSize != header->numEdges)
-  {
-    throw std::runtime_error("lengths block mismatch: " + filePath);
-  }
-  if (header->hasSurfacePrimary && surfacePrimarySize != header->numEdges)
-  {
-    throw std::runtime_error("primary length mismatch: " + filePath);
-  }
-  if (header->hasModeMask && modeMasksSize != header->numEdges)
-  {
-    throw std::runtime_error("modeMask length mismatch: " + filePath);
-  }
-
-  // --- Views ---
-  EdgesView edgesView;
-  edgesView.hold = mapping;
-  edgesView.numNodes = header->numNodes;
-  edgesView.numEdges = header->numEdges;
-
-  requireBytes(sizeof(uint32_t) * offsetsSize);
-  edgesView.offsets = reinterpret_cast<const uint32_t*>(cursor);
-  cursor += sizeof(uint32_t) * offsetsSize;
-
-  requireBytes(sizeof(uint32_t) * neighborsSize);
-  edgesView.neighbors = reinterpret_cast<const uint32_t*>(cursor);
-  cursor += sizeof(uint32_t) * neighborsSize;
-
-  requireBytes(sizeof(float) * lengthsSize);
-  edgesView.lengthsMeters = reinterpret_cast<const float*>(cursor);
-  cursor += sizeof(float) * lengthsSize;
-
-  if (header->hasSurfacePrimary)
-  {
-    requireBytes(sizeof(uint8_t) * surfacePrimarySize);
-    edgesView.surfacePrimary = reinterpret_cast<const uint8_t*>(cursor);
-    cursor += sizeof(uint8_t) * surfacePrimarySize;
-  }
-
-  if (header->hasModeMask)
-  {
-    requireBytes(sizeof(uint8_t) * modeMasksSize);
-    edgesView.modeMask = reinterpret_cast<const uint8_t*>(cursor);
-    cursor += sizeof(uint8_t) * modeMasksSize;
-  }
-
-  // Required fields sanity
-  if (!edgesView.modeMask)
-  {
-    throw std::runtime_error("edges bin missing modeMask: " + filePath);
-  }
-
-  if (edgesView.offsets[0] != 0 ||
-      edgesView.offsets[edgesView.numNodes] != edgesView.numEdges)
-  {
-    throw std::runtime_error("bad CSR offsets: " + filePath);
-  }
-
-  return edgesView;
-}
+#include "alternatives.hpp"
+#include "batch.hpp"
+#include "cch.hpp"
+#include "edgeSnap.hpp"
+#include "graphLoader.hpp"
+#include "isochrone.hpp"
+#include "matrix.hpp"
+#include "routeCache.hpp"
+#include "routeGeometry.hpp"
+#include "routePool.hpp"
 
 // ---------------- Global mapped graph ----------------
 static NodesView glNodes;
 static EdgesView glEdges;
+static LandmarksView glLandmarks;  // optional (numLandmarks == 0 if absent)
+static CchView glCch;              // optional (numStates == 0 if absent)
+static CchMetricCache glCchMetrics;
+static EdgeSnapIndex glEdgeSnap;  // built in Init
+static RouteCache glRouteCache;  // ROUTE_CACHE_ENTRIES, default 4096
+static std::unique_ptr<RoutePool> glRoutePool;  // created in Init
 static std::string glNodesPath;
 static std::string glEdgesPath;
+static std::string glLandmarksPath;
+static std::string glCchPath;
 
 static std::string resolvePath(const std::string& filePath)
 {
@@ -299,23 +122,602 @@ static AStarParams parseParams(Napi::Env env, const Napi::Object& obj)
   return params;
 }
 
-class FindPathWorker : public Napi::AsyncWorker
+// Engine options (do not change the route, only how it is searched)
+static SearchOptions parseSearchOptions(const Napi::Object& obj)
+{
+  SearchOptions options;
+
+  if (obj.Has("stateStorage") && obj.Get("stateStorage").IsString())
+  {
+    const std::string storage =
+        obj.Get("stateStorage").As<Napi::String>().Utf8Value();
+    if (storage == "dense")
+      options.storage = StateStorage::Dense;
+    else if (storage == "sparse")
+      options.storage = StateStorage::Sparse;
+    else if (storage == "auto")
+      options.storage = StateStorage::Auto;
+    else
+      throw std::runtime_error("stateStorage must be auto, dense or sparse");
+  }
+  if (obj.Has("queue") && obj.Get("queue").IsString())
+  {
+    const std::string queue = obj.Get("queue").As<Napi::String>().Utf8Value();
+    if (queue == "binary")
+      options.queue = QueuePolicy::Binary;
+    else if (queue == "dary4")
+      options.queue = QueuePolicy::Dary4;
+    else if (queue == "radix")
+      options.queue = QueuePolicy::Radix;
+    else
+      throw std::runtime_error("queue must be binary, dary4 or radix");
+  }
+  if (obj.Has("direction") && obj.Get("direction").IsString())
+  {
+    const std::string direction =
+        obj.Get("direction").As<Napi::String>().Utf8Value();
+    if (direction == "forward")
+      options.direction = SearchDirection::Forward;
+    else if (direction == "bidirectional")
+      options.direction = SearchDirection::Bidirectional;
+    else
+      throw std::runtime_error("direction must be forward or bidirectional");
+  }
+  if (obj.Has("edgeLayout") && obj.Get("edgeLayout").IsString())
+  {
+    const std::string layout =
+        obj.Get("edgeLayout").As<Napi::String>().Utf8Value();
+    if (layout == "auto")
+      options.edgeLayout = EdgeLayout::Auto;
+    else if (layout == "packed")
+      options.edgeLayout = EdgeLayout::Packed;
+    else if (layout == "soa")
+      options.edgeLayout = EdgeLayout::Soa;
+    else
+      throw std::runtime_error("edgeLayout must be auto, packed or soa");
+  }
+  options.landmarks = glLandmarks.numLandmarks > 0 ? &glLandmarks : nullptr;
+  if (obj.Has("heuristic") && obj.Get("heuristic").IsString())
+  {
+    const std::string heuristic =
+        obj.Get("heuristic").As<Napi::String>().Utf8Value();
+    if (heuristic == "haversine")
+      options.landmarks = nullptr;
+    else if (heuristic != "landmarks")
+      throw std::runtime_error("heuristic must be landmarks or haversine");
+  }
+  if (obj.Has("sparseMaxMeters") && obj.Get("sparseMaxMeters").IsNumber())
+  {
+    options.sparseMaxMeters =
+        obj.Get("sparseMaxMeters").As<Napi::Number>().DoubleValue();
+  }
+
+  return options;
+}
+
+// Per-query stop conditions. deadlineMs counts from now, so time spent
+// queued for a pool thread is part of it.
+static SearchLimits parseSearchLimits(const Napi::Object& obj)
+{
+  SearchLimits limits;
+  if (obj.Has("deadlineMs") && obj.Get("deadlineMs").IsNumber())
+  {
+    const double deadlineMs =
+        obj.Get("deadlineMs").As<Napi::Number>().DoubleValue();
+    if (!(deadlineMs > 0.0))
+      throw std::runtime_error("deadlineMs must be positive");
+    limits.deadline =
+        SearchLimits::Clock::now() +
+        std::chrono::duration_cast<SearchLimits::Clock::duration>(
+            std::chrono::duration<double, std::milli>(deadlineMs));
+  }
+  if (obj.Has("maxSettledStates") && obj.Get("maxSettledStates").IsNumber())
+  {
+    limits.maxSettledStates =
+        obj.Get("maxSettledStates").As<Napi::Number>().Uint32Value();
+  }
+  return limits;
+}
+
+// Callback error for a search that ended without a route
+static const char* searchStatusError(SearchStatus status)
+{
+  switch (status)
+  {
+    case SearchStatus::DeadlineExceeded:
+      return "search deadline exceeded";
+    case SearchStatus::BudgetExceeded:
+      return "search budget exceeded";
+    case SearchStatus::Cancelled:
+      return "search cancelled";
+    default:
+      return "no route";
+  }
+}
+
+// CCH answers the query whenever it is loaded, unless A* is asked for
+static bool parseUseCch(const Napi::Object& obj)
+{
+  bool useCch = glCch.numStates > 0;
+  if (obj.Has("algorithm") && obj.Get("algorithm").IsString())
+  {
+    const std::string algorithm =
+        obj.Get("algorithm").As<Napi::String>().Utf8Value();
+    if (algorithm == "astar")
+      useCch = false;
+    else if (algorithm != "cch")
+      throw std::runtime_error("algorithm must be cch or astar");
+    else if (glCch.numStates == 0)
+      throw std::runtime_error("algorithm cch needs data/graph_cch.bin");
+  }
+  return useCch;
+}
+
+// ---------------- Routing pool tasks ----------------
+// A query parsed on the JS thread, searched on a RoutePool thread, and
+// answered back on the JS thread through a thread-safe function. Execute
+// and OnOK mirror Napi::AsyncWorker; err set by Execute (or by a rejected
+// submit) is passed to the callback instead of a result.
+class RouteTask
+{
+ public:
+  virtual ~RouteTask() = default;
+
+  virtual void Execute() = 0;
+  virtual void OnOK() = 0;
+
+  // Hands the task to the pool. A full lane rejects it at once: the
+  // callback then gets "route queue full" on a later tick, no search run.
+  // One still queued when the pool is destroyed gets "route pool shutting
+  // down"; either way the tsfn is released and the task deleted.
+  static void Queue(Napi::Env env, const Napi::Function& cb,
+                    RoutePool::Lane lane, std::unique_ptr<RouteTask> task);
+
+ protected:
+  Napi::Env Env() const { return Napi::Env(env); }
+  const Napi::Function& Callback() const { return callback; }
+
+  std::string err;
+
+ private:
+  // Runs on the JS thread; takes ownership of the task
+  static void Deliver(Napi::Env env, Napi::Function callback,
+                      RouteTask* task);
+
+  napi_env env = nullptr;
+  Napi::Function callback;
+};
+
+void RouteTask::Queue(Napi::Env env, const Napi::Function& cb,
+                      RoutePool::Lane lane, std::unique_ptr<RouteTask> task)
+{
+  Napi::ThreadSafeFunction tsfn =
+      Napi::ThreadSafeFunction::New(env, cb, "route", 0, 1);
+  RouteTask* raw = task.release();
+  const bool queued = glRoutePool->submit(lane, [tsfn, raw](bool shutdown) {
+    if (shutdown)
+      raw->err = "route pool shutting down";  // still queued at teardown
+    else
+      raw->Execute();
+    if (tsfn.BlockingCall(raw, Deliver) != napi_ok)
+      delete raw;  // env torn down before the result could be delivered
+    tsfn.Release();
+  });
+  if (!queued)
+  {
+    raw->err = "route queue full";
+    tsfn.NonBlockingCall(raw, Deliver);
+    tsfn.Release();
+  }
+}
+
+void RouteTask::Deliver(Napi::Env env, Napi::Function callback,
+                        RouteTask* task)
+{
+  std::unique_ptr<RouteTask> owned(task);
+  if (env == nullptr || callback.IsEmpty()) return;  // env shutting down
+  owned->env = env;
+  owned->callback = callback;
+  try
+  {
+    owned->OnOK();
+  } catch (const Napi::Error& e)
+  {
+    e.ThrowAsJavaScriptException();  // as from an AsyncWorker callback
+  }
+}
+
+// threads option of findPaths/computeMatrix. Their extra threads are not
+// pool threads, so they are capped at the pool's bulk share.
+static unsigned parseThreads(const Napi::Object& obj)
+{
+  if (!obj.Has("threads") || !obj.Get("threads").IsNumber()) return 0;
+  const uint32_t requested =
+      obj.Get("threads").As<Napi::Number>().Uint32Value();
+  return static_cast<unsigned>(
+      std::min<std::size_t>(requested, glRoutePool->bulkShare()));
+}
+
+// "interactive" (navigation, reroutes) or "bulk" (planning, batches)
+static RoutePool::Lane parsePriority(const Napi::Object& obj,
+                                     RoutePool::Lane lane)
+{
+  if (obj.Has("priority") && obj.Get("priority").IsString())
+  {
+    const std::string priority =
+        obj.Get("priority").As<Napi::String>().Utf8Value();
+    if (priority == "interactive")
+      lane = RoutePool::Lane::Interactive;
+    else if (priority == "bulk")
+      lane = RoutePool::Lane::Bulk;
+    else
+      throw std::runtime_error("priority must be interactive or bulk");
+  }
+  return lane;
+}
+
+// Output geometry of findPath / findAlternatives routes
+struct GeometryOptions
+{
+  SimplifyOptions simplify;
+  int polylinePrecision{0};  // 5 or 6: encoded string instead of coords
+  bool fullPath{false};      // also return the unsimplified node path
+};
+
+static GeometryOptions parseGeometryOptions(const Napi::Object& obj)
+{
+  GeometryOptions geometry;
+  if (obj.Has("simplify") && obj.Get("simplify").IsString())
+  {
+    const std::string method =
+        obj.Get("simplify").As<Napi::String>().Utf8Value();
+    if (method == "douglas-peucker")
+      geometry.simplify.method = SimplifyMethod::DouglasPeucker;
+    else if (method == "visvalingam")
+      geometry.simplify.method = SimplifyMethod::Visvalingam;
+    else if (method != "none")
+      throw std::runtime_error(
+          "simplify must be none, douglas-peucker or visvalingam");
+  }
+  if (obj.Has("toleranceM") && obj.Get("toleranceM").IsNumber())
+  {
+    geometry.simplify.toleranceM =
+        obj.Get("toleranceM").As<Napi::Number>().DoubleValue();
+    if (!(geometry.simplify.toleranceM >= 0.0))
+      throw std::runtime_error("toleranceM must be >= 0");
+  }
+  if (obj.Has("polyline") && obj.Get("polyline").IsNumber())
+  {
+    geometry.polylinePrecision =
+        obj.Get("polyline").As<Napi::Number>().Int32Value();
+    if (geometry.polylinePrecision != 5 && geometry.polylinePrecision != 6)
+      throw std::runtime_error("polyline must be 5 or 6");
+  }
+  if (obj.Has("fullPath") && obj.Get("fullPath").IsBoolean())
+    geometry.fullPath = obj.Get("fullPath").As<Napi::Boolean>().Value();
+  return geometry;
+}
+
+// findPath ends given as points: snapped to edges on the pool thread
+struct PointEnds
+{
+  bool enabled{false};
+  double sourceLat{0.0}, sourceLon{0.0};
+  double targetLat{0.0}, targetLon{0.0};
+  SnapOptions snap;
+};
+
+static PointEnds parsePointEnds(const Napi::Object& obj)
+{
+  PointEnds ends;
+  auto point = [&](const char* key, double& lat, double& lon) {
+    if (!obj.Has(key) || !obj.Get(key).IsObject()) return false;
+    const Napi::Object value = obj.Get(key).As<Napi::Object>();
+    if (!value.Get("lat").IsNumber() || !value.Get("lon").IsNumber())
+      throw std::runtime_error(std::string(key) + " must be { lat, lon }");
+    lat = value.Get("lat").As<Napi::Number>().DoubleValue();
+    lon = value.Get("lon").As<Napi::Number>().DoubleValue();
+    if (!std::isfinite(lat) || !std::isfinite(lon))
+      throw std::runtime_error(std::string(key) + " must be finite");
+    return true;
+  };
+  const bool hasSource = point("sourcePoint", ends.sourceLat, ends.sourceLon);
+  const bool hasTarget = point("targetPoint", ends.targetLat, ends.targetLon);
+  if (hasSource != hasTarget)
+    throw std::runtime_error("sourcePoint and targetPoint go together");
+  ends.enabled = hasSource;
+  if (obj.Has("snapRadiusM") && obj.Get("snapRadiusM").IsNumber())
+  {
+    ends.snap.radiusM = obj.Get("snapRadiusM").As<Napi::Number>().DoubleValue();
+    if (!(ends.snap.radiusM > 0.0))
+      throw std::runtime_error("snapRadiusM must be > 0");
+  }
+  return ends;
+}
+
+static std::vector<EdgePoint> snapPoint(double lat, double lon,
+                                        const SnapOptions& options)
+{
+  std::vector<EdgePoint> points;
+  for (const EdgeSnap& snap :
+       glEdgeSnap.nearest(glNodes, glEdges, lat, lon, options))
+    points.push_back(EdgePoint{snap.edgeIdx, snap.offset});
+  return points;
+}
+
+// path, modes and coords (or polyline) of one route. Filled on the pool
+// thread so the JS thread only adopts the buffers.
+struct RouteBuffers
+{
+  std::vector<uint32_t> path;
+  std::vector<uint8_t> modes;  // 1=BIKE_PREFERRED, 2=BIKE_NON_PREFERRED, 4=FOOT
+  std::vector<float> coords;   // lat, lon per path entry
+  std::string polyline;        // set instead of coords if requested
+  bool encoded{false};
+  std::vector<uint32_t> fullPath;  // simplified routes, if requested
+  bool hasFullPath{false};
+};
+
+// Line entry of a snapped route end (a point inside an edge, not a node).
+// Simplified along with the nodes, then taken out of path: the ends are
+// reported by sourceSnap/targetSnap.
+static constexpr uint32_t kSnappedPoint = UINT32_MAX;
+
+static RouteBuffers routeBuffers(const AStarResult& route,
+                                 const GeometryOptions& geometry)
+{
+  // The whole line: nodes, plus the snapped end points of aStarSnapped
+  std::vector<uint32_t> path;
+  std::vector<uint8_t> modes;
+  std::vector<float> coords, xyM;  // xyM only to simplify
+  const bool simplify = geometry.simplify.method != SimplifyMethod::None;
+  const std::size_t points = route.pathNodes.size() + 2;
+  path.reserve(points);
+  modes.reserve(points);
+  coords.reserve(points * 2);
+  auto addPoint = [&](uint32_t idx, double lat, double lon, double x,
+                      double y) {
+    path.push_back(idx);
+    coords.push_back(static_cast<float>(lat));
+    coords.push_back(static_cast<float>(lon));
+    if (!simplify) return;
+    xyM.push_back(static_cast<float>(x));
+    xyM.push_back(static_cast<float>(y));
+  };
+  auto addEdgePoint = [&](const PartialStep& step, double offset) {
+    const EdgePosition at =
+        edgePosition(glNodes, edgeTail(glEdges, step.edgeIdx),
+                     glEdges.neighbors[step.edgeIdx], offset);
+    addPoint(kSnappedPoint, at.lat, at.lon, at.xM, at.yM);
+  };
+
+  const PartialStep& first = route.sourceStep;
+  const PartialStep& last = route.targetStep;
+  if (first.present())
+  {
+    addEdgePoint(first, first.fromOffset);
+    modes.push_back(first.mode);
+  }
+  for (uint32_t idx : route.pathNodes)
+    addPoint(idx, glNodes.lat_f32[idx], glNodes.lon_f32[idx], glNodes.xM[idx],
+             glNodes.yM[idx]);
+  modes.insert(modes.end(), route.pathModes.begin(), route.pathModes.end());
+  if (last.present())
+  {
+    modes.push_back(last.mode);
+    addEdgePoint(last, last.toOffset);
+  }
+  else if (first.present() && route.pathNodes.empty())
+  {
+    addEdgePoint(first, first.toOffset);  // both ends on one edge
+  }
+
+  RouteBuffers buffers;
+  if (!simplify)
+  {
+    buffers.path = std::move(path);
+    buffers.modes = std::move(modes);
+    buffers.coords = std::move(coords);
+  }
+  else
+  {
+    // Mode changes are kept, so each kept step has one mode throughout
+    const std::vector<uint32_t> kept =
+        simplifyPath(xyM, modes, geometry.simplify);
+    buffers.path.resize(kept.size());
+    buffers.modes.resize(kept.empty() ? 0 : kept.size() - 1);
+    buffers.coords.resize(kept.size() * 2);
+    for (std::size_t j{0}; j < kept.size(); ++j)
+    {
+      buffers.path[j] = path[kept[j]];
+      buffers.coords[2 * j] = coords[2 * kept[j]];
+      buffers.coords[2 * j + 1] = coords[2 * kept[j] + 1];
+      if (j + 1 < kept.size()) buffers.modes[j] = modes[kept[j]];
+    }
+    if (geometry.fullPath)
+    {
+      buffers.fullPath = std::move(path);
+      buffers.hasFullPath = true;
+    }
+  }
+
+  // Snapped ends and their partial steps leave the node line; they are
+  // reported as sourceSnap/targetSnap
+  const bool sourceEnd = first.present();
+  const bool targetEnd =
+      last.present() || (first.present() && route.pathNodes.empty());
+  if (sourceEnd && !buffers.path.empty())
+  {
+    buffers.path.erase(buffers.path.begin());
+    buffers.coords.erase(buffers.coords.begin(), buffers.coords.begin() + 2);
+    if (!buffers.modes.empty()) buffers.modes.erase(buffers.modes.begin());
+  }
+  if (targetEnd && !buffers.path.empty())
+  {
+    buffers.path.pop_back();
+    buffers.coords.resize(buffers.coords.size() - 2);
+    if (!buffers.modes.empty()) buffers.modes.pop_back();
+  }
+  if (buffers.hasFullPath)
+  {
+    std::vector<uint32_t>& full = buffers.fullPath;
+    if (sourceEnd && !full.empty()) full.erase(full.begin());
+    if (targetEnd && !full.empty()) full.pop_back();
+  }
+
+  if (geometry.polylinePrecision != 0)
+  {
+    buffers.polyline =
+        encodePolyline(buffers.coords, geometry.polylinePrecision);
+    buffers.encoded = true;
+    buffers.coords = {};
+  }
+  return buffers;
+}
+
+// Typed array over the vector's buffer; the vector is freed by the GC.
+template <class T>
+static Napi::TypedArrayOf<T> adoptTypedArray(Napi::Env env,
+                                             std::vector<T>&& values)
+{
+  if (values.empty()) return Napi::TypedArrayOf<T>::New(env, 0);
+
+  auto* owned = new std::vector<T>(std::move(values));
+  Napi::ArrayBuffer buffer = Napi::ArrayBuffer::New(
+      env, owned->data(), owned->size() * sizeof(T),
+      [](Napi::Env, void*, std::vector<T>* hint) { delete hint; }, owned);
+  return Napi::TypedArrayOf<T>::New(env, owned->size(), buffer, 0);
+}
+
+// One route as findPath returns it: typed arrays adopted from buffers,
+// aggregates from route
+static Napi::Object routeToObject(Napi::Env env, const AStarResult& route,
+                                  RouteBuffers&& buffers)
+{
+  Napi::Object out = Napi::Object::New(env);
+  out.Set("path", adoptTypedArray(env, std::move(buffers.path)));
+  out.Set("modes", adoptTypedArray(env, std::move(buffers.modes)));
+  if (buffers.encoded)
+    out.Set("polyline", Napi::String::New(env, buffers.polyline));
+  else
+    out.Set("coords", adoptTypedArray(env, std::move(buffers.coords)));
+  if (buffers.hasFullPath)
+    out.Set("fullPath", adoptTypedArray(env, std::move(buffers.fullPath)));
+
+  // Snapped ends: where on which edge the route starts and ends, and the
+  // mode of the partial step between that point and the node line (the
+  // whole route if both ends are on one edge and path is empty)
+  auto snapObject = [&](const PartialStep& step, double offset) {
+    const EdgePosition at =
+        edgePosition(glNodes, edgeTail(glEdges, step.edgeIdx),
+                     glEdges.neighbors[step.edgeIdx], offset);
+    Napi::Object snap = Napi::Object::New(env);
+    snap.Set("edgeIdx", Napi::Number::New(env, step.edgeIdx));
+    snap.Set("offset", Napi::Number::New(env, offset));
+    snap.Set("lat", Napi::Number::New(env, static_cast<float>(at.lat)));
+    snap.Set("lon", Napi::Number::New(env, static_cast<float>(at.lon)));
+    snap.Set("mode", Napi::Number::New(env, step.mode));
+    return snap;
+  };
+  const PartialStep& first = route.sourceStep;
+  const PartialStep& last = route.targetStep;
+  if (first.present())
+    out.Set("sourceSnap", snapObject(first, first.fromOffset));
+  if (last.present())
+    out.Set("targetSnap", snapObject(last, last.toOffset));
+  else if (first.present() && route.pathNodes.empty())
+    out.Set("targetSnap", snapObject(first, first.toOffset));
+
+  out.Set("distanceM", Napi::Number::New(env, route.distanceM));
+  out.Set("durationS", Napi::Number::New(env, route.durationS));
+
+  // newStuff
+  out.Set("distanceBikePreferred",
+          Napi::Number::New(env, route.distanceBikePreferred));
+  out.Set("distanceBikeNonPreferred",
+          Napi::Number::New(env, route.distanceBikeNonPreferred));
+  out.Set("distanceWalk", Napi::Number::New(env, route.distanceWalk));
+
+  return out;
+}
+
+class FindPathWorker : public RouteTask
 {
  public:
-  FindPathWorker(const Napi::Function& cb, uint32_t sourceIdxIn,
-                 uint32_t targetIdxIn, AStarParams params)
-      : Napi::AsyncWorker(cb),
-        sourceIdx(sourceIdxIn),
+  FindPathWorker(uint32_t sourceIdxIn, uint32_t targetIdxIn,
+                 AStarParams params, SearchOptions options, bool useCchIn,
+                 GeometryOptions geometryIn, PointEnds endsIn,
+                 std::shared_ptr<std::atomic<bool>> cancelledIn)
+      : sourceIdx(sourceIdxIn),
         targetIdx(targetIdxIn),
-        params(std::move(params))
-  {}
+        params(std::move(params)),
+        options(options),
+        useCch(useCchIn),
+        geometry(geometryIn),
+        ends(endsIn),
+        cancelled(std::move(cancelledIn))
+  {
+    this->options.limits.cancelled = cancelled.get();
+  }
 
   void Execute() override
   {
     try
     {
-      res = aStarTwoLayer(glEdges, glNodes, sourceIdx, targetIdx, params);
-      if (!res.success) err = "no route";
+      // Points that snap: search from and to the edges, cached by the
+      // snapped edge points. A point with no edge within reach falls back
+      // to the node query.
+      std::vector<EdgePoint> sources, targets;
+      if (ends.enabled)
+      {
+        sources = snapPoint(ends.sourceLat, ends.sourceLon, ends.snap);
+        targets = snapPoint(ends.targetLat, ends.targetLon, ends.snap);
+      }
+      const bool snapped = !sources.empty() && !targets.empty();
+      res = snapped ? glRouteCache.find(sources, targets, params)
+                    : glRouteCache.find(sourceIdx, targetIdx, params);
+      cacheHit = res != nullptr;
+      if (!res)
+      {
+        // Route pool threads are long-lived: the thread-local workspace is
+        // allocated on a thread's first query and reused afterwards.
+        AStarResult route;
+        // Cancelled or expired while queued: skip the search
+        const bool stopped = options.limits.reached(0, route.status);
+        if (!stopped && useCch)
+        {
+          // The first query of a profile pays for its customization
+          const auto metric = glCchMetrics.get(glCch, glEdges, params);
+          route = snapped ? cchSnappedQuery(glCch, *metric, glEdges, sources,
+                                            targets, params,
+                                            CchScratch::forThisThread())
+                          : cchQuery(glCch, *metric, glEdges, sourceIdx,
+                                     targetIdx, params,
+                                     CchScratch::forThisThread());
+        }
+        else if (!stopped && snapped)
+        {
+          route = aStarSnapped(glEdges, glNodes, sources, targets, params,
+                               SearchWorkspace::forThisThread(), options);
+        }
+        else if (!stopped)
+        {
+          route = aStarTwoLayer(glEdges, glNodes, sourceIdx, targetIdx, params,
+                                SearchWorkspace::forThisThread(), options);
+        }
+        // A stopped search says nothing about the pair: not cached
+        const bool settled = route.status == SearchStatus::Found ||
+                             route.status == SearchStatus::NoRoute;
+        if (settled && snapped)
+          glRouteCache.insert(sources, targets, params, route);
+        else if (settled)
+          glRouteCache.insert(sourceIdx, targetIdx, params, route);
+        res = std::make_shared<const AStarResult>(std::move(route));
+      }
+      if (res->success)
+        buffers = routeBuffers(*res, geometry);
+      else
+        err = searchStatusError(res->status);
     } catch (const std::exception& e)
     {
       err = e.what();
@@ -325,46 +727,335 @@ class FindPathWorker : public Napi::AsyncWorker
   void OnOK() override
   {
     Napi::Env env = Env();
-    if (!err.empty())
+    if (!err.empty() && !res)
     {
       Callback().Call({Napi::String::New(env, err), env.Null()});
       return;
     }
+    if (!err.empty())
+    {
+      // The search ran but stopped: say how far it got
+      Napi::Object info = Napi::Object::New(env);
+      info.Set("settledStates", Napi::Number::New(env, res->settledStates));
+      if constexpr (kSearchStats)
+        if (res->stats.collected) info.Set("stats", statsToObject(env));
+      Callback().Call({Napi::String::New(env, err), info});
+      return;
+    }
+    Napi::Object out = routeToObject(env, *res, std::move(buffers));
+    out.Set("settledStates", Napi::Number::New(env, res->settledStates));
+    if constexpr (kSearchStats)
+      if (res->stats.collected) out.Set("stats", statsToObject(env));
+    Callback().Call({env.Null(), out});
+  }
+
+ private:
+  // Counters of the search that produced res (an earlier one on a cache hit)
+  Napi::Object statsToObject(Napi::Env env) const
+  {
+    const SearchStats& stats = res->stats;
     Napi::Object out = Napi::Object::New(env);
-    Napi::Array path = Napi::Array::New(env, res.pathNodes.size());
-    for (uint32_t i{0}; i < res.pathNodes.size(); ++i)
+    out.Set("cacheHit", Napi::Boolean::New(env, cacheHit));
+    out.Set("settledRide", Napi::Number::New(env, stats.settledRide));
+    out.Set("settledWalk", Napi::Number::New(env, stats.settledWalk));
+    out.Set("pushes", Napi::Number::New(env, stats.pushes));
+    out.Set("stalePops", Napi::Number::New(env, stats.stalePops));
+    out.Set("maxQueueSize", Napi::Number::New(env, stats.maxQueueSize));
+    out.Set("edgesScanned", Napi::Number::New(env, stats.edgesScanned));
+    out.Set("edgesFiltered", Napi::Number::New(env, stats.edgesFiltered));
+    out.Set("switchesRelaxed", Napi::Number::New(env, stats.switchesRelaxed));
+    out.Set("settledForward", Napi::Number::New(env, stats.settledForward));
+    out.Set("settledBackward", Napi::Number::New(env, stats.settledBackward));
+    out.Set("setupMs", Napi::Number::New(env, stats.setupMs));
+    out.Set("searchMs", Napi::Number::New(env, stats.searchMs));
+    out.Set("reconstructMs", Napi::Number::New(env, stats.reconstructMs));
+    return out;
+  }
+
+  uint32_t sourceIdx;
+  uint32_t targetIdx;
+  AStarParams params;
+  SearchOptions options;
+  bool useCch;
+  GeometryOptions geometry;
+  PointEnds ends;
+  // Shared with the handle findPath returns; outlives the search
+  std::shared_ptr<std::atomic<bool>> cancelled;
+  std::shared_ptr<const AStarResult> res;  // may be shared with the cache
+  RouteBuffers buffers;
+  bool cacheHit = false;
+};
+
+class FindAlternativesWorker : public RouteTask
+{
+ public:
+  FindAlternativesWorker(uint32_t sourceIdxIn, uint32_t targetIdxIn,
+                         AStarParams params, SearchOptions options,
+                         AlternativeOptions alternativesIn,
+                         GeometryOptions geometryIn)
+      : sourceIdx(sourceIdxIn),
+        targetIdx(targetIdxIn),
+        params(std::move(params)),
+        options(options),
+        alternatives(alternativesIn),
+        geometry(geometryIn)
+  {}
+
+  void Execute() override
+  {
+    try
     {
-      path.Set(i, Napi::Number::New(env, res.pathNodes[i]));
+      routes = alternativeRoutes(glEdges, sourceIdx, targetIdx, params,
+                                 SearchWorkspace::forThisThread(), options,
+                                 alternatives);
+      if (routes.empty()) err = "no route";
+      for (const AStarResult& route : routes)
+        buffers.push_back(routeBuffers(route, geometry));
+    } catch (const std::exception& e)
+    {
+      err = e.what();
     }
-    out.Set("path", path);
+  }
 
-    Napi::Array modes = Napi::Array::New(env, res.pathModes.size());
-    for (uint32_t i{0}; i < res.pathModes.size(); ++i)
+  void OnOK() override
+  {
+    Napi::Env env = Env();
+    if (!err.empty())
     {
-      // 1=BIKE_PREFERRED, 2=BIKE_NON_PREFERRED, 4=FOOT
-      modes.Set(i, Napi::Number::New(env, res.pathModes[i]));
+      Callback().Call({Napi::String::New(env, err), env.Null()});
+      return;
     }
-    out.Set("modes", modes);
+    Napi::Array list = Napi::Array::New(env, routes.size());
+    for (uint32_t i{0}; i < routes.size(); ++i)
+      list.Set(i, routeToObject(env, routes[i], std::move(buffers[i])));
+
+    Napi::Object out = Napi::Object::New(env);
+    out.Set("routes", list);
+    Callback().Call({env.Null(), out});
+  }
+
+ private:
+  uint32_t sourceIdx;
+  uint32_t targetIdx;
+  AStarParams params;
+  SearchOptions options;
+  AlternativeOptions alternatives;
+  GeometryOptions geometry;
+  std::vector<AStarResult> routes;
+  std::vector<RouteBuffers> buffers;
+};
+
+// Node indices from a JS number array or a Uint32Array
+static std::vector<uint32_t> parseIndexList(const Napi::Value& value,
+                                            const char* name)
+{
+  std::vector<uint32_t> indices;
+  if (value.IsTypedArray() &&
+      value.As<Napi::TypedArray>().TypedArrayType() == napi_uint32_array)
+  {
+    Napi::Uint32Array arr = value.As<Napi::Uint32Array>();
+    indices.assign(arr.Data(), arr.Data() + arr.ElementLength());
+    return indices;
+  }
+  if (!value.IsArray())
+    throw std::runtime_error(std::string(name) +
+                             " must be an array or Uint32Array");
+
+  Napi::Array arr = value.As<Napi::Array>();
+  indices.resize(arr.Length());
+  for (uint32_t i{0}; i < arr.Length(); ++i)
+  {
+    Napi::Value e = arr.Get(i);
+    if (!e.IsNumber())
+      throw std::runtime_error(std::string(name) + " must hold node indices");
+    indices[i] = e.As<Napi::Number>().Uint32Value();
+  }
+  return indices;
+}
+
+class FindPathsWorker : public RouteTask
+{
+ public:
+  FindPathsWorker(std::vector<BatchProfile> profiles, std::vector<bool> useCch,
+                  std::vector<BatchQuery> queries, unsigned numThreadsIn)
+      : profiles(std::move(profiles)),
+        useCch(std::move(useCch)),
+        queries(std::move(queries)),
+        numThreads(numThreadsIn)
+  {}
 
-    out.Set("distanceM", Napi::Number::New(env, res.distanceM));
-    out.Set("durationS", Napi::Number::New(env, res.durationS));
+  void Execute() override
+  {
+    try
+    {
+      // Customization (first use of a profile) runs here, off the JS thread
+      for (std::size_t i{0}; i < profiles.size(); ++i)
+      {
+        if (useCch[i])
+          profiles[i].cchMetric =
+              glCchMetrics.get(glCch, glEdges, profiles[i].params);
+      }
+      batch = findPathsBatch(glEdges, glNodes, &glCch, profiles, queries,
+                             numThreads);
+    } catch (const std::exception& e)
+    {
+      err = e.what();
+    }
+  }
 
-    // newStuff
+  void OnOK() override
+  {
+    Napi::Env env = Env();
+    if (!err.empty())
+    {
+      Callback().Call({Napi::String::New(env, err), env.Null()});
+      return;
+    }
+    Napi::Object out = Napi::Object::New(env);
+    out.Set("pathOffsets", adoptTypedArray(env, std::move(batch.pathOffsets)));
+    out.Set("path", adoptTypedArray(env, std::move(batch.path)));
+    out.Set("modes", adoptTypedArray(env, std::move(batch.modes)));
+    out.Set("success", adoptTypedArray(env, std::move(batch.success)));
+    out.Set("durations", adoptTypedArray(env, std::move(batch.durationsS)));
+    out.Set("distances", adoptTypedArray(env, std::move(batch.distancesM)));
     out.Set("distanceBikePreferred",
-            Napi::Number::New(env, res.distanceBikePreferred));
+            adoptTypedArray(env, std::move(batch.distancesBikePreferred)));
     out.Set("distanceBikeNonPreferred",
-            Napi::Number::New(env, res.distanceBikeNonPreferred));
-    out.Set("distanceWalk", Napi::Number::New(env, res.distanceWalk));
+            adoptTypedArray(env, std::move(batch.distancesBikeNonPreferred)));
+    out.Set("distanceWalk",
+            adoptTypedArray(env, std::move(batch.distancesWalk)));
 
     Callback().Call({env.Null(), out});
   }
 
  private:
-  uint32_t sourceIdx;
-  uint32_t targetIdx;
+  std::vector<BatchProfile> profiles;
+  std::vector<bool> useCch;
+  std::vector<BatchQuery> queries;
+  unsigned numThreads;
+  RouteBatch batch;
+};
+
+class ComputeMatrixWorker : public RouteTask
+{
+ public:
+  ComputeMatrixWorker(std::vector<uint32_t> sources,
+                      std::vector<uint32_t> targets, AStarParams params,
+                      SearchOptions options, unsigned numThreadsIn)
+      : sources(std::move(sources)),
+        targets(std::move(targets)),
+        params(std::move(params)),
+        options(options),
+        numThreads(numThreadsIn)
+  {}
+
+  void Execute() override
+  {
+    try
+    {
+      matrix = computeTravelMatrix(glEdges, sources, targets, params, options,
+                                   numThreads);
+    } catch (const std::exception& e)
+    {
+      err = e.what();
+    }
+  }
+
+  void OnOK() override
+  {
+    Napi::Env env = Env();
+    if (!err.empty())
+    {
+      Callback().Call({Napi::String::New(env, err), env.Null()});
+      return;
+    }
+    Napi::Object out = Napi::Object::New(env);
+    out.Set("numSources", Napi::Number::New(env, matrix.numSources));
+    out.Set("numTargets", Napi::Number::New(env, matrix.numTargets));
+    out.Set("durations", adoptTypedArray(env, std::move(matrix.durationsS)));
+    out.Set("distances", adoptTypedArray(env, std::move(matrix.distancesM)));
+
+    Callback().Call({env.Null(), out});
+  }
+
+ private:
+  std::vector<uint32_t> sources;
+  std::vector<uint32_t> targets;
   AStarParams params;
-  AStarResult res;
-  std::string err;
+  SearchOptions options;
+  unsigned numThreads;
+  TravelMatrix matrix;
+};
+
+class ComputeIsochroneWorker : public RouteTask
+{
+ public:
+  ComputeIsochroneWorker(uint32_t originIdxIn, std::vector<double> budgetsS,
+                         AStarParams params, SearchOptions options,
+                         double cellSizeMIn)
+      : originIdx(originIdxIn),
+        budgetsS(std::move(budgetsS)),
+        params(std::move(params)),
+        options(options),
+        cellSizeM(cellSizeMIn)
+  {}
+
+  void Execute() override
+  {
+    try
+    {
+      iso = computeIsochrone(glEdges, glNodes, originIdx, budgetsS, params,
+                             SearchWorkspace::forThisThread(), options,
+                             cellSizeM);
+    } catch (const std::exception& e)
+    {
+      err = e.what();
+    }
+  }
+
+  void OnOK() override
+  {
+    Napi::Env env = Env();
+    if (!err.empty())
+    {
+      Callback().Call({Napi::String::New(env, err), env.Null()});
+      return;
+    }
+    Napi::Object out = Napi::Object::New(env);
+    out.Set("nodes", adoptTypedArray(env, std::move(iso.nodes)));
+    out.Set("durations", adoptTypedArray(env, std::move(iso.durationsS)));
+
+    Napi::Array bands = Napi::Array::New(env, iso.bands.size());
+    for (uint32_t i{0}; i < iso.bands.size(); ++i)
+    {
+      IsochroneBand& band = iso.bands[i];
+      Napi::Array polygons = Napi::Array::New(env, band.polygons.size());
+      for (uint32_t k{0}; k < band.polygons.size(); ++k)
+      {
+        std::vector<IsochroneRing>& rings = band.polygons[k].rings;
+        Napi::Array polygon = Napi::Array::New(env, rings.size());
+        for (uint32_t r{0}; r < rings.size(); ++r)
+          polygon.Set(r, adoptTypedArray(env, std::move(rings[r])));
+        polygons.Set(k, polygon);
+      }
+
+      Napi::Object entry = Napi::Object::New(env);
+      entry.Set("budgetS", Napi::Number::New(env, band.budgetS));
+      entry.Set("polygons", polygons);
+      bands.Set(i, entry);
+    }
+    out.Set("bands", bands);
+
+    Callback().Call({env.Null(), out});
+  }
+
+ private:
+  uint32_t originIdx;
+  std::vector<double> budgetsS;
+  AStarParams params;
+  SearchOptions options;
+  double cellSizeM;
+  Isochrone iso;
 };
 
 static Napi::Value GetNodeIdByIdx(const Napi::CallbackInfo& info)
@@ -418,6 +1109,53 @@ static Napi::Value GetNodeIdByIdx(const Napi::CallbackInfo& info)
   // return Napi::Number::New(env, static_cast<double>(id));
 }
 
+// JS: snapToEdges(lat, lon, options?) -> [{ edgeIdx, offset, lat, lon,
+//   distanceM, tailIdx, headIdx }, ...], nearest first (empty if none)
+// options = { radiusM?: 100, slackM?: 5, maxCandidates?: 8 }
+// The candidates findPath seeds for a sourcePoint / targetPoint.
+static Napi::Value SnapToEdges(const Napi::CallbackInfo& info)
+{
+  Napi::Env env = info.Env();
+  if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsNumber())
+  {
+    Napi::TypeError::New(env, "usage: snapToEdges(lat, lon, options?)")
+        .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  SnapOptions options;
+  if (info.Length() > 2 && info[2].IsObject())
+  {
+    const Napi::Object opt = info[2].As<Napi::Object>();
+    if (opt.Get("radiusM").IsNumber())
+      options.radiusM = opt.Get("radiusM").As<Napi::Number>().DoubleValue();
+    if (opt.Get("slackM").IsNumber())
+      options.slackM = opt.Get("slackM").As<Napi::Number>().DoubleValue();
+    if (opt.Get("maxCandidates").IsNumber())
+      options.maxCandidates =
+          opt.Get("maxCandidates").As<Napi::Number>().Uint32Value();
+  }
+
+  const std::vector<EdgeSnap> snaps = glEdgeSnap.nearest(
+      glNodes, glEdges, info[0].As<Napi::Number>().DoubleValue(),
+      info[1].As<Napi::Number>().DoubleValue(), options);
+  Napi::Array out = Napi::Array::New(env, snaps.size());
+  for (uint32_t i{0}; i < snaps.size(); ++i)
+  {
+    const EdgeSnap& snap = snaps[i];
+    Napi::Object item = Napi::Object::New(env);
+    item.Set("edgeIdx", Napi::Number::New(env, snap.edgeIdx));
+    item.Set("offset", Napi::Number::New(env, snap.offset));
+    item.Set("lat", Napi::Number::New(env, snap.lat));
+    item.Set("lon", Napi::Number::New(env, snap.lon));
+    item.Set("distanceM", Napi::Number::New(env, snap.distanceM));
+    item.Set("tailIdx", Napi::Number::New(env, snap.tail));
+    item.Set("headIdx", Napi::Number::New(env, snap.head));
+    out.Set(i, item);
+  }
+  return out;
+}
+
 static Napi::Value GetGraphInfo(const Napi::CallbackInfo& info)
 {
   Napi::Env env = info.Env();
@@ -432,6 +1170,38 @@ static Napi::Value GetGraphInfo(const Napi::CallbackInfo& info)
   out.Set("numEdges", Napi::Number::New(env, glEdges.numEdges));
   out.Set("nodesPath", Napi::String::New(env, glNodesPath));
   out.Set("edgesPath", Napi::String::New(env, glEdgesPath));
+  out.Set("packedEdges", Napi::Boolean::New(env, glEdges.packed != nullptr));
+  out.Set("numLandmarks", Napi::Number::New(env, glLandmarks.numLandmarks));
+  out.Set("landmarksPath", Napi::String::New(env, glLandmarksPath));
+  out.Set("cchLoaded", Napi::Boolean::New(env, glCch.numStates > 0));
+  out.Set("cchArcs", Napi::Number::New(env, glCch.numArcs));
+  out.Set("cchPath", Napi::String::New(env, glCchPath));
+
+  const RouteCache::Stats cache = glRouteCache.stats();
+  Napi::Object routeCache = Napi::Object::New(env);
+  routeCache.Set("capacity", Napi::Number::New(env, cache.capacity));
+  routeCache.Set("size", Napi::Number::New(env, cache.size));
+  routeCache.Set("hits", Napi::Number::New(env, cache.hits));
+  routeCache.Set("misses", Napi::Number::New(env, cache.misses));
+  routeCache.Set("evictions", Napi::Number::New(env, cache.evictions));
+  out.Set("routeCache", routeCache);
+
+  if (glRoutePool)
+  {
+    const RoutePool::Stats pool = glRoutePool->stats();
+    Napi::Object routePool = Napi::Object::New(env);
+    routePool.Set("threads", Napi::Number::New(env, pool.threads));
+    routePool.Set("maxQueued", Napi::Number::New(env, pool.maxQueued));
+    routePool.Set("queuedInteractive",
+                  Napi::Number::New(env, pool.queued[0]));
+    routePool.Set("queuedBulk", Napi::Number::New(env, pool.queued[1]));
+    routePool.Set("runningInteractive",
+                  Napi::Number::New(env, pool.running[0]));
+    routePool.Set("runningBulk", Napi::Number::New(env, pool.running[1]));
+    routePool.Set("completed", Napi::Number::New(env, pool.completed));
+    routePool.Set("rejected", Napi::Number::New(env, pool.rejected));
+    out.Set("routePool", routePool);
+  }
 
   return out;
 }
@@ -443,8 +1213,52 @@ static Napi::Value GetGraphInfo(const Napi::CallbackInfo& info)
 //   bikeSpeedMps?: number, walkSpeedMps?: number,
 //   rideToWalkPenaltyS?: number, walkToRidePenaltyS?: number,
 //   bikeSurfaceFactor?: number[], walkSurfaceFactor?: number[],
-//   surfacePenaltySPerKm?: number
+//   surfacePenaltySPerKm?: number,
+//   stateStorage?: "auto" | "dense" | "sparse", sparseMaxMeters?: number,
+//   queue?: "binary" | "dary4" | "radix",
+//   direction?: "forward" | "bidirectional",
+//   edgeLayout?: "auto" | "packed" | "soa",
+//   heuristic?: "landmarks" | "haversine"  (landmarks used if loaded),
+//   algorithm?: "cch" | "astar"  (cch used if loaded; the A* engine
+//               options above then do not apply),
+//   priority?: "interactive" | "bulk"  (routing pool lane; findPath,
+//              findAlternatives and computeIsochrone default to
+//              interactive, findPaths and computeMatrix to bulk),
+//   deadlineMs?: number  (from this call, queue wait included),
+//   maxSettledStates?: number  (A* search-space budget, 0 = none),
+//   simplify?: "none" | "douglas-peucker" | "visvalingam"  (mode changes
+//              are always kept),
+//   toleranceM?: number  (default 5; visvalingam drops triangles below
+//                toleranceM^2),
+//   polyline?: 5 | 6  (encoded polyline string instead of coords),
+//   fullPath?: boolean  (with simplify: the full node path as fullPath),
+//   sourcePoint?, targetPoint?: { lat, lon }  (both or neither: snapped to
+//               the nearest edges and routed from/to inside them with
+//               cchSnappedQuery, or aStarSnapped (forward A*) under
+//               algorithm astar; cached by the snapped edge points.
+//               sourceIdx/targetIdx are used if either point has no edge
+//               within snapRadiusM),
+//   snapRadiusM?: number  (default 100)
 // }
+// result = { path: Uint32Array, modes: Uint8Array (one per step),
+//            coords: Float32Array (lat, lon per path entry) or polyline:
+//            string, fullPath?: Uint32Array, distanceM, durationS, ...,
+//            sourceSnap?, targetSnap?: { edgeIdx, offset, lat, lon, mode } }
+// path, coords and modes cover graph nodes only. A snapped route starts at
+// sourceSnap, takes one sourceSnap.mode step to path[0], and ends with a
+// targetSnap.mode step from the last path entry to targetSnap (one step
+// between the two if path is empty).
+// Returns { cancel() }: stops the query if it has not finished. A stopped
+// query calls back with "search deadline exceeded", "search budget
+// exceeded" or "search cancelled" and { settledStates }; the CCH checks the
+// limits only before it starts (its queries take milliseconds).
+// Addons built with -DROUTE_SEARCH_STATS=1 add a stats object (A* counters
+// and phase times, see SearchStats; bidirectional queries sum both sides and
+// add settledForward / settledBackward) to results and stop reports of
+// A* searches. CCH queries collect none and carry no stats.
+// Results are cached per (sourceIdx, targetIdx, cost params); see the
+// routeCache counters in getGraphInfo(). When the lane's queue is full the
+// callback gets the error "route queue full" without a search being run.
 Napi::Value FindPath(const Napi::CallbackInfo& info)
 {
   Napi::Env env = info.Env();
@@ -469,9 +1283,20 @@ Napi::Value FindPath(const Napi::CallbackInfo& info)
   uint32_t targetIdx = opt.Get("targetIdx").As<Napi::Number>().Uint32Value();
 
   AStarParams params;
+  SearchOptions options;
+  bool useCch;
+  GeometryOptions geometry;
+  PointEnds ends;
+  RoutePool::Lane lane;
   try
   {
     params = parseParams(env, opt);
+    options = parseSearchOptions(opt);
+    options.limits = parseSearchLimits(opt);
+    useCch = parseUseCch(opt);
+    geometry = parseGeometryOptions(opt);
+    ends = parsePointEnds(opt);
+    lane = parsePriority(opt, RoutePool::Lane::Interactive);
   } catch (const std::exception& e)
   {
     Napi::TypeError::New(env, e.what()).ThrowAsJavaScriptException();
@@ -479,9 +1304,295 @@ Napi::Value FindPath(const Napi::CallbackInfo& info)
   }
   // rename
   auto cb = info[1].As<Napi::Function>();
-  auto* worker =
-      new FindPathWorker(cb, sourceIdx, targetIdx, std::move(params));
-  worker->Queue();
+  auto cancelled = std::make_shared<std::atomic<bool>>(false);
+  RouteTask::Queue(env, cb, lane,
+                   std::make_unique<FindPathWorker>(
+                       sourceIdx, targetIdx, std::move(params), options,
+                       useCch, geometry, ends, cancelled));
+
+  Napi::Object handle = Napi::Object::New(env);
+  handle.Set("cancel",
+             Napi::Function::New(env, [cancelled](const Napi::CallbackInfo&) {
+               cancelled->store(true, std::memory_order_relaxed);
+             }));
+  return handle;
+}
+
+// JS: findAlternatives(options, callback)
+// options = findPath options (algorithm excepted) plus
+//   maxRoutes?: number  (default 3, best route included),
+//   maxStretch?: number  (default 0.25: cost <= 1.25 * best),
+//   maxOverlap?: number  (default 0.6: share of length on earlier routes),
+//   localOptimality?: number  (default 0.25: share of the best cost that
+//                     must be optimal around the detour)
+// result = { routes: [findPath result, ...] }, best route first
+Napi::Value FindAlternatives(const Napi::CallbackInfo& info)
+{
+  Napi::Env env = info.Env();
+  if (info.Length() < 2 || !info[0].IsObject() || !info[1].IsFunction())
+  {
+    Napi::TypeError::New(env, "usage: findAlternatives(options, callback)")
+        .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  Napi::Object opt = info[0].As<Napi::Object>();
+  if (!opt.Has("sourceIdx") || !opt.Has("targetIdx") ||
+      !opt.Get("sourceIdx").IsNumber() || !opt.Get("targetIdx").IsNumber())
+  {
+    Napi::TypeError::New(env,
+                         "options must include numeric sourceIdx and targetIdx")
+        .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  const uint32_t sourceIdx =
+      opt.Get("sourceIdx").As<Napi::Number>().Uint32Value();
+  const uint32_t targetIdx =
+      opt.Get("targetIdx").As<Napi::Number>().Uint32Value();
+
+  AStarParams params;
+  SearchOptions options;
+  AlternativeOptions alternatives;
+  GeometryOptions geometry;
+  RoutePool::Lane lane;
+  try
+  {
+    params = parseParams(env, opt);
+    options = parseSearchOptions(opt);
+    geometry = parseGeometryOptions(opt);
+    lane = parsePriority(opt, RoutePool::Lane::Interactive);
+
+    auto getNum = [&](const char* k, double& out) {
+      if (opt.Has(k) && opt.Get(k).IsNumber())
+        out = opt.Get(k).As<Napi::Number>().DoubleValue();
+    };
+    if (opt.Has("maxRoutes") && opt.Get("maxRoutes").IsNumber())
+      alternatives.maxRoutes =
+          opt.Get("maxRoutes").As<Napi::Number>().Uint32Value();
+    getNum("maxStretch", alternatives.maxStretch);
+    getNum("maxOverlap", alternatives.maxOverlap);
+    getNum("localOptimality", alternatives.localOptimality);
+  } catch (const std::exception& e)
+  {
+    Napi::TypeError::New(env, e.what()).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  auto cb = info[1].As<Napi::Function>();
+  RouteTask::Queue(env, cb, lane,
+                   std::make_unique<FindAlternativesWorker>(
+                       sourceIdx, targetIdx, std::move(params), options,
+                       alternatives, geometry));
+  return env.Undefined();
+}
+
+// JS: findPaths(queries, callback)
+// queries = [findPath options, ...]  (each parsed on its own), or
+//           { sources: u32[] | Uint32Array, targets: u32[] | Uint32Array,
+//             threads?: number  (default 1, at most ROUTE_THREADS - 1),
+//             priority?,
+//             ...findPath cost and engine options }
+//           (pair i is sources[i] -> targets[i], options parsed once)
+// result = {
+//   pathOffsets: Uint32Array  (route i is path[pathOffsets[i] ..
+//                pathOffsets[i + 1])), path: Uint32Array,
+//   modes: Uint8Array  (label of the step ending at path[k], 0 at a start),
+//   success: Uint8Array, durations, distances, distanceBikePreferred,
+//   distanceBikeNonPreferred, distanceWalk: Float64Array
+// }
+// Unreachable pairs get an empty range and Infinity duration and distance.
+Napi::Value FindPaths(const Napi::CallbackInfo& info)
+{
+  Napi::Env env = info.Env();
+  if (info.Length() < 2 || !info[0].IsObject() || !info[1].IsFunction())
+  {
+    Napi::TypeError::New(env, "usage: findPaths(queries, callback)")
+        .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  std::vector<BatchProfile> profiles;
+  std::vector<bool> useCch;
+  std::vector<BatchQuery> queries;
+  unsigned numThreads = 0;
+  RoutePool::Lane lane = RoutePool::Lane::Bulk;
+  auto addProfile = [&](Napi::Object obj) {
+    BatchProfile profile;
+    profile.params = parseParams(env, obj);
+    profile.options = parseSearchOptions(obj);
+    useCch.push_back(parseUseCch(obj));
+    profiles.push_back(std::move(profile));
+    return static_cast<uint32_t>(profiles.size() - 1);
+  };
+
+  try
+  {
+    if (info[0].IsArray())
+    {
+      Napi::Array list = info[0].As<Napi::Array>();
+      for (uint32_t i{0}; i < list.Length(); ++i)
+      {
+        Napi::Value item = list.Get(i);
+        if (!item.IsObject())
+          throw std::runtime_error("findPaths queries must be objects");
+        Napi::Object opt = item.As<Napi::Object>();
+        if (!opt.Get("sourceIdx").IsNumber() ||
+            !opt.Get("targetIdx").IsNumber())
+          throw std::runtime_error(
+              "each query must include numeric sourceIdx and targetIdx");
+        queries.push_back(
+            {opt.Get("sourceIdx").As<Napi::Number>().Uint32Value(),
+             opt.Get("targetIdx").As<Napi::Number>().Uint32Value(),
+             addProfile(opt)});
+      }
+    }
+    else
+    {
+      Napi::Object opt = info[0].As<Napi::Object>();
+      const std::vector<uint32_t> sources =
+          parseIndexList(opt.Get("sources"), "sources");
+      const std::vector<uint32_t> targets =
+          parseIndexList(opt.Get("targets"), "targets");
+      if (sources.size() != targets.size())
+        throw std::runtime_error("sources and targets must have equal length");
+
+      const uint32_t profile = addProfile(opt);
+      queries.reserve(sources.size());
+      for (std::size_t i{0}; i < sources.size(); ++i)
+        queries.push_back({sources[i], targets[i], profile});
+      numThreads = parseThreads(opt);
+      lane = parsePriority(opt, lane);
+    }
+  } catch (const std::exception& e)
+  {
+    Napi::TypeError::New(env, e.what()).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  auto cb = info[1].As<Napi::Function>();
+  RouteTask::Queue(env, cb, lane,
+                   std::make_unique<FindPathsWorker>(
+                       std::move(profiles), std::move(useCch),
+                       std::move(queries), numThreads));
+  return env.Undefined();
+}
+
+// JS: computeMatrix(options, callback)
+// options = {
+//   sources: u32[] | Uint32Array, targets: u32[] | Uint32Array,
+//   threads?: number  (0 or absent: 1, the routing thread only; at most
+//             ROUTE_THREADS - 1, the bulk share of the routing pool),
+//   ...the findPath cost params, plus queue? and edgeLayout?
+// }
+// result = { numSources, numTargets, durations: Float64Array,
+//            distances: Float64Array }, row-major (source i, target j at
+//            i * numTargets + j), Infinity where no route exists.
+// Each cell matches findPath for that pair.
+Napi::Value ComputeMatrix(const Napi::CallbackInfo& info)
+{
+  Napi::Env env = info.Env();
+  if (info.Length() < 2 || !info[0].IsObject() || !info[1].IsFunction())
+  {
+    Napi::TypeError::New(env, "usage: computeMatrix(options, callback)")
+        .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  Napi::Object opt = info[0].As<Napi::Object>();
+  std::vector<uint32_t> sources;
+  std::vector<uint32_t> targets;
+  AStarParams params;
+  SearchOptions options;
+  unsigned numThreads = 0;
+  RoutePool::Lane lane;
+  try
+  {
+    sources = parseIndexList(opt.Get("sources"), "sources");
+    targets = parseIndexList(opt.Get("targets"), "targets");
+    params = parseParams(env, opt);
+    options = parseSearchOptions(opt);
+    numThreads = parseThreads(opt);
+    lane = parsePriority(opt, RoutePool::Lane::Bulk);
+  } catch (const std::exception& e)
+  {
+    Napi::TypeError::New(env, e.what()).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  auto cb = info[1].As<Napi::Function>();
+  RouteTask::Queue(env, cb, lane,
+                   std::make_unique<ComputeMatrixWorker>(
+                       std::move(sources), std::move(targets),
+                       std::move(params), options, numThreads));
+  return env.Undefined();
+}
+
+// JS: computeIsochrone(options, callback)
+// options = {
+//   originIdx: <u32>, budgetsS: number[]  (seconds, e.g. [600, 1200, 1800]),
+//   cellSizeM?: number  (contour grid resolution, default 100),
+//   ...the findPath cost params, plus queue? and edgeLayout?
+// }
+// result = {
+//   nodes: Uint32Array, durations: Float64Array  (every node reachable
+//          within the largest budget, in settle order),
+//   bands: [{ budgetS, polygons: [[outer, ...holes]] }]  (rings are
+//          Float64Arrays of lon, lat pairs, GeoJSON MultiPolygon order)
+// }
+Napi::Value ComputeIsochrone(const Napi::CallbackInfo& info)
+{
+  Napi::Env env = info.Env();
+  if (info.Length() < 2 || !info[0].IsObject() || !info[1].IsFunction())
+  {
+    Napi::TypeError::New(env, "usage: computeIsochrone(options, callback)")
+        .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  Napi::Object opt = info[0].As<Napi::Object>();
+  if (!opt.Has("originIdx") || !opt.Get("originIdx").IsNumber() ||
+      !opt.Has("budgetsS") || !opt.Get("budgetsS").IsArray())
+  {
+    Napi::TypeError::New(env,
+                         "options must include numeric originIdx and a "
+                         "budgetsS array")
+        .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  const uint32_t originIdx =
+      opt.Get("originIdx").As<Napi::Number>().Uint32Value();
+  std::vector<double> budgetsS;
+  AStarParams params;
+  SearchOptions options;
+  double cellSizeM = 100.0;
+  RoutePool::Lane lane;
+  try
+  {
+    Napi::Array budgets = opt.Get("budgetsS").As<Napi::Array>();
+    for (uint32_t i{0}; i < budgets.Length(); ++i)
+    {
+      Napi::Value e = budgets.Get(i);
+      if (!e.IsNumber()) throw std::runtime_error("budgetsS must be numbers");
+      budgetsS.push_back(e.As<Napi::Number>().DoubleValue());
+    }
+    params = parseParams(env, opt);
+    options = parseSearchOptions(opt);
+    if (opt.Has("cellSizeM") && opt.Get("cellSizeM").IsNumber())
+      cellSizeM = opt.Get("cellSizeM").As<Napi::Number>().DoubleValue();
+    lane = parsePriority(opt, RoutePool::Lane::Interactive);
+  } catch (const std::exception& e)
+  {
+    Napi::TypeError::New(env, e.what()).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  auto cb = info[1].As<Napi::Function>();
+  RouteTask::Queue(env, cb, lane,
+                   std::make_unique<ComputeIsochroneWorker>(
+                       originIdx, std::move(budgetsS), std::move(params),
+                       options, cellSizeM));
   return env.Undefined();
 }
 
@@ -496,6 +1607,42 @@ Napi::Object Init(Napi::Env env, Napi::Object exports)
     glEdges = loadEdges(glEdgesPath);
     std::cerr << "[route.cpp] loaded numNodes =" << glNodes.numNodes
               << " numEdges =" << glEdges.numEdges << std::endl;
+    glEdgeSnap = EdgeSnapIndex(glNodes, glEdges);
+
+    // Landmarks are optional: without them the search falls back to the
+    // straight-line heuristic.
+    glLandmarksPath = resolvePath("data/graph_landmarks.bin");
+    try
+    {
+      glLandmarks = loadLandmarks(glLandmarksPath, glEdges);
+      std::cerr << "[route.cpp] loaded numLandmarks ="
+                << glLandmarks.numLandmarks << std::endl;
+    } catch (const std::exception& e)
+    {
+      glLandmarks = LandmarksView{};
+      std::cerr << "[route.cpp] no landmarks (" << e.what() << ")"
+                << std::endl;
+    }
+
+    // CCH is optional too: without it every query runs A*.
+    glCchPath = resolvePath("data/graph_cch.bin");
+    try
+    {
+      glCch = loadCch(glCchPath, glEdges);
+      std::cerr << "[route.cpp] loaded cch numArcs =" << glCch.numArcs
+                << std::endl;
+    } catch (const std::exception& e)
+    {
+      glCch = CchView{};
+      std::cerr << "[route.cpp] no cch (" << e.what() << ")" << std::endl;
+    }
+
+    // Results and metrics of a previous graph must not survive a reload
+    std::size_t cacheEntries = 4096;
+    if (const char* value = std::getenv("ROUTE_CACHE_ENTRIES"))
+      cacheEntries = std::strtoul(value, nullptr, 10);
+    glRouteCache.resize(cacheEntries);
+    glCchMetrics.clear();
 
     // mmap tuning hints (optional)
     // ::madvise(const_cast<uint32_t*>(glEdges.offsets),
@@ -517,7 +1664,26 @@ Napi::Object Init(Napi::Env env, Napi::Object exports)
     Napi::Error::New(env, std::string("[route] load failed: ") + e.what())
         .ThrowAsJavaScriptException();
   }
+  // Searches run on the addon's own threads, not the libuv pool.
+  // ROUTE_THREADS (default: hardware threads), ROUTE_QUEUE_DEPTH (per lane)
+  if (!glRoutePool)
+  {
+    std::size_t threads = std::thread::hardware_concurrency();
+    std::size_t queueDepth = 256;
+    if (const char* value = std::getenv("ROUTE_THREADS"))
+      threads = std::strtoul(value, nullptr, 10);
+    if (const char* value = std::getenv("ROUTE_QUEUE_DEPTH"))
+      queueDepth = std::strtoul(value, nullptr, 10);
+    glRoutePool = std::make_unique<RoutePool>(threads, queueDepth);
+  }
+
   exports.Set("findPath", Napi::Function::New(env, FindPath));
+  exports.Set("findPaths", Napi::Function::New(env, FindPaths));
+  exports.Set("findAlternatives", Napi::Function::New(env, FindAlternatives));
+  exports.Set("computeMatrix", Napi::Function::New(env, ComputeMatrix));
+  exports.Set("computeIsochrone",
+              Napi::Function::New(env, ComputeIsochrone));
+  exports.Set("snapToEdges", Napi::Function::New(env, SnapToEdges));
   exports.Set("getNodeIdByIdx", Napi::Function::New(env, GetNodeIdByIdx));
   exports.Set("getGraphInfo", Napi::Function::New(env, GetGraphInfo));
   return exports;
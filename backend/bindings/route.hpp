@@ -6,6 +6,9 @@
 #include <cstdint>
 #include <memory>
 #include <utility>
+#include <vector>
+
+#include "binHeaders.hpp"
 
 // ---------------- mmap helpers ----------------
 // 1) Make the mapping handle move-only
@@ -53,6 +56,26 @@ struct NodesView
   const uint64_t* ids{nullptr};
   const float* lat_f32{nullptr};
   const float* lon_f32{nullptr};
+
+  // Local planar frame in meters (see attachPlanarCoords), built at load
+  std::shared_ptr<const std::vector<float>> planarHold;
+  const float* xM{nullptr};  // N, east
+  const float* yM{nullptr};  // N, north
+  // Frame parameters, for projecting points that are not nodes:
+  // xM = (lon - originLon) * metersPerDegX, yM = (lat - originLat) * ...Y
+  double originLat{0.0};
+  double originLon{0.0};
+  double metersPerDegX{0.0};
+  double metersPerDegY{0.0};
+};
+
+// Incoming-edge CSR built in memory for bins written before the reverse
+// section existed.
+struct ReverseCsr
+{
+  std::vector<uint32_t> offsets;  // N+1
+  std::vector<uint32_t> sources;  // E
+  std::vector<uint32_t> edgeIds;  // E
 };
 
 struct EdgesView
@@ -65,4 +88,39 @@ struct EdgesView
   const float* lengthsMeters{nullptr};     // E
   const uint8_t* surfacePrimary{nullptr};  // E
   const uint8_t* modeMask{nullptr};        // E (bit0=BIKE, bit1=FOOT)
+
+  // Incoming CSR: edges into node v are inOffsets[v]..inOffsets[v+1]; each
+  // entry names the tail node and the edge id in the forward arrays above.
+  std::shared_ptr<const ReverseCsr> reverseHold;  // only if built at load
+  const uint32_t* inOffsets{nullptr};  // N+1
+  const uint32_t* inSources{nullptr};  // E
+  const uint32_t* inEdgeIds{nullptr};  // E
+
+  // Packed adjacency records, same edge order as the arrays above; nullptr
+  // if the graph does not fit ingest::PackedEdge.
+  std::shared_ptr<const std::vector<ingest::PackedEdge>> packedHold;
+  const ingest::PackedEdge* packed{nullptr};  // E
+};
+
+// Landmark distance tables (graph_landmarks.bin), node-major:
+// entry v * numLandmarks + i is the distance in meters from landmark i to v
+// (fromLandmark) or from v to landmark i (toLandmark).
+struct LandmarksView
+{
+  std::shared_ptr<MappedFile> hold;  // keep mapping alive
+  uint32_t numNodes{0};
+  uint32_t numLandmarks{0};
+  const uint32_t* nodes{nullptr};       // K
+  const float* fromLandmark{nullptr};  // N*K
+  const float* toLandmark{nullptr};    // N*K
+};
+
+// Packed KD-tree of graph_spatial.bin (see ingest::SpatialHeader), one
+// node per graph node; kd2d::PackedKDTree::adopt searches it in place.
+struct SpatialView
+{
+  std::shared_ptr<MappedFile> hold;  // keep mapping alive
+  uint32_t numNodes{0};
+  int32_t rootIndex{-1};
+  const ingest::KdTreeNode* kdNodes{nullptr};  // N
 };
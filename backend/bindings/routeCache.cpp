@@ -0,0 +1,167 @@
+#include "routeCache.hpp"
+
+#include <cstring>
+#include <utility>
+
+std::size_t RouteCache::KeyHash::operator()(const Key& key) const
+{
+  // FNV-1a over the pair and the bit patterns of the profile
+  std::uint64_t hash = 1469598103934665603ull;
+  auto mix = [&](std::uint64_t word) {
+    for (int byte{0}; byte < 8; ++byte)
+    {
+      hash ^= (word >> (8 * byte)) & 0xFF;
+      hash *= 1099511628211ull;
+    }
+  };
+  mix((std::uint64_t(key.sourceIdx) << 32) | key.targetIdx);
+  for (const std::vector<double>* values : {&key.profile, &key.points})
+  {
+    for (double value : *values)
+    {
+      std::uint64_t bits;
+      std::memcpy(&bits, &value, sizeof bits);
+      mix(bits);
+    }
+  }
+  return static_cast<std::size_t>(hash);
+}
+
+RouteCache::Key RouteCache::snappedKey(const std::vector<EdgePoint>& sources,
+                                       const std::vector<EdgePoint>& targets,
+                                       const AStarParams& params)
+{
+  Key key{UINT32_MAX, UINT32_MAX, profileKey(params), {}};
+  key.points.reserve(1 + 2 * (sources.size() + targets.size()));
+  key.points.push_back(double(sources.size()));
+  for (const auto* ends : {&sources, &targets})
+  {
+    for (const EdgePoint& point : *ends)
+    {
+      key.points.push_back(double(point.edgeIdx));
+      key.points.push_back(point.offset);
+    }
+  }
+  return key;
+}
+
+RouteCache::Shard& RouteCache::shardOf(const Key& key)
+{
+  // High bits pick the shard; the map inside uses the whole hash
+  return shards[(KeyHash{}(key) >> 32) % kShards];
+}
+
+std::shared_ptr<const AStarResult> RouteCache::find(std::uint32_t sourceIdx,
+                                                    std::uint32_t targetIdx,
+                                                    const AStarParams& params)
+{
+  if (shardCapacity.load(std::memory_order_relaxed) == 0)
+  {
+    ++misses;
+    return nullptr;
+  }
+  return find(Key{sourceIdx, targetIdx, profileKey(params), {}});
+}
+
+std::shared_ptr<const AStarResult> RouteCache::find(
+    const std::vector<EdgePoint>& sources,
+    const std::vector<EdgePoint>& targets, const AStarParams& params)
+{
+  if (shardCapacity.load(std::memory_order_relaxed) == 0)
+  {
+    ++misses;
+    return nullptr;
+  }
+  return find(snappedKey(sources, targets, params));
+}
+
+std::shared_ptr<const AStarResult> RouteCache::find(const Key& key)
+{
+  Shard& shard = shardOf(key);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  auto it = shard.index.find(key);
+  if (it == shard.index.end())
+  {
+    ++misses;
+    return nullptr;
+  }
+  shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+  ++hits;
+  return it->second->second;
+}
+
+void RouteCache::insert(std::uint32_t sourceIdx, std::uint32_t targetIdx,
+                        const AStarParams& params, const AStarResult& result)
+{
+  if (shardCapacity.load(std::memory_order_relaxed) == 0) return;
+  insert(Key{sourceIdx, targetIdx, profileKey(params), {}}, result);
+}
+
+void RouteCache::insert(const std::vector<EdgePoint>& sources,
+                        const std::vector<EdgePoint>& targets,
+                        const AStarParams& params, const AStarResult& result)
+{
+  if (shardCapacity.load(std::memory_order_relaxed) == 0) return;
+  insert(snappedKey(sources, targets, params), result);
+}
+
+void RouteCache::insert(Key key, const AStarResult& result)
+{
+  const std::size_t capacity = shardCapacity.load(std::memory_order_relaxed);
+  if (capacity == 0) return;
+
+  // Exact-size copies: the search's vectors carry spare capacity
+  auto stored = std::make_shared<AStarResult>(result);
+  stored->pathNodes.shrink_to_fit();
+  stored->pathModes.shrink_to_fit();
+
+  Shard& shard = shardOf(key);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  auto it = shard.index.find(key);
+  if (it != shard.index.end())
+  {
+    // Another thread finished the same route first
+    it->second->second = std::move(stored);
+    shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+    return;
+  }
+
+  shard.entries.emplace_front(key, std::move(stored));
+  shard.index.emplace(std::move(key), shard.entries.begin());
+  while (shard.entries.size() > capacity)
+  {
+    shard.index.erase(shard.entries.back().first);
+    shard.entries.pop_back();
+    ++evictions;
+  }
+}
+
+void RouteCache::clear()
+{
+  for (Shard& shard : shards)
+  {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.index.clear();
+    shard.entries.clear();
+  }
+  hits = 0;
+  misses = 0;
+  evictions = 0;
+}
+
+void RouteCache::resize(std::size_t capacity)
+{
+  clear();
+  shardCapacity = (capacity + kShards - 1) / kShards;
+}
+
+RouteCache::Stats RouteCache::stats() const
+{
+  Stats out{shardCapacity * kShards, 0, hits, misses, evictions};
+  for (const Shard& shard : shards)
+  {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    out.size += shard.entries.size();
+  }
+  return out;
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "aStar.hpp"
+
+// ---------------- Route result cache ----------------
+// Finished routes keyed by (source, target, profileKey(params)), or for
+// snapped queries by the snapped edge points in place of the node pair.
+// Engine options (algorithm, queue, direction) are not part of the key.
+// Every engine returns a least-cost route for the profile, but not the
+// same one to the last bit: CCH sums float arc weights, so its costS can
+// differ from A*'s by float rounding (up to 8.4e-4 s over 2000 Helsinki
+// pairs), and on equal-cost ties the path itself may differ. A hit
+// returns whichever engine filled the entry.
+// Sharded by key hash, each shard an LRU list behind its own mutex, so
+// concurrent lookups for different pairs rarely contend.
+
+class RouteCache
+{
+ public:
+  struct Stats
+  {
+    std::size_t capacity;
+    std::size_t size;
+    std::uint64_t hits;
+    std::uint64_t misses;
+    std::uint64_t evictions;
+  };
+
+  // capacity 0 disables the cache (every lookup misses, nothing is kept)
+  explicit RouteCache(std::size_t capacity = 4096) { resize(capacity); }
+
+  // nullptr on a miss
+  std::shared_ptr<const AStarResult> find(std::uint32_t sourceIdx,
+                                          std::uint32_t targetIdx,
+                                          const AStarParams& params);
+  void insert(std::uint32_t sourceIdx, std::uint32_t targetIdx,
+              const AStarParams& params, const AStarResult& result);
+
+  // Snapped ends: the same points snap to the same edges and offsets, so
+  // repeated requests for the same clicks hit.
+  std::shared_ptr<const AStarResult> find(
+      const std::vector<EdgePoint>& sources,
+      const std::vector<EdgePoint>& targets, const AStarParams& params);
+  void insert(const std::vector<EdgePoint>& sources,
+              const std::vector<EdgePoint>& targets, const AStarParams& params,
+              const AStarResult& result);
+
+  // Drops every entry and resets the counters (graph reloaded)
+  void clear();
+  // Drops every entry and changes the capacity
+  void resize(std::size_t capacity);
+
+  Stats stats() const;
+
+ private:
+  inline static constexpr std::size_t kShards = 16;
+
+  struct Key
+  {
+    // Both UINT32_MAX for snapped ends; points then holds the number of
+    // sources and every source and target as an edgeIdx, offset pair.
+    std::uint32_t sourceIdx;
+    std::uint32_t targetIdx;
+    std::vector<double> profile;
+    std::vector<double> points;
+
+    bool operator==(const Key& other) const
+    {
+      return sourceIdx == other.sourceIdx && targetIdx == other.targetIdx &&
+             profile == other.profile && points == other.points;
+    }
+  };
+
+  static Key snappedKey(const std::vector<EdgePoint>& sources,
+                        const std::vector<EdgePoint>& targets,
+                        const AStarParams& params);
+
+  struct KeyHash
+  {
+    std::size_t operator()(const Key& key) const;
+  };
+
+  struct Shard
+  {
+    using Entry = std::pair<Key, std::shared_ptr<const AStarResult>>;
+
+    mutable std::mutex mutex;
+    std::list<Entry> entries;  // most recently used first
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index;
+  };
+
+  Shard& shardOf(const Key& key);
+  std::shared_ptr<const AStarResult> find(const Key& key);
+  void insert(Key key, const AStarResult& result);
+
+  std::array<Shard, kShards> shards;
+  std::atomic<std::size_t> shardCapacity{0};
+  std::atomic<std::uint64_t> hits{0};
+  std::atomic<std::uint64_t> misses{0};
+  std::atomic<std::uint64_t> evictions{0};
+};
@@ -0,0 +1,204 @@
+#include "routeGeometry.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace
+{
+struct Point
+{
+  double x;
+  double y;
+};
+
+// Distance from p to the segment a-b, in meters
+double segmentDistance(const Point& p, const Point& a, const Point& b)
+{
+  const double dx = b.x - a.x;
+  const double dy = b.y - a.y;
+  const double len2 = dx * dx + dy * dy;
+  double t = 0.0;
+  if (len2 > 0.0)
+    t = std::clamp(((p.x - a.x) * dx + (p.y - a.y) * dy) / len2, 0.0, 1.0);
+  return std::hypot(p.x - (a.x + t * dx), p.y - (a.y + t * dy));
+}
+
+double triangleArea(const Point& a, const Point& b, const Point& c)
+{
+  return 0.5 * std::fabs((b.x - a.x) * (c.y - a.y) - (c.x - a.x) * (b.y - a.y));
+}
+
+// Marks the points of (first, last) to keep. Iterative, so long spans
+// cannot overflow the stack.
+void douglasPeucker(const std::vector<Point>& points, uint32_t first,
+                    uint32_t last, double toleranceM, std::vector<char>& keep)
+{
+  std::vector<std::pair<uint32_t, uint32_t>> spans{{first, last}};
+  while (!spans.empty())
+  {
+    const auto [a, b] = spans.back();
+    spans.pop_back();
+    double farthest = -1.0;
+    uint32_t farthestPos = a;
+    for (uint32_t i{a + 1}; i < b; ++i)
+    {
+      const double d = segmentDistance(points[i], points[a], points[b]);
+      if (d > farthest)
+      {
+        farthest = d;
+        farthestPos = i;
+      }
+    }
+    if (farthest <= toleranceM) continue;
+    keep[farthestPos] = 1;
+    spans.emplace_back(a, farthestPos);
+    spans.emplace_back(farthestPos, b);
+  }
+}
+
+// Linked list and areas over the whole path, reused by every span
+struct VisvalingamScratch
+{
+  std::vector<uint32_t> prev, next;
+  std::vector<double> area;
+};
+
+// Removes the point with the smallest effective area until every remaining
+// one spans at least minArea. Areas never drop below that of a point
+// removed before them, so the result does not depend on removal ties.
+void visvalingam(const std::vector<Point>& points, uint32_t first,
+                 uint32_t last, double minArea, std::vector<char>& keep,
+                 VisvalingamScratch& scratch)
+{
+  if (last - first < 2) return;
+
+  std::vector<uint32_t>& prev = scratch.prev;
+  std::vector<uint32_t>& next = scratch.next;
+  std::vector<double>& area = scratch.area;
+  using Entry = std::pair<double, uint32_t>;
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> heap;
+  for (uint32_t i{first + 1}; i < last; ++i)
+  {
+    prev[i] = i - 1;
+    next[i] = i + 1;
+    keep[i] = 1;
+    area[i] = triangleArea(points[i - 1], points[i], points[i + 1]);
+    heap.emplace(area[i], i);
+  }
+  next[first] = first + 1;
+  prev[last] = last - 1;
+
+  double floorArea = 0.0;
+  while (!heap.empty())
+  {
+    const auto [entryArea, i] = heap.top();
+    heap.pop();
+    if (!keep[i] || entryArea != area[i]) continue;  // removed or stale
+    if (entryArea >= minArea) break;
+
+    floorArea = std::max(floorArea, entryArea);
+    keep[i] = 0;
+    const uint32_t p = prev[i];
+    const uint32_t n = next[i];
+    next[p] = n;
+    prev[n] = p;
+    for (uint32_t j : {p, n})
+    {
+      if (j == first || j == last) continue;
+      area[j] = std::max(
+          floorArea, triangleArea(points[prev[j]], points[j], points[next[j]]));
+      heap.emplace(area[j], j);
+    }
+  }
+}
+
+void appendPolylineValue(int64_t value, std::string& out)
+{
+  uint64_t bits = static_cast<uint64_t>(value) << 1;
+  if (value < 0) bits = ~bits;
+  while (bits >= 0x20)
+  {
+    out.push_back(static_cast<char>((0x20 | (bits & 0x1f)) + 63));
+    bits >>= 5;
+  }
+  out.push_back(static_cast<char>(bits + 63));
+}
+}  // namespace
+
+std::vector<uint32_t> simplifyPath(const std::vector<float>& xyM,
+                                   const std::vector<uint8_t>& pathModes,
+                                   const SimplifyOptions& options)
+{
+  const uint32_t n = static_cast<uint32_t>(xyM.size() / 2);
+  std::vector<uint32_t> kept;
+  if (options.method == SimplifyMethod::None || n < 3)
+  {
+    kept.resize(n);
+    for (uint32_t i{0}; i < n; ++i) kept[i] = i;
+    return kept;
+  }
+  if (!(options.toleranceM >= 0.0))
+    throw std::runtime_error("toleranceM must be >= 0");
+  if (pathModes.size() + 1 != n)
+    throw std::runtime_error("path modes do not match the path");
+
+  std::vector<Point> points(n);
+  for (uint32_t i{0}; i < n; ++i) points[i] = Point{xyM[2 * i], xyM[2 * i + 1]};
+
+  // Anchors: both ends and every mode change. Each span between two
+  // anchors is simplified on its own.
+  std::vector<char> keep(n, 0);
+  keep[0] = keep[n - 1] = 1;
+  for (uint32_t i{1}; i + 1 < n; ++i)
+    if (pathModes[i] != pathModes[i - 1]) keep[i] = 1;
+
+  const double minArea = options.toleranceM * options.toleranceM;
+  VisvalingamScratch scratch;
+  if (options.method == SimplifyMethod::Visvalingam)
+  {
+    scratch.prev.resize(n);
+    scratch.next.resize(n);
+    scratch.area.resize(n);
+  }
+  uint32_t spanStart = 0;
+  for (uint32_t i{1}; i < n; ++i)
+  {
+    if (!keep[i]) continue;
+    if (options.method == SimplifyMethod::DouglasPeucker)
+      douglasPeucker(points, spanStart, i, options.toleranceM, keep);
+    else
+      visvalingam(points, spanStart, i, minArea, keep, scratch);
+    spanStart = i;
+  }
+
+  for (uint32_t i{0}; i < n; ++i)
+    if (keep[i]) kept.push_back(i);
+  return kept;
+}
+
+std::string encodePolyline(const std::vector<float>& latLon, int precision)
+{
+  if (precision != 5 && precision != 6)
+    throw std::runtime_error("polyline precision must be 5 or 6");
+  const double factor = precision == 5 ? 1e5 : 1e6;
+
+  std::string out;
+  out.reserve(latLon.size() * 4);
+  int64_t lastLat = 0, lastLon = 0;
+  for (std::size_t i{0}; i + 1 < latLon.size(); i += 2)
+  {
+    const int64_t lat = std::llround(double(latLon[i]) * factor);
+    const int64_t lon = std::llround(double(latLon[i + 1]) * factor);
+    appendPolylineValue(lat - lastLat, out);
+    appendPolylineValue(lon - lastLon, out);
+    lastLat = lat;
+    lastLon = lon;
+  }
+  return out;
+}
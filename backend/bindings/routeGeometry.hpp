@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ---------------- Route geometry ----------------
+// Line simplification over the planar node coordinates (meters) and
+// encoded polyline output. Plain C++; findPath applies it on the routing
+// thread after the search.
+
+enum class SimplifyMethod : std::uint8_t
+{
+  None = 0,
+  DouglasPeucker = 1,  // drop points within toleranceM of the kept chord
+  Visvalingam = 2      // drop points whose triangle area < toleranceM^2
+};
+
+struct SimplifyOptions
+{
+  SimplifyMethod method{SimplifyMethod::None};
+  double toleranceM{5.0};
+};
+
+// Positions of the points to keep in a line given as x, y pairs
+// (interleaved, planar meters), ascending. The ends and every point where
+// the step mode changes are always kept, so step j of the simplified line
+// has mode pathModes[kept[j]]. Returns every position for
+// SimplifyMethod::None or lines of fewer than three points.
+[[nodiscard]]
+std::vector<std::uint32_t> simplifyPath(
+    const std::vector<float>& xyM, const std::vector<std::uint8_t>& pathModes,
+    const SimplifyOptions& options);
+
+// Google encoded polyline of lat, lon pairs (interleaved), with 5 or 6
+// decimal digits (precision 6 is the OSRM/Valhalla "polyline6").
+[[nodiscard]]
+std::string encodePolyline(const std::vector<float>& latLon, int precision);
@@ -0,0 +1,113 @@
+#include "routePool.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+RoutePool::RoutePool(std::size_t numThreads, std::size_t maxQueuedIn)
+    : maxQueued(maxQueuedIn)
+{
+  numThreads = std::max<std::size_t>(1, numThreads);
+  maxBulkRunning = numThreads > 1 ? numThreads - 1 : 1;
+
+  threads.reserve(numThreads);
+  for (std::size_t i{0}; i < numThreads; ++i)
+    threads.emplace_back([this] { workerLoop(); });
+}
+
+RoutePool::~RoutePool()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  wake.notify_all();
+  for (std::thread& thread : threads) thread.join();
+}
+
+bool RoutePool::submit(Lane lane, Task task)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& queue = queues[static_cast<std::size_t>(lane)];
+    if (stopping || queue.size() >= maxQueued)
+    {
+      ++rejected;
+      return false;
+    }
+    queue.push_back(std::move(task));
+  }
+  wake.notify_one();
+  return true;
+}
+
+bool RoutePool::takeNext(Task& task, Lane& lane)
+{
+  auto& interactive = queues[static_cast<std::size_t>(Lane::Interactive)];
+  auto& bulk = queues[static_cast<std::size_t>(Lane::Bulk)];
+
+  if (!interactive.empty())
+  {
+    task = std::move(interactive.front());
+    interactive.pop_front();
+    lane = Lane::Interactive;
+    return true;
+  }
+  if (!bulk.empty() &&
+      running[static_cast<std::size_t>(Lane::Bulk)] < maxBulkRunning)
+  {
+    task = std::move(bulk.front());
+    bulk.pop_front();
+    lane = Lane::Bulk;
+    return true;
+  }
+  return false;
+}
+
+void RoutePool::workerLoop()
+{
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true)
+  {
+    Task task;
+    Lane lane;
+    wake.wait(lock, [&] { return stopping || takeNext(task, lane); });
+    if (stopping)
+    {
+      // Nothing new starts once stopping is set. Whichever worker gets
+      // here first takes the queued tasks and finishes them unrun; the
+      // others find the queues empty. Running tasks complete as usual.
+      std::deque<Task> abandoned;
+      for (auto& queue : queues)
+      {
+        std::move(queue.begin(), queue.end(), std::back_inserter(abandoned));
+        queue.clear();
+      }
+      lock.unlock();
+      for (Task& queued : abandoned) queued(/*shuttingDown=*/true);
+      return;
+    }
+
+    const auto slot = static_cast<std::size_t>(lane);
+    ++running[slot];
+    lock.unlock();
+    task(/*shuttingDown=*/false);
+    lock.lock();
+    --running[slot];
+    ++completed;
+
+    // A finished bulk task may unblock a queued one for another thread
+    if (lane == Lane::Bulk) wake.notify_one();
+  }
+}
+
+RoutePool::Stats RoutePool::stats() const
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  return Stats{threads.size(),
+               maxQueued,
+               {queues[0].size(), queues[1].size()},
+               {running[0], running[1]},
+               completed,
+               rejected};
+}
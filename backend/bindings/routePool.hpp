@@ -0,0 +1,77 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ---------------- Routing thread pool ----------------
+// Fixed threads owned by the route addon, so searches do not compete with
+// fs and DNS work on the libuv pool. Two lanes:
+//   Interactive  navigation and reroutes, always served first
+//   Bulk         planning and batch work; may use every thread but one,
+//                so a burst of long bulk jobs cannot block interactive ones
+// Each lane has a bounded queue; submit() fails at once when it is full.
+// Destroying the pool finishes the running tasks and hands every queued
+// one to a worker with shuttingDown set, so it can release what it holds.
+
+class RoutePool
+{
+ public:
+  enum class Lane : std::uint8_t
+  {
+    Interactive = 0,
+    Bulk = 1
+  };
+
+  struct Stats
+  {
+    std::size_t threads;
+    std::size_t maxQueued;  // per lane
+    std::size_t queued[2];  // by Lane
+    std::size_t running[2];
+    std::uint64_t completed;
+    std::uint64_t rejected;
+  };
+
+  RoutePool(std::size_t numThreads, std::size_t maxQueuedIn);
+  ~RoutePool();
+
+  RoutePool(const RoutePool&) = delete;
+  RoutePool& operator=(const RoutePool&) = delete;
+
+  // Called once: shuttingDown is false to do the work, true if the pool is
+  // being destroyed before it ran (finish without working). Must not throw.
+  using Task = std::function<void(bool shuttingDown)>;
+
+  // false (task not taken) if the lane's queue is full
+  bool submit(Lane lane, Task task);
+
+  Stats stats() const;
+
+  // Threads a task that fans out may use, its own included: the bulk
+  // share, so even one such task leaves a thread for interactive work.
+  std::size_t bulkShare() const { return maxBulkRunning; }
+
+ private:
+  void workerLoop();
+  // Next task a free thread may run, or false; caller holds the mutex
+  bool takeNext(Task& task, Lane& lane);
+
+  std::size_t maxQueued;
+  std::size_t maxBulkRunning;
+
+  mutable std::mutex mutex;
+  std::condition_variable wake;
+  std::deque<Task> queues[2];
+  std::size_t running[2]{0, 0};
+  std::uint64_t completed{0};
+  std::uint64_t rejected{0};
+  bool stopping{false};
+
+  std::vector<std::thread> threads;
+};
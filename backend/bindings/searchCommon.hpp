@@ -0,0 +1,591 @@
+#pragma once
+
+// Internal helpers shared by the forward and bidirectional two-layer searches.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "aStar.hpp"
+
+// NOTE: Keep edge-access bits separate from the path step labels.
+// Edges use bitmasks (bike=0x1, foot=0x2). MODE_* values are for OUTPUT
+// labeling.
+inline constexpr std::uint8_t EDGE_MASK_BIKE = 0x1;
+inline constexpr std::uint8_t EDGE_MASK_FOOT = 0x2;
+
+inline bool isPreferredBike(std::uint8_t primary, std::uint16_t mask) noexcept
+{
+  if (primary >= 16) return true;  // unknown → neutral (no penalty)
+  return (mask & (std::uint16_t(1) << primary)) != 0;
+}
+
+// Table slot for surface codes outside the 16 known ones (and for graphs
+// without surface codes).
+inline constexpr std::size_t kUnknownSurfaceSlot = 16;
+
+// Edge readers for the relaxation loops; both return the same values.
+// SoaEdges reads four arrays per edge, PackedEdges one 8-byte record.
+class SoaEdges
+{
+ public:
+  explicit SoaEdges(const EdgesView& edgesViewIn) : edgesView(edgesViewIn) {}
+
+  std::uint32_t head(std::uint32_t edgeIdx) const
+  {
+    return edgesView.neighbors[edgeIdx];
+  }
+  std::uint8_t mode(std::uint32_t edgeIdx) const
+  {
+    return edgesView.modeMask[edgeIdx];
+  }
+  double lengthM(std::uint32_t edgeIdx) const
+  {
+    return static_cast<double>(edgesView.lengthsMeters[edgeIdx]);
+  }
+  std::size_t surfaceSlot(std::uint32_t edgeIdx) const
+  {
+    if (!edgesView.surfacePrimary) return kUnknownSurfaceSlot;
+    return std::min<std::size_t>(edgesView.surfacePrimary[edgeIdx],
+                                 kUnknownSurfaceSlot);
+  }
+
+ private:
+  const EdgesView& edgesView;
+};
+
+class PackedEdges
+{
+ public:
+  explicit PackedEdges(const EdgesView& edgesView) : records(edgesView.packed)
+  {}
+
+  std::uint32_t head(std::uint32_t edgeIdx) const
+  {
+    return records[edgeIdx].word & ingest::kPackedHeadMask;
+  }
+  std::uint8_t mode(std::uint32_t edgeIdx) const
+  {
+    return static_cast<std::uint8_t>(records[edgeIdx].word >>
+                                     ingest::kPackedModeShift);
+  }
+  double lengthM(std::uint32_t edgeIdx) const
+  {
+    return static_cast<double>(records[edgeIdx].lengthMeters);
+  }
+  std::size_t surfaceSlot(std::uint32_t edgeIdx) const
+  {
+    return (records[edgeIdx].word >> ingest::kPackedSurfaceShift) & 0xF;
+  }
+
+ private:
+  const ingest::PackedEdge* records;
+};
+
+// Which relaxation kernel a query needs, cheapest first. Picked once per
+// query by CostModel::kernel(); the searches are instantiated per kernel so
+// the unused branches and loads disappear from the inner loops.
+enum class CostKernel : std::uint8_t
+{
+  Uniform,        // one seconds-per-meter per layer, every ride step preferred
+  Surface,        // per-surface seconds-per-meter, no preference penalty
+  SurfacePenalty  // per-surface seconds-per-meter and penalty per meter
+};
+
+// Per-query edge costs for both layers. The same edge costs the same in the
+// forward and the backward search.
+//
+// Everything that depends on the surface is folded into small tables built
+// once per query: a relaxation is one table load and one multiply by the
+// edge length, with no null, range or NaN checks left in the loop.
+class CostModel
+{
+ public:
+  CostModel(const AStarParams& params, const EdgesView& edgesView)
+  {
+    const double invBike = 1.0 / params.bikeSpeedMps;
+    const double invWalk = 1.0 / params.walkSpeedMps;
+    const double wSurfPerM = std::max(0.0, params.surfacePenaltySPerKm) * 0.001;
+
+    // Slot kNumSurfaces stands for every out-of-range code: neutral factor,
+    // preferred (as surfaceFactor() and isPreferredBike() treat them).
+    for (std::size_t slot{0}; slot <= kNumSurfaces; ++slot)
+    {
+      const bool known = slot < kNumSurfaces;
+      const auto code = static_cast<std::uint8_t>(slot);
+      auto factor = [&](const std::vector<double>& factors) {
+        return known ? surfaceFactor(factors, code) : 1.0;
+      };
+      const bool preferred =
+          !known || isPreferredBike(code, params.bikeSurfaceMask);
+
+      rideTable[slot].secondsPerM = invBike * factor(params.bikeSurfaceFactor);
+      rideTable[slot].penaltyPerM = preferred ? 0.0 : wSurfPerM;
+      rideTable[slot].stepLabel =
+          preferred ? MODE_BIKE_PREFERRED : MODE_BIKE_NON_PREFERRED;
+      walkSecondsPerM[slot] = invWalk * factor(params.walkSurfaceFactor);
+    }
+
+    // Without surface codes every edge rides at factor 1 and counts as
+    // preferred, the same as the table's out-of-range slot.
+    const bool hasSurfaces = edgesView.surfacePrimary != nullptr;
+    uniformRideSPerM = hasSurfaces ? rideTable[0].secondsPerM : invBike;
+    uniformWalkSPerM = hasSurfaces ? walkSecondsPerM[0] : invWalk;
+
+    bool anyPenalty = false;
+    bool uniform = true;
+    for (std::size_t slot{0}; slot <= kNumSurfaces; ++slot)
+    {
+      anyPenalty |= rideTable[slot].penaltyPerM > 0.0;
+      uniform &= rideTable[slot].secondsPerM == uniformRideSPerM &&
+                 rideTable[slot].stepLabel == MODE_BIKE_PREFERRED &&
+                 walkSecondsPerM[slot] == uniformWalkSPerM;
+    }
+    if (!hasSurfaces || uniform)
+      selected = CostKernel::Uniform;
+    else
+      selected = anyPenalty ? CostKernel::SurfacePenalty : CostKernel::Surface;
+  }
+
+  CostKernel kernel() const { return selected; }
+
+  // Ride layer. Returns false if bikes may not use the edge. The default
+  // kernel is valid for every query; the others only when kernel() says so.
+  template <CostKernel kKernel = CostKernel::SurfacePenalty, class Edges>
+  bool ride(const Edges& edges, std::uint32_t edgeIdx, double& timeS,
+            double& penaltyS, std::uint8_t& stepLabel) const
+  {
+    if ((edges.mode(edgeIdx) & EDGE_MASK_BIKE) == 0) return false;
+
+    const double len = edges.lengthM(edgeIdx);
+    if constexpr (kKernel == CostKernel::Uniform)
+    {
+      timeS = len * uniformRideSPerM;
+      penaltyS = 0.0;
+      stepLabel = MODE_BIKE_PREFERRED;
+    }
+    else
+    {
+      const SurfaceCost& cost = rideTable[edges.surfaceSlot(edgeIdx)];
+      timeS = len * cost.secondsPerM;
+      penaltyS = kKernel == CostKernel::SurfacePenalty
+                     ? len * cost.penaltyPerM
+                     : 0.0;
+      stepLabel = cost.stepLabel;
+    }
+    return true;
+  }
+
+  // Walk layer. Returns false if walking is not allowed on the edge.
+  template <CostKernel kKernel = CostKernel::SurfacePenalty, class Edges>
+  bool walk(const Edges& edges, std::uint32_t edgeIdx, double& timeS) const
+  {
+    if ((edges.mode(edgeIdx) & EDGE_MASK_FOOT) == 0) return false;
+
+    const double len = edges.lengthM(edgeIdx);
+    if constexpr (kKernel == CostKernel::Uniform)
+      timeS = len * uniformWalkSPerM;
+    else
+      timeS = len * walkSecondsPerM[edges.surfaceSlot(edgeIdx)];
+    return true;
+  }
+
+ private:
+  inline static constexpr std::size_t kNumSurfaces = kUnknownSurfaceSlot;
+
+  struct SurfaceCost
+  {
+    double secondsPerM;
+    double penaltyPerM;  // non-preferred bike surfaces only
+    std::uint8_t stepLabel;
+  };
+
+  std::array<SurfaceCost, kNumSurfaces + 1> rideTable{};
+  std::array<double, kNumSurfaces + 1> walkSecondsPerM{};
+  double uniformRideSPerM{0.0};
+  double uniformWalkSPerM{0.0};
+  CostKernel selected{CostKernel::SurfacePenalty};
+};
+
+// Call fn(kernelTag) with std::integral_constant<CostKernel, K> for the
+// query's kernel, so callers can instantiate on it.
+template <class Fn>
+auto withCostKernel(CostKernel kernel, Fn&& fn)
+{
+  switch (kernel)
+  {
+    case CostKernel::Uniform:
+      return fn(std::integral_constant<CostKernel, CostKernel::Uniform>{});
+    case CostKernel::Surface:
+      return fn(std::integral_constant<CostKernel, CostKernel::Surface>{});
+    case CostKernel::SurfacePenalty:
+    default:
+      return fn(
+          std::integral_constant<CostKernel, CostKernel::SurfacePenalty>{});
+  }
+}
+
+// Cost of the share fraction of an edge in one layer; false if the layer
+// may not use the edge.
+template <CostKernel kKernel = CostKernel::SurfacePenalty, class Edges>
+inline bool partialEdgeCost(const CostModel& costs, const Edges& edges,
+                            std::uint32_t edgeIdx, Layer layer,
+                            double fraction, double& costS, double& timeS,
+                            std::uint8_t& stepLabel)
+{
+  double penaltyS{0.0};
+  if (layer == Layer::Ride)
+  {
+    if (!costs.ride<kKernel>(edges, edgeIdx, timeS, penaltyS, stepLabel))
+      return false;
+  }
+  else
+  {
+    if (!costs.walk<kKernel>(edges, edgeIdx, timeS)) return false;
+    stepLabel = MODE_FOOT;
+  }
+  costS = fraction * (timeS + penaltyS);
+  timeS *= fraction;
+  return true;
+}
+
+// Fastest seconds per meter any layer can achieve under params: every
+// edge costs at least lengthMeters * this (penalties are >= 0).
+inline double fastestSecondsPerMeter(const AStarParams& params)
+{
+  // surfaceFactor() falls back to 1.0 for missing or invalid entries
+  auto minFactor = [](const std::vector<double>& factors) {
+    double lowest = 1.0;
+    for (double factor : factors)
+    {
+      if (std::isfinite(factor) && factor > 0.0)
+        lowest = std::min(lowest, factor);
+    }
+    return lowest;
+  };
+  return std::min(minFactor(params.bikeSurfaceFactor) / params.bikeSpeedMps,
+                  minFactor(params.walkSurfaceFactor) / params.walkSpeedMps);
+}
+
+// Lower bound on the cost between a fixed anchor node and any node v:
+// max(planar straight-line meters, landmark triangle bounds) * fastest s/m.
+// The anchor is the target (bound for v -> t) or the source (s -> v).
+// Landmark distances are taken over every bike or foot edge, so the bound
+// holds for any profile; both terms are consistent, and so is their max.
+class TravelTimeBound
+{
+ public:
+  enum class Anchor : std::uint8_t
+  {
+    Target,
+    Source
+  };
+
+  // Only this many landmarks are evaluated per node: the ones giving the
+  // best bound between the two query endpoints.
+  inline static constexpr std::uint32_t kActiveLandmarks = 4;
+  // Absorbs float rounding in the stored tables.
+  inline static constexpr double kLandmarkSlackM = 0.1;
+
+  TravelTimeBound(const NodesView& nodesViewIn,
+                  const LandmarksView* landmarksIn, std::uint32_t anchorIdx,
+                  std::uint32_t otherEndIdx, Anchor role,
+                  const AStarParams& params)
+      : nodesView(nodesViewIn),
+        landmarks(landmarksIn),
+        secondsPerMeter(fastestSecondsPerMeter(params)),
+        sign(role == Anchor::Target ? 1.0 : -1.0),
+        anchorX(nodesView.xM[anchorIdx]),
+        anchorY(nodesView.yM[anchorIdx])
+  {
+    if (landmarks && landmarks->numLandmarks > 0)
+      pickLandmarks(anchorIdx, otherEndIdx);
+  }
+
+  // Bound for v -> any point within radiusM of (x, y) that is entered
+  // through one of anchorNodes (the targets of aStarSnapped lie inside
+  // edges and are reached through their tails). Each landmark term uses
+  // the weakest anchor values, so it bounds the distance to the nearest
+  // anchor at the cost of a single one.
+  TravelTimeBound(const NodesView& nodesViewIn,
+                  const LandmarksView* landmarksIn, double x, double y,
+                  double radiusMIn,
+                  const std::vector<std::uint32_t>& anchorNodes,
+                  std::uint32_t otherEndIdx, const AStarParams& params)
+      : nodesView(nodesViewIn),
+        landmarks(landmarksIn),
+        secondsPerMeter(fastestSecondsPerMeter(params)),
+        sign(1.0),
+        anchorX(static_cast<float>(x)),
+        anchorY(static_cast<float>(y)),
+        radiusM(radiusMIn)
+  {
+    if (!landmarks || landmarks->numLandmarks == 0 || anchorNodes.empty())
+      return;
+    pickLandmarks(anchorNodes.front(), otherEndIdx);
+    for (std::uint32_t anchorIdx : anchorNodes)
+    {
+      const std::size_t row =
+          std::size_t(anchorIdx) * landmarks->numLandmarks;
+      for (std::uint32_t slot{0}; slot < numActive; ++slot)
+      {
+        anchorFrom[slot] = std::min(
+            anchorFrom[slot],
+            double(landmarks->fromLandmark[row + active[slot]]));
+        anchorTo[slot] = std::max(
+            anchorTo[slot], double(landmarks->toLandmark[row + active[slot]]));
+      }
+    }
+  }
+
+  double operator()(std::uint32_t nodeIdx) const
+  {
+    const float dx = nodesView.xM[nodeIdx] - anchorX;
+    const float dy = nodesView.yM[nodeIdx] - anchorY;
+    double meters = std::max(0.0, std::sqrt(dx * dx + dy * dy) - radiusM);
+    if (numActive > 0)
+      meters = std::max(meters, landmarkMeters(nodeIdx) - kLandmarkSlackM);
+    return meters * secondsPerMeter;
+  }
+
+ private:
+  // Triangle bounds of one landmark for (node, anchor) in the anchor's
+  // direction. A pair with an unreachable side gives no information.
+  double landmarkTerm(double anchorFromM, double anchorToM, float nodeFromM,
+                      float nodeToM) const
+  {
+    double best = 0.0;
+    const double viaTo = sign * (double(nodeToM) - anchorToM);
+    const double viaFrom = sign * (anchorFromM - double(nodeFromM));
+    if (std::isfinite(viaTo)) best = std::max(best, viaTo);
+    if (std::isfinite(viaFrom)) best = std::max(best, viaFrom);
+    return best;
+  }
+
+  double landmarkMeters(std::uint32_t nodeIdx) const
+  {
+    const std::size_t row = std::size_t(nodeIdx) * landmarks->numLandmarks;
+    double best = 0.0;
+    for (std::uint32_t slot{0}; slot < numActive; ++slot)
+    {
+      const std::size_t at = row + active[slot];
+      best = std::max(best, landmarkTerm(anchorFrom[slot], anchorTo[slot],
+                                         landmarks->fromLandmark[at],
+                                         landmarks->toLandmark[at]));
+    }
+    return best;
+  }
+
+  // Keep the kActiveLandmarks with the largest bound between the endpoints
+  void pickLandmarks(std::uint32_t anchorIdx, std::uint32_t otherEndIdx)
+  {
+    const std::uint32_t numLandmarks = landmarks->numLandmarks;
+    const std::size_t anchorRow = std::size_t(anchorIdx) * numLandmarks;
+    const std::size_t otherRow = std::size_t(otherEndIdx) * numLandmarks;
+
+    std::array<double, kActiveLandmarks> score{};
+    for (std::uint32_t i{0}; i < numLandmarks; ++i)
+    {
+      const double fromM = landmarks->fromLandmark[anchorRow + i];
+      const double toM = landmarks->toLandmark[anchorRow + i];
+      const double value =
+          landmarkTerm(fromM, toM, landmarks->fromLandmark[otherRow + i],
+                       landmarks->toLandmark[otherRow + i]);
+
+      std::uint32_t slot = numActive;
+      if (numActive < kActiveLandmarks)
+      {
+        ++numActive;
+      }
+      else
+      {
+        slot = static_cast<std::uint32_t>(
+            std::min_element(score.begin(), score.end()) - score.begin());
+        if (value <= score[slot]) continue;
+      }
+      score[slot] = value;
+      active[slot] = i;
+      anchorFrom[slot] = fromM;
+      anchorTo[slot] = toM;
+    }
+  }
+
+  const NodesView& nodesView;
+  const LandmarksView* landmarks;
+  double secondsPerMeter;
+  double sign;
+  float anchorX;
+  float anchorY;
+  double radiusM{0.0};
+
+  std::uint32_t numActive{0};
+  std::array<std::uint32_t, kActiveLandmarks> active{};
+  std::array<double, kActiveLandmarks> anchorFrom{};  // d(landmark -> anchor)
+  std::array<double, kActiveLandmarks> anchorTo{};    // d(anchor -> landmark)
+};
+
+// Wall time between laps in milliseconds, for SearchStats. Reads no clock
+// unless kSearchStats.
+class PhaseTimer
+{
+ public:
+  PhaseTimer()
+  {
+    if constexpr (kSearchStats) last = Clock::now();
+  }
+
+  void lap(double& ms)
+  {
+    if constexpr (kSearchStats)
+    {
+      const Clock::time_point now = Clock::now();
+      ms = std::chrono::duration<double, std::milli>(now - last).count();
+      last = now;
+    }
+  }
+
+ private:
+  using Clock = std::chrono::steady_clock;
+  Clock::time_point last;
+};
+
+// Add meters travelled with one step label to the result's aggregates.
+inline void addStepDistance(AStarResult& result, double len,
+                            std::uint8_t stepLabel)
+{
+  result.distanceM += len;
+
+  switch (stepLabel)
+  {
+    case MODE_FOOT:
+      result.distanceWalk += len;
+      break;
+    case MODE_BIKE_PREFERRED:
+      result.distanceBikePreferred += len;
+      break;
+    case MODE_BIKE_NON_PREFERRED:
+      result.distanceBikeNonPreferred += len;
+      break;
+  }
+}
+
+// Append one traversed edge to the result path and its aggregates.
+inline void appendStep(AStarResult& result, const EdgesView& edgesView,
+                       std::uint32_t edgeIdx, std::uint8_t stepLabel,
+                       std::uint32_t toNode)
+{
+  addStepDistance(result,
+                  static_cast<double>(edgesView.lengthsMeters[edgeIdx]),
+                  stepLabel);
+  result.pathModes.push_back(stepLabel);  // keep exact label (preferred
+                                          // / non-preferred / walk)
+  result.pathNodes.push_back(toNode);
+}
+
+// Profile checks shared by every search entry point.
+inline void validateParams(const AStarParams& params)
+{
+  // Validate speeds
+  if (!(std::isfinite(params.bikeSpeedMps) && params.bikeSpeedMps > 0.0) ||
+      !(std::isfinite(params.walkSpeedMps) && params.walkSpeedMps > 0.0))
+    throw std::invalid_argument(
+        "bikeSpeedMps and walkSpeedMps must be finite and > 0");
+}
+
+// Shared argument checks for every node-to-node entry point.
+inline void validateQuery(const EdgesView& edgesView, std::uint32_t sourceIdx,
+                          std::uint32_t targetIdx, const AStarParams& params)
+{
+  const std::uint32_t numNodes = edgesView.numNodes;
+  if (sourceIdx >= numNodes || targetIdx >= numNodes)
+    throw std::runtime_error("source/target out of range");
+  validateParams(params);
+}
+
+// Shared argument checks for the snapped (point-to-point) entry points:
+// edges in range, offsets in [0, 1], at most one point per edge and side.
+inline void validateSnappedQuery(const EdgesView& edgesView,
+                                 const std::vector<EdgePoint>& sources,
+                                 const std::vector<EdgePoint>& targets,
+                                 const AStarParams& params)
+{
+  validateParams(params);
+  if (sources.empty() || targets.empty())
+    throw std::runtime_error("snapped query needs sources and targets");
+  auto validate = [&](const std::vector<EdgePoint>& points) {
+    std::vector<std::uint32_t> edgeIds;
+    for (const EdgePoint& point : points)
+    {
+      if (point.edgeIdx >= edgesView.numEdges)
+        throw std::runtime_error("snapped edge out of range");
+      if (!(point.offset >= 0.0 && point.offset <= 1.0))
+        throw std::runtime_error("snapped offset must be in [0, 1]");
+      edgeIds.push_back(point.edgeIdx);
+    }
+    std::sort(edgeIds.begin(), edgeIds.end());
+    if (std::adjacent_find(edgeIds.begin(), edgeIds.end()) != edgeIds.end())
+      throw std::runtime_error("one snapped point per edge and side");
+  };
+  validate(sources);
+  validate(targets);
+}
+
+// Call fn(edges) with the SoaEdges or PackedEdges reader for the query.
+template <class Fn>
+auto withEdgeLayout(const EdgesView& edgesView, EdgeLayout layout, Fn&& fn)
+{
+  if (layout == EdgeLayout::Packed && !edgesView.packed)
+    throw std::runtime_error("edgeLayout packed: graph has no packed edges");
+
+  if (layout != EdgeLayout::Soa && edgesView.packed)
+    return fn(PackedEdges(edgesView));
+  return fn(SoaEdges(edgesView));
+}
+
+// Resolve StateStorage::Auto from the straight-line s-t distance.
+inline StateStorage resolveStorage(const NodesView& nodesView,
+                                   std::uint32_t sourceIdx,
+                                   std::uint32_t targetIdx,
+                                   const SearchOptions& options)
+{
+  if (options.storage != StateStorage::Auto) return options.storage;
+
+  const double crowMeters =
+      std::hypot(nodesView.xM[targetIdx] - nodesView.xM[sourceIdx],
+                 nodesView.yM[targetIdx] - nodesView.yM[sourceIdx]);
+  return crowMeters <= options.sparseMaxMeters ? StateStorage::Sparse
+                                               : StateStorage::Dense;
+}
+
+// Instantiate fn(forwardStates, forwardQueue, backwardStates, backwardQueue)
+// for the selected store and queue policy. Forward-only searches ignore the
+// backward pair (it is never reset, so it allocates nothing).
+template <class Fn>
+auto withSearchPolicies(SearchWorkspace& workspace, StateStorage storage,
+                        QueuePolicy queue, Fn&& fn)
+{
+  auto withQueue = [&](auto& forwardStates, auto& backwardStates) {
+    switch (queue)
+    {
+      case QueuePolicy::Binary:
+        return fn(forwardStates, workspace.forward.binaryHeap, backwardStates,
+                  workspace.backward.binaryHeap);
+      case QueuePolicy::Radix:
+        return fn(forwardStates, workspace.forward.radixHeap, backwardStates,
+                  workspace.backward.radixHeap);
+      case QueuePolicy::Dary4:
+      default:
+        return fn(forwardStates, workspace.forward.daryHeap, backwardStates,
+                  workspace.backward.daryHeap);
+    }
+  };
+
+  if (storage == StateStorage::Sparse)
+    return withQueue(workspace.forward.sparse, workspace.backward.sparse);
+  return withQueue(workspace.forward.dense, workspace.backward.dense);
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+// ---------------- Per-query search state ----------------
+
+// One label per (node, layer) state. Kept as a single record so a relaxation
+// touches one cache line instead of seven parallel arrays.
+struct SearchState
+{
+  inline static constexpr std::uint32_t kNotInHeap{UINT32_MAX};
+
+  double gCost{std::numeric_limits<double>::infinity()};
+  double gTime{std::numeric_limits<double>::infinity()};  // actual time
+  std::uint32_t parent{UINT32_MAX};      // parent state key
+  std::uint32_t parentEdge{UINT32_MAX};  // UINT32_MAX => mode switch
+  std::uint32_t heapPos{kNotInHeap};     // slot in an indexed heap
+  std::uint8_t parentMode{0};            // OUTPUT step label
+  std::uint8_t closed{0};
+};
+static_assert(sizeof(SearchState) == 32, "SearchState should stay 32 bytes");
+
+enum class StateStorage : std::uint8_t
+{
+  Auto = 0,   // pick per query from the straight-line s-t distance
+  Dense = 1,  // 2 * numNodes records, reset by generation stamp
+  Sparse = 2  // hash-backed, sized by touched states only
+};
+
+// Dense storage: records for every state, allocated once per thread.
+// A record is valid only if its stamp matches the current generation, so a
+// reset is a counter bump instead of a 2 * numNodes fill.
+class DenseStateStore
+{
+ public:
+  void reset(std::uint32_t numStates)
+  {
+    if (states.size() != numStates)
+    {
+      states.assign(numStates, SearchState{});
+      stamps.assign(numStates, 0);
+      generation = 0;
+    }
+    if (++generation == 0)
+    {
+      // Wrapped: old stamps could alias the new generation.
+      std::fill(stamps.begin(), stamps.end(), 0);
+      generation = 1;
+    }
+  }
+
+  SearchState& at(std::uint32_t key)
+  {
+    if (stamps[key] != generation)
+    {
+      stamps[key] = generation;
+      states[key] = SearchState{};
+    }
+    return states[key];
+  }
+
+  // Label cost without touching the record (INF if not reached).
+  double costOf(std::uint32_t key) const
+  {
+    return stamps[key] == generation
+               ? states[key].gCost
+               : std::numeric_limits<double>::infinity();
+  }
+
+ private:
+  std::vector<SearchState> states;
+  std::vector<std::uint32_t> stamps;
+  std::uint32_t generation{0};
+};
+
+// Sparse storage: only states the search actually reaches. Cheaper than the
+// dense arrays for short trips where a few thousand states are touched and
+// the dense records would be spread over many pages.
+class SparseStateStore
+{
+ public:
+  void reset(std::uint32_t /*numStates*/)
+  {
+    // clear() keeps the bucket array, so steady-state queries do not allocate
+    // buckets again.
+    states.clear();
+  }
+
+  // References stay valid across rehashing (node-based container).
+  SearchState& at(std::uint32_t key) { return states[key]; }
+
+  double costOf(std::uint32_t key) const
+  {
+    const auto it = states.find(key);
+    return it == states.end() ? std::numeric_limits<double>::infinity()
+                              : it->second.gCost;
+  }
+
+ private:
+  std::unordered_map<std::uint32_t, SearchState> states;
+};
@@ -1,5 +1,7 @@
 const env = {
   PORT: Number(process.env.PORT || 3000),
   NODE_ENV: process.env.NODE_ENV || "development",
+  // upper bound on one findPath search, queue wait included
+  ROUTE_DEADLINE_MS: Number(process.env.ROUTE_DEADLINE_MS || 10000),
 };
 module.exports = { env };
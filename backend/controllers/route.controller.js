@@ -11,6 +11,7 @@ const {
   sanitizeFactors,
 } = require("../lib/numbers");
 const { findPathAsync } = require("../services/route.service");
+const { env } = require("../config/env");
 
 const defaults = {
   bikeSurfaceMask: 0xffff,
@@ -44,6 +45,12 @@ async function createRoute(req, res) {
     bikeSurfaceFactor,
     walkSurfaceFactor,
     surfacePenaltySPerKm,
+    simplify,
+    toleranceM,
+    polyline,
+    fullPath,
+    startPoint,
+    endPoint,
   } = req.body || {};
 
   const s = toIndex(startIdx);
@@ -77,8 +84,25 @@ async function createRoute(req, res) {
       surfacePenaltySPerKm,
       defaults.surfacePenaltySPerKm
     ),
+    deadlineMs: env.ROUTE_DEADLINE_MS,
   };
 
+  // optional output geometry: simplified in the addon, coords or polyline
+  if (["none", "douglas-peucker", "visvalingam"].includes(simplify))
+    opts.simplify = simplify;
+  if (Number.isFinite(toleranceM) && toleranceM >= 0)
+    opts.toleranceM = toleranceM;
+  if (polyline === 5 || polyline === 6) opts.polyline = polyline;
+  if (fullPath === true) opts.fullPath = true;
+
+  // optional clicked points: the addon snaps them to the nearest edges and
+  // routes from inside those; startIdx/endIdx stay the fallback
+  const isPoint = (p) => Number.isFinite(p?.lat) && Number.isFinite(p?.lon);
+  if (isPoint(startPoint) && isPoint(endPoint)) {
+    opts.sourcePoint = { lat: startPoint.lat, lon: startPoint.lon };
+    opts.targetPoint = { lat: endPoint.lat, lon: endPoint.lon };
+  }
+
   const bs = sanitizeFactors(bikeSurfaceFactor);
   const ws = sanitizeFactors(walkSurfaceFactor);
   if (bs) opts.bikeSurfaceFactor = bs;
@@ -87,11 +111,21 @@ async function createRoute(req, res) {
   const router = getRouter();
   const { LAT, LON } = getTypedArrays();
 
-  try {
-    const result = await findPathAsync(router, opts);
+  // stop the search if the client goes away before the answer
+  const abort = new AbortController();
+  res.on("close", () => {
+    if (!res.writableFinished) abort.abort();
+  });
 
-    const pathIdx = Array.isArray(result.path) ? result.path : [];
-    const modes = Array.isArray(result.modes) ? result.modes : [];
+  try {
+    const result = await findPathAsync(router, opts, abort.signal);
+
+    // path (Uint32Array), modes (Uint8Array) and coords (Float32Array,
+    // lat/lon interleaved) or polyline come from the addon; JSON wants
+    // plain arrays. They cover graph nodes only: snapped route ends come
+    // as sourceSnap/targetSnap ({ edgeIdx, offset, lat, lon, mode }).
+    const pathIdx = result.path ? Array.from(result.path) : [];
+    const modes = result.modes ? Array.from(result.modes) : [];
     const {
       distanceM,
       durationS,
@@ -100,36 +134,27 @@ async function createRoute(req, res) {
       distanceWalk,
     } = result;
 
-    let coords = [];
-    if (LAT && LON && pathIdx.length) {
-      coords = new Array(pathIdx.length);
-      for (let i = 0; i < pathIdx.length; ++i) {
-        const idx = pathIdx[i] >>> 0;
-        if (idx >= TOTAL_NODES) {
-          coords = [];
-          break;
-        }
-        coords[i] = [LAT[idx], LON[idx]];
-      }
-    }
-    if (!coords.length && pathIdx.length) {
-      try {
-        coords = pathIdx.map((idx) => {
-          const n = router.getNode(idx);
-          return [n.lat, n.lon];
-        });
-      } catch (e2) {
-        console.warn("coord fallback failed:", e2);
-        coords = [];
+    const geometry = {};
+    if (typeof result.polyline === "string") {
+      geometry.polyline = result.polyline;
+    } else {
+      const flat = result.coords;
+      const coords = new Array(flat.length / 2);
+      for (let i = 0; i < coords.length; ++i) {
+        coords[i] = [flat[2 * i], flat[2 * i + 1]];
       }
+      geometry.coords = coords;
     }
+    if (result.fullPath) geometry.fullPath = Array.from(result.fullPath);
+    if (result.sourceSnap) geometry.sourceSnap = result.sourceSnap;
+    if (result.targetSnap) geometry.targetSnap = result.targetSnap;
 
     const startCoord = LAT && LON ? [LAT[s], LON[s]] : undefined;
     const endCoord = LAT && LON ? [LAT[e], LON[e]] : undefined;
 
     return res.json({
       path: pathIdx,
-      coords,
+      ...geometry,
       modes,
       distanceM,
       durationS,
@@ -140,6 +165,15 @@ async function createRoute(req, res) {
       endCoord,
     });
   } catch (err) {
+    // routing pool shed the request; the client may retry shortly
+    if (String(err).includes("route queue full")) {
+      res.set("Retry-After", "1");
+      return res.status(503).json({ error: "route queue full" });
+    }
+    if (String(err).includes("search cancelled")) return; // client gone
+    if (String(err).includes("search deadline exceeded")) {
+      return res.status(504).json({ error: "route search timed out" });
+    }
     console.error("findPath error:", err);
 
     // OSM debug links
@@ -1,8 +1,13 @@
-function findPathAsync(router, opts) {
+// signal (optional AbortSignal) cancels the native search when aborted
+function findPathAsync(router, opts, signal) {
   return new Promise((resolve, reject) => {
-    router.findPath(opts, (err, result) =>
-      err ? reject(err) : resolve(result)
-    );
+    if (signal?.aborted) return reject(new Error("search cancelled"));
+    const onAbort = () => handle.cancel();
+    const handle = router.findPath(opts, (err, result) => {
+      signal?.removeEventListener("abort", onAbort);
+      err ? reject(err) : resolve(result);
+    });
+    signal?.addEventListener("abort", onAbort, { once: true });
   });
 }
 
@@ -3,14 +3,25 @@ import { API } from "./http";
 /** Snap a lat/lon to the nearest graph node. */
 export async function snapToGraph(lat, lon) {
   const { data } = await API.get("/snap", { params: { lat, lon } });
-  return data; // { idx, lat, lon }
+  return { ...data, query: { lat, lon } }; // { idx, lat, lon, query }
 }
 
-/** Request a route between node indices. */
-export async function getRoute({ startIdx, endIdx, options = {} }) {
+/**
+ * Request a route between node indices. With startPoint/endPoint (the
+ * clicked { lat, lon }) the route starts and ends on the nearest streets.
+ */
+export async function getRoute({
+  startIdx,
+  endIdx,
+  startPoint,
+  endPoint,
+  options = {},
+}) {
   const { data } = await API.post("/route", {
     startIdx,
     endIdx,
+    startPoint,
+    endPoint,
     ...options, // { bikeSurfaceMask, speeds, penalties, factors... }
   });
   return data; // { path, coords, modes, distanceM, durationS, ... }
@@ -53,15 +53,28 @@ export function RouteProvider({ children }) {
       const payload = {
         startIdx: snappedStart.idx,
         endIdx: snappedEnd.idx,
+        startPoint: snappedStart.query,
+        endPoint: snappedEnd.query,
         options: { bikeSurfaceMask: mask, surfacePenaltySPerKm: penalty },
       };
 
       try {
         setRouteLoading(true);
         const result = await backend.getRoute(payload);
-        const coords = result?.coords ?? [];
+        // snapped ends: one partial step before and after the node line
+        const coords = [...(result?.coords ?? [])];
+        const modes = [...(result?.modes ?? [])];
+        const { sourceSnap, targetSnap } = result ?? {};
+        if (sourceSnap) {
+          coords.unshift([sourceSnap.lat, sourceSnap.lon]);
+          if (coords.length > 1) modes.unshift(sourceSnap.mode);
+        }
+        if (targetSnap) {
+          coords.push([targetSnap.lat, targetSnap.lon]);
+          if (coords.length > 1) modes.push(targetSnap.mode);
+        }
         setRouteCoords(coords);
-        setRouteModes(result?.modes ?? []);
+        setRouteModes(modes);
         setTotals({
           totalDistanceM: result?.distanceM ?? 0,
           totalDurationS: result?.durationS ?? 0,
@@ -80,7 +93,14 @@ export function RouteProvider({ children }) {
       }
     },
     // eslint-disable-next-line react-hooks/exhaustive-deps
-    [snappedStart?.idx, snappedEnd?.idx, appliedMask, appliedPenalty]
+    [
+      snappedStart?.idx,
+      snappedEnd?.idx,
+      snappedStart?.query,
+      snappedEnd?.query,
+      appliedMask,
+      appliedPenalty,
+    ]
   );
 
   useEffect(() => {
@@ -44,7 +44,9 @@ mkdir -p "${RAW_DIR}" "${DATA_DIR}"
 # ────────────────────────────── CLEAN ───────────────────────────────
 echo "▶ Cleaning previous build and blobs..."
 rm -rf "${BUILD_DIR}"
-rm -f "${DATA_DIR}/graph_nodes.bin" "${DATA_DIR}/graph_edges.bin"
+rm -f "${DATA_DIR}/graph_nodes.bin" "${DATA_DIR}/graph_edges.bin" \
+  "${DATA_DIR}/graph_landmarks.bin" "${DATA_DIR}/graph_cch.bin" \
+  "${DATA_DIR}/graph_spatial.bin"
 echo "✔ Clean complete."
 
 # ────────────────────────────── BUILD ───────────────────────────────
@@ -93,6 +95,27 @@ pushd "${BUILD_DIR}" >/dev/null
 popd >/dev/null
 echo "✔ Graph built to ${DATA_DIR}"
 
+# ───────────────────── RUN buildLandmarks ───────────────────────────
+echo "▶ Computing landmark tables (${NUM_LANDMARKS:-16} landmarks)"
+pushd "${BUILD_DIR}" >/dev/null
+./buildLandmarks "${NUM_LANDMARKS:-16}" "${DATA_DIR}"
+popd >/dev/null
+echo "✔ Landmarks written to ${DATA_DIR}"
+
+# ──────────────────────── RUN buildCch ──────────────────────────────
+echo "▶ Building contraction hierarchy (nested dissection order)"
+pushd "${BUILD_DIR}" >/dev/null
+./buildCch "${DATA_DIR}"
+popd >/dev/null
+echo "✔ CCH written to ${DATA_DIR}"
+
+# ─────────────────────── RUN buildSpatial ───────────────────────────
+echo "▶ Building spatial index (KD-tree for kd_snap)"
+pushd "${BUILD_DIR}" >/dev/null
+./buildSpatial "${DATA_DIR}"
+popd >/dev/null
+echo "✔ Spatial index written to ${DATA_DIR}"
+
 # ─────────────────────────── SUMMARY ────────────────────────────────
 echo "▶ Output sizes:"
 du -h "${DATA_DIR}/graph_"* | sort -h || true
@@ -0,0 +1,467 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "aStar.hpp"
+#include "graphLoader.hpp"
+#include "utils.hpp"
+
+// Routing benchmark without Node: the addon's loaders and aStarTwoLayer on
+// reproducible origin-destination pairs, single- and multi-threaded.
+// Progress goes to stderr, the report (JSON) to stdout.
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+struct Config
+{
+  std::string dataDir{"../../backend/data"};
+  std::string pairSource{"random"};  // random | stratified | <file>
+  uint32_t numPairs{1000};
+  uint32_t seed{1};
+  std::vector<unsigned> threadCounts;  // default: 1 and hardware
+  std::string cacheMode{"both"};       // warm | cold | both
+  uint32_t evictMb{64};
+  SearchDirection direction{SearchDirection::Forward};
+  bool useLandmarks{true};
+};
+
+struct OdPair
+{
+  uint32_t sourceIdx;
+  uint32_t targetIdx;
+  uint32_t stratum;  // distance band (stratified), else 0
+};
+
+// Straight-line distance bands of the stratified mode, in meters
+const std::vector<double> kStrataM{0.0, 2000.0, 5000.0, 10000.0, 20000.0};
+
+uint32_t stratumOf(double meters)
+{
+  uint32_t s = 0;
+  while (s + 1 < kStrataM.size() && meters >= kStrataM[s + 1]) ++s;
+  return s;
+}
+
+double straightMeters(const NodesView& nodes, uint32_t a, uint32_t b)
+{
+  return utils::haversineMeters(nodes.lat_f32[a], nodes.lon_f32[a],
+                                nodes.lat_f32[b], nodes.lon_f32[b]);
+}
+
+std::vector<OdPair> randomPairs(const NodesView& nodes, const Config& config)
+{
+  std::mt19937 rng(config.seed);
+  std::uniform_int_distribution<uint32_t> pick(0, nodes.numNodes - 1);
+  std::vector<OdPair> pairs(config.numPairs);
+  for (OdPair& pair : pairs) pair = {pick(rng), pick(rng), 0};
+  return pairs;
+}
+
+// Equal numbers of pairs per distance band. Long bands may be rare on a
+// small graph: sampling gives up after a fixed number of tries.
+std::vector<OdPair> stratifiedPairs(const NodesView& nodes,
+                                    const Config& config)
+{
+  const uint32_t numStrata = static_cast<uint32_t>(kStrataM.size());
+  const uint32_t perStratum = (config.numPairs + numStrata - 1) / numStrata;
+  std::mt19937 rng(config.seed);
+  std::uniform_int_distribution<uint32_t> pick(0, nodes.numNodes - 1);
+
+  std::vector<std::vector<OdPair>> strata(numStrata);
+  const uint64_t maxTries = uint64_t(config.numPairs) * 1000;
+  for (uint64_t tries{0}; tries < maxTries; ++tries)
+  {
+    const uint32_t s = pick(rng);
+    const uint32_t t = pick(rng);
+    const uint32_t stratum = stratumOf(straightMeters(nodes, s, t));
+    if (strata[stratum].size() < perStratum)
+      strata[stratum].push_back({s, t, stratum});
+
+    bool full = true;
+    for (const auto& list : strata) full &= list.size() >= perStratum;
+    if (full) break;
+  }
+
+  std::vector<OdPair> pairs;
+  for (const auto& list : strata)
+  {
+    if (list.size() < perStratum)
+      std::cerr << "stratum " << &list - strata.data() << ": only "
+                << list.size() << " pairs\n";
+    pairs.insert(pairs.end(), list.begin(), list.end());
+  }
+  return pairs;
+}
+
+uint32_t nearestNode(const NodesView& nodes, double lat, double lon)
+{
+  // Linear scan: run once per endpoint before timing starts
+  const double cosLat = std::cos(lat * 3.14159265358979323846 / 180.0);
+  uint32_t best = 0;
+  double bestD2 = std::numeric_limits<double>::infinity();
+  for (uint32_t i{0}; i < nodes.numNodes; ++i)
+  {
+    const double dLat = nodes.lat_f32[i] - lat;
+    const double dLon = (nodes.lon_f32[i] - lon) * cosLat;
+    const double d2 = dLat * dLat + dLon * dLon;
+    if (d2 < bestD2)
+    {
+      bestD2 = d2;
+      best = i;
+    }
+  }
+  return best;
+}
+
+// One pair per line: "lat lon lat lon" (spaces or commas); '#' comments
+std::vector<OdPair> filePairs(const NodesView& nodes, const std::string& path)
+{
+  std::ifstream in(path);
+  if (!in) throw std::runtime_error("cannot open pairs file " + path);
+
+  std::vector<OdPair> pairs;
+  std::string line;
+  while (std::getline(in, line))
+  {
+    if (line.empty() || line[0] == '#') continue;
+    std::replace(line.begin(), line.end(), ',', ' ');
+    std::istringstream fields(line);
+    double lat1, lon1, lat2, lon2;
+    if (!(fields >> lat1 >> lon1 >> lat2 >> lon2))
+      throw std::runtime_error("bad pairs line: " + line);
+    pairs.push_back({nearestNode(nodes, lat1, lon1),
+                     nearestNode(nodes, lat2, lon2), 0});
+  }
+  return pairs;
+}
+
+struct Sample
+{
+  double latencyMs;
+  double allocMs;  // cold: fresh workspace allocation, not in latencyMs
+  uint32_t settledStates;
+  bool success;
+};
+
+struct Run
+{
+  unsigned threads;
+  bool cold;
+  double wallS;
+  std::vector<Sample> samples;  // by pair index
+};
+
+// Streams a buffer larger than the last-level cache so the next query
+// starts without the previous one's labels and edges in cache.
+void evictCaches(std::vector<char>& buffer)
+{
+  volatile char sink = 0;
+  for (std::size_t i{0}; i < buffer.size(); i += 64)
+  {
+    buffer[i] = static_cast<char>(buffer[i] + 1);
+    sink = sink + buffer[i];
+  }
+}
+
+Run runPairs(const EdgesView& edges, const NodesView& nodes,
+             const std::vector<OdPair>& pairs, const AStarParams& params,
+             const SearchOptions& options, unsigned numThreads, bool cold,
+             uint32_t evictMb)
+{
+  Run run{numThreads, cold, 0.0, std::vector<Sample>(pairs.size())};
+  std::atomic<std::size_t> next{0};
+
+  auto worker = [&]() {
+    SearchWorkspace warmWorkspace;
+    std::vector<char> evictBuffer(cold ? std::size_t(evictMb) << 20 : 0);
+
+    for (std::size_t i = next++; i < pairs.size(); i = next++)
+    {
+      // Cold: a fresh workspace, as on a new thread, and caches flushed.
+      // Both happen before the clock starts: the dense labels are allocated
+      // and timed on their own, then evicted with everything else.
+      SearchWorkspace coldWorkspace;
+      double allocMs = 0.0;
+      if (cold)
+      {
+        const auto allocStart = Clock::now();
+        coldWorkspace.forward.dense.reset(2 * nodes.numNodes);
+        if (options.direction == SearchDirection::Bidirectional)
+          coldWorkspace.backward.dense.reset(2 * nodes.numNodes);
+        allocMs = std::chrono::duration<double, std::milli>(Clock::now() -
+                                                            allocStart)
+                      .count();
+        evictCaches(evictBuffer);
+      }
+      SearchWorkspace& workspace = cold ? coldWorkspace : warmWorkspace;
+
+      const auto start = Clock::now();
+      const AStarResult result =
+          aStarTwoLayer(edges, nodes, pairs[i].sourceIdx, pairs[i].targetIdx,
+                        params, workspace, options);
+      const auto stop = Clock::now();
+      run.samples[i] = {
+          std::chrono::duration<double, std::milli>(stop - start).count(),
+          allocMs, result.settledStates, result.success};
+    }
+  };
+
+  // Warm runs first route every pair once untimed (page cache, workspaces)
+  if (!cold)
+  {
+    SearchWorkspace workspace;
+    for (const OdPair& pair : pairs)
+      (void)aStarTwoLayer(edges, nodes, pair.sourceIdx, pair.targetIdx,
+                          params, workspace, options);
+  }
+
+  const auto start = Clock::now();
+  std::vector<std::thread> threads;
+  for (unsigned t{1}; t < numThreads; ++t) threads.emplace_back(worker);
+  worker();
+  for (std::thread& thread : threads) thread.join();
+  run.wallS = std::chrono::duration<double>(Clock::now() - start).count();
+  return run;
+}
+
+// Nearest-rank percentile of a sorted list
+template <class T>
+T percentile(const std::vector<T>& sorted, double p)
+{
+  if (sorted.empty()) return T{};
+  const std::size_t rank = static_cast<std::size_t>(
+      std::ceil(p / 100.0 * static_cast<double>(sorted.size())));
+  return sorted[std::min(sorted.size() - 1, rank == 0 ? 0 : rank - 1)];
+}
+
+template <class T>
+void writeDistribution(std::ostream& out, std::vector<T> values)
+{
+  std::sort(values.begin(), values.end());
+  double sum = 0.0;
+  for (const T& v : values) sum += static_cast<double>(v);
+  out << "{\"mean\": " << (values.empty() ? 0.0 : sum / values.size())
+      << ", \"p50\": " << percentile(values, 50.0)
+      << ", \"p90\": " << percentile(values, 90.0)
+      << ", \"p99\": " << percentile(values, 99.0)
+      << ", \"max\": " << (values.empty() ? T{} : values.back()) << "}";
+}
+
+void writeSummary(std::ostream& out, const std::vector<Sample>& samples,
+                  bool cold)
+{
+  std::vector<double> latency;
+  std::vector<double> alloc;
+  std::vector<uint32_t> settled;
+  std::size_t noRoute = 0;
+  for (const Sample& sample : samples)
+  {
+    latency.push_back(sample.latencyMs);
+    alloc.push_back(sample.allocMs);
+    settled.push_back(sample.settledStates);
+    if (!sample.success) ++noRoute;
+  }
+  out << "\"queries\": " << samples.size() << ", \"noRoute\": " << noRoute
+      << ", \"latencyMs\": ";
+  writeDistribution(out, latency);
+  if (cold)
+  {
+    out << ", \"workspaceAllocMs\": ";
+    writeDistribution(out, alloc);
+  }
+  out << ", \"settledStates\": ";
+  writeDistribution(out, settled);
+}
+
+void writeReport(std::ostream& out, const Config& config,
+                 const EdgesView& edges, const std::vector<OdPair>& pairs,
+                 const std::vector<Run>& runs)
+{
+  const bool stratified = config.pairSource == "stratified";
+  out << std::fixed << std::setprecision(3);
+  out << "{\n  \"numNodes\": " << edges.numNodes
+      << ",\n  \"numEdges\": " << edges.numEdges << ",\n  \"pairs\": \""
+      << config.pairSource << "\",\n  \"seed\": " << config.seed
+      << ",\n  \"direction\": \""
+      << (config.direction == SearchDirection::Bidirectional
+              ? "bidirectional"
+              : "forward")
+      << "\",\n  \"runs\": [";
+
+  for (std::size_t r{0}; r < runs.size(); ++r)
+  {
+    // Cold wall time also covers allocating workspaces and sweeping the
+    // eviction buffer, so cold throughput comes from the timed queries
+    // alone: each thread's share of the summed latencies.
+    const Run& run = runs[r];
+    double latencySumS = 0.0;
+    for (const Sample& sample : run.samples)
+      latencySumS += sample.latencyMs / 1000.0;
+    const double busyS = run.cold ? latencySumS / run.threads : run.wallS;
+    out << (r ? "," : "") << "\n    {\"threads\": " << run.threads
+        << ", \"cache\": \"" << (run.cold ? "cold" : "warm")
+        << "\", \"wallS\": " << run.wallS
+        << ", \"latencySumS\": " << latencySumS << ", \"queriesPerS\": "
+        << (busyS > 0.0 ? run.samples.size() / busyS : 0.0) << ", ";
+    writeSummary(out, run.samples, run.cold);
+
+    if (stratified)
+    {
+      out << ",\n     \"strata\": [";
+      for (uint32_t s{0}; s < kStrataM.size(); ++s)
+      {
+        std::vector<Sample> band;
+        for (std::size_t i{0}; i < pairs.size(); ++i)
+          if (pairs[i].stratum == s) band.push_back(run.samples[i]);
+        out << (s ? "," : "") << "\n       {\"fromM\": " << kStrataM[s]
+            << ", ";
+        writeSummary(out, band, run.cold);
+        out << "}";
+      }
+      out << "]";
+    }
+    out << "}";
+  }
+  out << "\n  ]\n}\n";
+}
+
+bool parseArgs(int argc, char* argv[], Config& config)
+{
+  for (int i{1}; i < argc; ++i)
+  {
+    const std::string arg = argv[i];
+    if (i + 1 >= argc) return false;
+    const std::string value = argv[++i];
+    if (arg == "--data")
+      config.dataDir = value;
+    else if (arg == "--pairs")
+      config.pairSource = value;
+    else if (arg == "--count")
+      config.numPairs = static_cast<uint32_t>(std::strtoul(value.c_str(),
+                                                           nullptr, 10));
+    else if (arg == "--seed")
+      config.seed = static_cast<uint32_t>(std::strtoul(value.c_str(),
+                                                       nullptr, 10));
+    else if (arg == "--threads")
+    {
+      std::istringstream list(value);
+      std::string item;
+      while (std::getline(list, item, ','))
+        config.threadCounts.push_back(static_cast<unsigned>(
+            std::max(1ul, std::strtoul(item.c_str(), nullptr, 10))));
+    }
+    else if (arg == "--cache")
+      config.cacheMode = value;
+    else if (arg == "--evict-mb")
+      config.evictMb = static_cast<uint32_t>(std::strtoul(value.c_str(),
+                                                          nullptr, 10));
+    else if (arg == "--direction")
+      config.direction = value == "bidirectional"
+                             ? SearchDirection::Bidirectional
+                             : SearchDirection::Forward;
+    else if (arg == "--landmarks")
+      config.useLandmarks = value != "off";
+    else
+      return false;
+  }
+  return config.numPairs > 0 &&
+         (config.cacheMode == "warm" || config.cacheMode == "cold" ||
+          config.cacheMode == "both");
+}
+}  // namespace
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Main: load bins → OD pairs → timed runs → JSON report
+// ─────────────────────────────────────────────────────────────────────────────
+int main(int argc, char* argv[])
+{
+  Config config;
+  if (!parseArgs(argc, argv, config))
+  {
+    std::cerr
+        << "Usage: benchRoute [--data dir] [--pairs random|stratified|<file>]"
+           "\n                  [--count 1000] [--seed 1] [--threads 1,8]"
+           "\n                  [--cache warm|cold|both] [--evict-mb 64]"
+           "\n                  [--direction forward|bidirectional]"
+           "\n                  [--landmarks on|off]\n"
+           "A pairs file has one \"lat lon lat lon\" per line, snapped to the"
+           " nearest nodes.\n";
+    return 1;
+  }
+  if (config.threadCounts.empty())
+  {
+    config.threadCounts.push_back(1);
+    const unsigned hardware = std::thread::hardware_concurrency();
+    if (hardware > 1) config.threadCounts.push_back(hardware);
+  }
+
+  try
+  {
+    const NodesView nodes = loadNodes(config.dataDir + "/graph_nodes.bin");
+    const EdgesView edges = loadEdges(config.dataDir + "/graph_edges.bin");
+    if (nodes.numNodes != edges.numNodes || nodes.numNodes == 0)
+      throw std::runtime_error("nodes/edges bins do not match");
+
+    LandmarksView landmarks;
+    SearchOptions options;
+    options.direction = config.direction;
+    if (config.useLandmarks)
+    {
+      try
+      {
+        landmarks =
+            loadLandmarks(config.dataDir + "/graph_landmarks.bin", edges);
+        options.landmarks = &landmarks;
+      } catch (const std::exception& e)
+      {
+        std::cerr << "no landmarks (" << e.what() << ")\n";
+      }
+    }
+
+    std::vector<OdPair> pairs;
+    if (config.pairSource == "random")
+      pairs = randomPairs(nodes, config);
+    else if (config.pairSource == "stratified")
+      pairs = stratifiedPairs(nodes, config);
+    else
+      pairs = filePairs(nodes, config.pairSource);
+    std::cerr << pairs.size() << " pairs\n";
+
+    const AStarParams params;  // the addon's defaults
+    std::vector<Run> runs;
+    for (const bool cold : {false, true})
+    {
+      if (config.cacheMode != "both" &&
+          config.cacheMode != (cold ? "cold" : "warm"))
+        continue;
+      for (const unsigned numThreads : config.threadCounts)
+      {
+        std::cerr << (cold ? "cold" : "warm") << ", " << numThreads
+                  << " thread(s)\n";
+        runs.push_back(runPairs(edges, nodes, pairs, params, options,
+                                numThreads, cold, config.evictMb));
+      }
+    }
+
+    writeReport(std::cout, config, edges, pairs, runs);
+  } catch (const std::exception& e)
+  {
+    std::cerr << "benchRoute failed: " << e.what() << "\n";
+    return 1;
+  }
+  return 0;
+}
@@ -20,7 +20,98 @@ struct EdgesHeader
   uint8_t hasSurfacePrimary;
   uint8_t hasModeMask;
   uint8_t lengthType;
-  uint8_t reserved{0};
+  uint8_t extraSections{0};  // EdgesSection bits (0 in older bins)
 };
 static_assert(sizeof(EdgesHeader) == 20, "EdgesHeader must be 20 bytes");
+
+// Optional blocks appended after modeMask[E]. Each one starts on an 8-byte
+// file offset so its arrays can be mapped in place.
+enum EdgesSection : uint8_t
+{
+  // u32 offsetsSize (N+1), u32 edgesSize (E),
+  // inOffsets[N+1], inSources[E], inEdgeIds[E]
+  EDGES_SECTION_REVERSE_CSR = 1u << 0,
+  // u32 numRecords (E), u32 reserved, PackedEdge records[E]
+  EDGES_SECTION_PACKED = 1u << 1
+};
+
+// One edge of the packed adjacency section: everything a relaxation reads
+// in a single 8-byte record instead of four arrays. The length stays a
+// float32, so packed and plain arrays give bit-identical costs.
+//   word = head node (26 bits) | surfacePrimary << 26 (4 bits)
+//          | modeMask << 30 (2 bits)
+struct PackedEdge
+{
+  uint32_t word;
+  float lengthMeters;
+};
+static_assert(sizeof(PackedEdge) == 8, "PackedEdge must be 8 bytes");
+
+inline constexpr uint32_t kPackedHeadMask = (1u << 26) - 1;
+inline constexpr uint32_t kPackedSurfaceShift = 26;
+inline constexpr uint32_t kPackedModeShift = 30;
+
+// graph_landmarks.bin: lower-bound distance tables for the ALT heuristic.
+// Layout after the header:
+//   landmarkNodes[K] (u32), zero padding to an 8-byte offset,
+//   fromLandmark[N*K] (f32 meters, node-major: d(landmark i -> v) at v*K+i),
+//   toLandmark[N*K]   (f32 meters, node-major: d(v -> landmark i) at v*K+i)
+// Unreachable pairs are +inf.
+struct LandmarksHeader
+{
+  char magic[8];  // "MMAPLMRK"
+  uint32_t numNodes;
+  uint32_t numEdges;  // of the edges bin the tables were computed on
+  uint32_t numLandmarks;
+  uint8_t distanceType;  // 0 = float32 meters over bike|foot edges
+  uint8_t reserved[3]{0, 0, 0};
+  uint64_t edgesChecksum;  // edgesChecksum() of those edges
+};
+static_assert(sizeof(LandmarksHeader) == 32,
+              "LandmarksHeader must be 32 bytes");
+
+// graph_cch.bin: metric-independent contraction order and chordal upward
+// graph for Customizable Contraction Hierarchies over the (node, layer)
+// state graph. State (v, layer) has rank 2 * nodeRank[v] + layer.
+// Layout after the header:
+//   nodeRank[N] (u32), firstOut[2N+1] (u32), head[M] (u32, higher rank,
+//   sorted per tail)
+struct CchHeader
+{
+  char magic[8];  // "MMAPCCHO"
+  uint32_t numNodes;
+  uint32_t numEdges;  // of the edges bin the order was computed on
+  uint32_t numArcs;
+  uint32_t reserved{0};
+};
+static_assert(sizeof(CchHeader) == 24, "CchHeader must be 24 bytes");
+
+// graph_spatial.bin: packed KD-tree over the node coordinates, for the
+// nearest-node lookup of kd_snap. Layout after the header:
+//   kdNodes[numNodes] (KdTreeNode, children before their parent)
+// nodesChecksum is nodesCoordChecksum of the lat/lon arrays the tree was
+// built on; a tree whose checksum no longer matches is stale.
+struct SpatialHeader
+{
+  char magic[8];      // "MMAPSPAT"
+  uint32_t version;   // kSpatialVersion
+  uint32_t numNodes;  // of the nodes bin the tree was built on
+  uint64_t nodesChecksum;
+  int32_t rootIndex;  // -1 for an empty tree
+  uint32_t reserved{0};
+};
+static_assert(sizeof(SpatialHeader) == 32, "SpatialHeader must be 32 bytes");
+
+// Bumped whenever the tree layout or its split rule changes
+inline constexpr uint32_t kSpatialVersion = 1;
+
+struct KdTreeNode
+{
+  uint32_t pointIndex;  // index into lat[N], lon[N]
+  int32_t leftChild;    // -1 if none
+  int32_t rightChild;   // -1 if none
+  uint8_t splitAxis;    // 0 = latitude, 1 = longitude
+  uint8_t reserved[3]{0, 0, 0};
+};
+static_assert(sizeof(KdTreeNode) == 16, "KdTreeNode must be 16 bytes");
 }
@@ -0,0 +1,393 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "graphLoader.hpp"
+#include "writeBins.hpp"
+
+using namespace ingest;
+
+namespace
+{
+// Undirected node adjacency over every bike or foot edge (CSR).
+struct Adjacency
+{
+  std::vector<uint32_t> offsets;
+  std::vector<uint32_t> neighbors;
+};
+
+Adjacency undirectedAdjacency(const EdgesView& edgesView)
+{
+  const uint32_t numNodes = edgesView.numNodes;
+  std::vector<std::vector<uint32_t>> lists(numNodes);
+  for (uint32_t u{0}; u < numNodes; ++u)
+  {
+    for (uint32_t e{edgesView.offsets[u]}; e < edgesView.offsets[u + 1]; ++e)
+    {
+      const uint32_t v = edgesView.neighbors[e];
+      if (u == v || (edgesView.modeMask[e] & 0x3) == 0) continue;
+      lists[u].push_back(v);
+      lists[v].push_back(u);
+    }
+  }
+
+  Adjacency adjacency;
+  adjacency.offsets.assign(numNodes + 1, 0);
+  for (uint32_t u{0}; u < numNodes; ++u)
+  {
+    auto& list = lists[u];
+    std::sort(list.begin(), list.end());
+    list.erase(std::unique(list.begin(), list.end()), list.end());
+    adjacency.offsets[u + 1] =
+        adjacency.offsets[u] + static_cast<uint32_t>(list.size());
+  }
+  adjacency.neighbors.reserve(adjacency.offsets.back());
+  for (auto& list : lists)
+  {
+    adjacency.neighbors.insert(adjacency.neighbors.end(), list.begin(),
+                               list.end());
+    std::vector<uint32_t>().swap(list);
+  }
+  return adjacency;
+}
+
+// Nested dissection with inertial-flow separators: project a cell onto a
+// few directions, treat the first and last quarter along each as source
+// and sink, and take the minimum vertex cut between them (unit-capacity
+// max-flow on the split-node graph). The smallest cut wins; it follows
+// bridges and narrow passages instead of a straight line. Both halves are
+// ordered recursively and the separator is ranked above them. The order
+// depends only on the graph's shape, never on a metric.
+class NestedDissection
+{
+ public:
+  NestedDissection(const NodesView& nodesView, const Adjacency& adjacencyIn)
+      : adjacency(adjacencyIn), x(nodesView.numNodes), y(nodesView.numNodes),
+        localId(nodesView.numNodes, UINT32_MAX)
+  {
+    double sumLat = 0.0;
+    for (uint32_t i{0}; i < nodesView.numNodes; ++i)
+      sumLat += nodesView.lat_f32[i];
+    const double kDegToRad = 3.14159265358979323846 / 180.0;
+    const double cosLat =
+        std::cos(sumLat / std::max<uint32_t>(1, nodesView.numNodes) *
+                 kDegToRad);
+    for (uint32_t i{0}; i < nodesView.numNodes; ++i)
+    {
+      x[i] = nodesView.lon_f32[i] * cosLat;
+      y[i] = nodesView.lat_f32[i];
+    }
+  }
+
+  // Node ids from lowest to highest rank
+  std::vector<uint32_t> run()
+  {
+    std::vector<uint32_t> cell(x.size());
+    for (uint32_t i{0}; i < cell.size(); ++i) cell[i] = i;
+    order.clear();
+    order.reserve(cell.size());
+    dissect(cell);
+    return std::move(order);
+  }
+
+ private:
+  static constexpr size_t kLeafSize = 8;
+  static constexpr double kTerminalFraction = 0.25;
+  static constexpr uint32_t kUnlimited = UINT32_MAX / 2;
+
+  struct Cut
+  {
+    std::vector<uint32_t> left, right, separator;
+  };
+
+  // Residual graph of one cell: node 2i = in(i), 2i+1 = out(i), then the
+  // super source and sink.
+  struct FlowGraph
+  {
+    std::vector<uint32_t> first;  // per node, CSR over arcs
+    std::vector<uint32_t> to;
+    std::vector<uint32_t> capacity;
+    std::vector<uint32_t> reverse;
+  };
+
+  void buildFlowGraph(const std::vector<uint32_t>& cell,
+                      const std::vector<uint32_t>& byKey, FlowGraph& graph)
+  {
+    const uint32_t n = static_cast<uint32_t>(cell.size());
+    const uint32_t source = 2 * n;
+    const uint32_t sink = 2 * n + 1;
+    const uint32_t terminals =
+        std::max<uint32_t>(1, static_cast<uint32_t>(kTerminalFraction * n));
+
+    std::vector<std::pair<uint32_t, uint32_t>> arcs;  // (from, to) + cap
+    std::vector<uint32_t> caps;
+    auto add = [&](uint32_t from, uint32_t to, uint32_t cap) {
+      arcs.push_back({from, to});
+      caps.push_back(cap);
+    };
+    for (uint32_t i{0}; i < n; ++i)
+    {
+      add(2 * i, 2 * i + 1, 1);
+      const uint32_t v = cell[i];
+      for (uint32_t k{adjacency.offsets[v]}; k < adjacency.offsets[v + 1]; ++k)
+      {
+        const uint32_t j = localId[adjacency.neighbors[k]];
+        if (j != UINT32_MAX) add(2 * i + 1, 2 * j, kUnlimited);
+      }
+    }
+    for (uint32_t r{0}; r < terminals; ++r)
+    {
+      add(source, 2 * byKey[r], kUnlimited);
+      add(2 * byKey[n - 1 - r] + 1, sink, kUnlimited);
+    }
+
+    // CSR with paired reverse arcs
+    const uint32_t numFlowNodes = 2 * n + 2;
+    graph.first.assign(numFlowNodes + 1, 0);
+    for (const auto& [from, to] : arcs)
+    {
+      ++graph.first[from + 1];
+      ++graph.first[to + 1];
+    }
+    for (uint32_t i{0}; i < numFlowNodes; ++i)
+      graph.first[i + 1] += graph.first[i];
+    const size_t numArcs = graph.first.back();
+    graph.to.resize(numArcs);
+    graph.capacity.resize(numArcs);
+    graph.reverse.resize(numArcs);
+    std::vector<uint32_t> next(graph.first.begin(), graph.first.end() - 1);
+    for (size_t a{0}; a < arcs.size(); ++a)
+    {
+      const auto [from, to] = arcs[a];
+      const uint32_t forwardSlot = next[from]++;
+      const uint32_t backwardSlot = next[to]++;
+      graph.to[forwardSlot] = to;
+      graph.capacity[forwardSlot] = caps[a];
+      graph.reverse[forwardSlot] = backwardSlot;
+      graph.to[backwardSlot] = from;
+      graph.capacity[backwardSlot] = 0;
+      graph.reverse[backwardSlot] = forwardSlot;
+    }
+  }
+
+  // Max-flow by BFS augmenting paths (the flow value is the separator size,
+  // so there are few), then the cut next to the source's residual side.
+  Cut minVertexCut(const std::vector<uint32_t>& cell,
+                   const std::vector<uint32_t>& byKey, size_t stopAbove)
+  {
+    FlowGraph graph;
+    buildFlowGraph(cell, byKey, graph);
+    const uint32_t n = static_cast<uint32_t>(cell.size());
+    const uint32_t source = 2 * n;
+    const uint32_t sink = 2 * n + 1;
+    const uint32_t numFlowNodes = 2 * n + 2;
+
+    std::vector<uint32_t> parentArc(numFlowNodes);
+    std::vector<uint32_t> queue;
+    queue.reserve(numFlowNodes);
+    auto residualBfs = [&]() {
+      std::fill(parentArc.begin(), parentArc.end(), UINT32_MAX);
+      queue.clear();
+      queue.push_back(source);
+      parentArc[source] = UINT32_MAX - 1;
+      for (size_t head{0}; head < queue.size(); ++head)
+      {
+        const uint32_t u = queue[head];
+        for (uint32_t a{graph.first[u]}; a < graph.first[u + 1]; ++a)
+        {
+          const uint32_t v = graph.to[a];
+          if (graph.capacity[a] == 0 || parentArc[v] != UINT32_MAX) continue;
+          parentArc[v] = a;
+          if (v == sink) return true;
+          queue.push_back(v);
+        }
+      }
+      return false;
+    };
+
+    size_t flow = 0;
+    while (residualBfs())
+    {
+      for (uint32_t v{sink}; v != source;)
+      {
+        const uint32_t a = parentArc[v];
+        graph.capacity[a] -= 1;
+        graph.capacity[graph.reverse[a]] += 1;
+        v = graph.to[graph.reverse[a]];
+      }
+      if (++flow > stopAbove) return Cut{};  // worse than the best so far
+    }
+
+    // parentArc now marks the source side of the residual graph
+    Cut cut;
+    for (uint32_t i{0}; i < n; ++i)
+    {
+      const bool inReached = parentArc[2 * i] != UINT32_MAX;
+      const bool outReached = parentArc[2 * i + 1] != UINT32_MAX;
+      if (inReached && !outReached)
+        cut.separator.push_back(cell[i]);
+      else if (inReached)
+        cut.left.push_back(cell[i]);
+      else
+        cut.right.push_back(cell[i]);
+    }
+    return cut;
+  }
+
+  Cut bestCut(const std::vector<uint32_t>& cell)
+  {
+    for (uint32_t i{0}; i < cell.size(); ++i) localId[cell[i]] = i;
+
+    Cut best;
+    size_t bestSize = SIZE_MAX;
+    const double directions[][2] = {{1, 0}, {0, 1}, {1, 1}, {1, -1}};
+    std::vector<uint32_t> byKey(cell.size());
+    std::vector<double> key(cell.size());
+    for (const auto& direction : directions)
+    {
+      for (uint32_t i{0}; i < cell.size(); ++i)
+      {
+        byKey[i] = i;
+        key[i] = direction[0] * x[cell[i]] + direction[1] * y[cell[i]];
+      }
+      std::sort(byKey.begin(), byKey.end(),
+                [&](uint32_t a, uint32_t b) { return key[a] < key[b]; });
+
+      Cut cut = minVertexCut(cell, byKey, bestSize);
+      if (cut.left.empty() && cut.right.empty()) continue;
+      if (cut.separator.size() < bestSize)
+      {
+        bestSize = cut.separator.size();
+        best = std::move(cut);
+      }
+    }
+
+    for (uint32_t v : cell) localId[v] = UINT32_MAX;
+    return best;
+  }
+
+  void dissect(std::vector<uint32_t>& cell)
+  {
+    if (cell.size() <= kLeafSize)
+    {
+      order.insert(order.end(), cell.begin(), cell.end());
+      return;
+    }
+
+    Cut cut = bestCut(cell);
+    std::vector<uint32_t>().swap(cell);
+
+    dissect(cut.left);
+    dissect(cut.right);
+    order.insert(order.end(), cut.separator.begin(), cut.separator.end());
+  }
+
+  const Adjacency& adjacency;
+  std::vector<double> x, y;
+  std::vector<uint32_t> localId;  // cell-local index, UINT32_MAX outside
+  std::vector<uint32_t> order;
+};
+
+// Chordal completion of the state graph in rank order: eliminating a vertex
+// turns its upward neighbors into a clique, which is recorded at its lowest
+// upward neighbor (the elimination tree parent).
+void contract(const EdgesView& edgesView, const std::vector<uint32_t>& nodeRank,
+              std::vector<uint32_t>& firstOut, std::vector<uint32_t>& head)
+{
+  const uint32_t numNodes = edgesView.numNodes;
+  const uint32_t numStates = 2 * numNodes;
+  std::vector<std::vector<uint32_t>> up(numStates);
+
+  auto addArc = [&](uint32_t a, uint32_t b) {
+    if (a == b) return;
+    if (a > b) std::swap(a, b);
+    up[a].push_back(b);
+  };
+  for (uint32_t u{0}; u < numNodes; ++u)
+  {
+    const uint32_t rankU = 2 * nodeRank[u];
+    addArc(rankU, rankU + 1);  // mode switch
+    for (uint32_t e{edgesView.offsets[u]}; e < edgesView.offsets[u + 1]; ++e)
+    {
+      const uint32_t rankV = 2 * nodeRank[edgesView.neighbors[e]];
+      if (edgesView.modeMask[e] & 0x1) addArc(rankU, rankV);
+      if (edgesView.modeMask[e] & 0x2) addArc(rankU + 1, rankV + 1);
+    }
+  }
+
+  std::vector<uint32_t> merged;
+  for (uint32_t v{0}; v < numStates; ++v)
+  {
+    auto& list = up[v];
+    std::sort(list.begin(), list.end());
+    list.erase(std::unique(list.begin(), list.end()), list.end());
+    if (list.size() < 2) continue;
+
+    auto& parentList = up[list.front()];
+    std::sort(parentList.begin(), parentList.end());
+    parentList.erase(std::unique(parentList.begin(), parentList.end()),
+                     parentList.end());
+    merged.clear();
+    std::set_union(parentList.begin(), parentList.end(), list.begin() + 1,
+                   list.end(), std::back_inserter(merged));
+    parentList.assign(merged.begin(), merged.end());
+  }
+
+  firstOut.assign(numStates + 1, 0);
+  for (uint32_t v{0}; v < numStates; ++v)
+    firstOut[v + 1] = firstOut[v] + static_cast<uint32_t>(up[v].size());
+  head.clear();
+  head.reserve(firstOut.back());
+  for (auto& list : up)
+  {
+    head.insert(head.end(), list.begin(), list.end());
+    std::vector<uint32_t>().swap(list);
+  }
+}
+}  // namespace
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Main: nested dissection order → chordal upward graph → graph_cch.bin
+// ─────────────────────────────────────────────────────────────────────────────
+int main(int argc, char* argv[])
+{
+  if (argc > 2)
+  {
+    std::cerr << "Usage: buildCch [dataDir]\n";
+    return 1;
+  }
+  const std::string dataDir = argc > 1 ? argv[1] : "../../backend/data";
+
+  try
+  {
+    const NodesView nodesView = loadNodes(dataDir + "/graph_nodes.bin");
+    const EdgesView edgesView = loadEdges(dataDir + "/graph_edges.bin");
+    const uint32_t numNodes = edgesView.numNodes;
+    if (nodesView.numNodes != numNodes || numNodes == 0)
+      throw std::runtime_error("nodes/edges bins do not match");
+
+    std::vector<uint32_t> order;
+    {
+      const Adjacency adjacency = undirectedAdjacency(edgesView);
+      order = NestedDissection(nodesView, adjacency).run();
+    }
+    std::vector<uint32_t> nodeRank(numNodes);
+    for (uint32_t r{0}; r < numNodes; ++r) nodeRank[order[r]] = r;
+
+    std::vector<uint32_t> firstOut, head;
+    contract(edgesView, nodeRank, firstOut, head);
+
+    writeGraphCchBin(dataDir + "/graph_cch.bin", numNodes, edgesView.numEdges,
+                     nodeRank, firstOut, head);
+  } catch (const std::exception& e)
+  {
+    std::cerr << "buildCch: " << e.what() << "\n";
+    return 1;
+  }
+  return 0;
+}
@@ -1,6 +1,8 @@
+#include <algorithm>
 #include <cstring>
 #include <fstream>
 #include <iostream>
+#include <string>
 #include <osmium/io/any_input.hpp>
 #include <osmium/visitor.hpp>
 #include <unordered_map>
@@ -9,6 +11,7 @@
 #include <vector>
 
 #include "nodeCollector.hpp"
+#include "nodeOrder.hpp"
 #include "surfaceTypes.hpp"
 #include "utils.hpp"
 #include "wayCollector.hpp"
@@ -20,12 +23,18 @@ using namespace ingest;
 // ─────────────────────────────────────────────────────────────────────────────
 int main(int argc, char* argv[])
 {
-  if (argc < 2)
+  if (argc < 2 || argc > 3)
   {
-    std::cerr << "Usage: buildGraph <path-to-osm-pbf>\n";
+    std::cerr << "Usage: buildGraph <path-to-osm-pbf> [hilbert|osmid]\n";
     return 1;
   }
   const char* osmFile = argv[1];
+  const std::string nodeOrder = argc > 2 ? argv[2] : "hilbert";
+  if (nodeOrder != "hilbert" && nodeOrder != "osmid")
+  {
+    std::cerr << "node order must be hilbert or osmid\n";
+    return 1;
+  }
 
   // wayIdNodeIdsMap: wayId -> node ID's
   std::unordered_map<uint64_t, std::vector<uint64_t>> wayIdNodeIdsMap;
@@ -79,6 +88,24 @@ int main(int argc, char* argv[])
   std::sort(allNodeIds.begin(), allNodeIds.end());
   const uint32_t numNodes = (uint32_t)allNodeIds.size();
 
+  // Renumber along a Hilbert curve: OSM ids are scattered in space, so in id
+  // order a node's neighbors sit on far-apart pages of every per-node array.
+  // graph_nodes.bin keeps the OSM id of each index, so lookups still work.
+  if (nodeOrder == "hilbert")
+  {
+    std::vector<float> lat(numNodes), lon(numNodes);
+    for (uint32_t i{0}; i < numNodes; ++i)
+    {
+      const auto& coord = nodeIdCoordMap.at(allNodeIds[i]);
+      lat[i] = coord.first;
+      lon[i] = coord.second;
+    }
+    const std::vector<uint32_t> order = hilbertOrder(lat, lon);
+    std::vector<uint64_t> ordered(numNodes);
+    for (uint32_t i{0}; i < numNodes; ++i) ordered[i] = allNodeIds[order[i]];
+    allNodeIds.swap(ordered);
+  }
+
   // nodeIdToIdx: id -> idx
   std::unordered_map<uint64_t, uint32_t> nodeIdToIdx;
   nodeIdToIdx.reserve(numNodes * 2);
@@ -189,9 +216,11 @@ int main(int argc, char* argv[])
   }
 
   // Write bins
-  writeGraphNodesBin(allNodeIds, nodeIdCoordMap);
-  writeGraphEdgesBin(numNodes, numEdges, offsets, neighbors, lengthsMeters,
-                     surfacePrimaryVec, modeMasks);
+  writeGraphNodesBin("../../backend/data/graph_nodes.bin", allNodeIds,
+                     nodeIdCoordMap);
+  writeGraphEdgesBin("../../backend/data/graph_edges.bin", numNodes, numEdges,
+                     offsets, neighbors, lengthsMeters, surfacePrimaryVec,
+                     modeMasks);
 
   return 0;
 }
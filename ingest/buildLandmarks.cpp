@@ -0,0 +1,211 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "graphLoader.hpp"
+#include "utils.hpp"
+#include "writeBins.hpp"
+
+using namespace ingest;
+
+namespace
+{
+constexpr double kInf = std::numeric_limits<double>::infinity();
+
+// Shortest distances in meters from (Forward) or to (Backward) one node,
+// over every edge usable by bike or foot. The metric ignores speeds and
+// surfaces, so it lower-bounds every routing profile once scaled by the
+// fastest seconds per meter.
+enum class Direction
+{
+  Forward,
+  Backward
+};
+
+std::vector<double> shortestMeters(const EdgesView& edgesView, uint32_t root,
+                                   Direction direction)
+{
+  std::vector<double> dist(edgesView.numNodes, kInf);
+  using Item = std::pair<double, uint32_t>;
+  std::priority_queue<Item, std::vector<Item>, std::greater<Item>> openPQ;
+
+  dist[root] = 0.0;
+  openPQ.push({0.0, root});
+  while (!openPQ.empty())
+  {
+    const auto [d, u] = openPQ.top();
+    openPQ.pop();
+    if (d > dist[u]) continue;
+
+    const bool forward = direction == Direction::Forward;
+    const uint32_t* offsets = forward ? edgesView.offsets : edgesView.inOffsets;
+    for (uint32_t i{offsets[u]}; i < offsets[u + 1]; ++i)
+    {
+      const uint32_t edgeIdx = forward ? i : edgesView.inEdgeIds[i];
+      if ((edgesView.modeMask[edgeIdx] & 0x3) == 0) continue;
+
+      const uint32_t v =
+          forward ? edgesView.neighbors[i] : edgesView.inSources[i];
+      const double next = d + edgesView.lengthsMeters[edgeIdx];
+      if (next < dist[v])
+      {
+        dist[v] = next;
+        openPQ.push({next, v});
+      }
+    }
+  }
+  return dist;
+}
+
+// Node closest to the bounding-box centre; a start point inside the main
+// component for the farthest-landmark selection.
+uint32_t centralNode(const NodesView& nodesView)
+{
+  float minLat = nodesView.lat_f32[0], maxLat = minLat;
+  float minLon = nodesView.lon_f32[0], maxLon = minLon;
+  for (uint32_t i{1}; i < nodesView.numNodes; ++i)
+  {
+    minLat = std::min(minLat, nodesView.lat_f32[i]);
+    maxLat = std::max(maxLat, nodesView.lat_f32[i]);
+    minLon = std::min(minLon, nodesView.lon_f32[i]);
+    maxLon = std::max(maxLon, nodesView.lon_f32[i]);
+  }
+  const double centerLat = 0.5 * (double(minLat) + maxLat);
+  const double centerLon = 0.5 * (double(minLon) + maxLon);
+
+  uint32_t best = 0;
+  double bestMeters = kInf;
+  for (uint32_t i{0}; i < nodesView.numNodes; ++i)
+  {
+    const double meters = utils::haversineMeters(
+        centerLat, centerLon, nodesView.lat_f32[i], nodesView.lon_f32[i]);
+    if (meters < bestMeters)
+    {
+      bestMeters = meters;
+      best = i;
+    }
+  }
+  return best;
+}
+
+// Reachable node (finite score) with the largest score, or UINT32_MAX.
+uint32_t argmaxFinite(const std::vector<double>& score)
+{
+  uint32_t best = UINT32_MAX;
+  double bestScore = -1.0;
+  for (uint32_t i{0}; i < score.size(); ++i)
+  {
+    if (score[i] != kInf && score[i] > bestScore)
+    {
+      bestScore = score[i];
+      best = i;
+    }
+  }
+  return best;
+}
+}  // namespace
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Main: pick landmarks (farthest selection) → distance tables → bin
+// ─────────────────────────────────────────────────────────────────────────────
+int main(int argc, char* argv[])
+{
+  if (argc > 3)
+  {
+    std::cerr << "Usage: buildLandmarks [numLandmarks=16] [dataDir]\n";
+    return 1;
+  }
+  const uint32_t numLandmarks =
+      argc > 1 ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10))
+               : 16;
+  const std::string dataDir = argc > 2 ? argv[2] : "../../backend/data";
+  if (numLandmarks == 0 || numLandmarks > 64)
+  {
+    std::cerr << "numLandmarks must be in 1..64\n";
+    return 1;
+  }
+
+  try
+  {
+    const NodesView nodesView = loadNodes(dataDir + "/graph_nodes.bin");
+    const EdgesView edgesView = loadEdges(dataDir + "/graph_edges.bin");
+    const uint32_t numNodes = edgesView.numNodes;
+    if (nodesView.numNodes != numNodes || numNodes == 0)
+      throw std::runtime_error("nodes/edges bins do not match");
+
+    // Farthest selection: each new landmark is the reachable node farthest
+    // from all landmarks chosen so far (the first one: farthest from the
+    // centre).
+    std::vector<double> minMeters =
+        shortestMeters(edgesView, centralNode(nodesView), Direction::Forward);
+
+    std::vector<uint32_t> landmarkNodes;
+    std::vector<float> fromLandmark(size_t(numNodes) * numLandmarks);
+    std::vector<float> toLandmark(size_t(numNodes) * numLandmarks);
+
+    for (uint32_t i{0}; i < numLandmarks; ++i)
+    {
+      const uint32_t landmark = argmaxFinite(minMeters);
+      if (landmark == UINT32_MAX || minMeters[landmark] == 0.0) break;
+      landmarkNodes.push_back(landmark);
+
+      std::vector<double> from, to;
+      std::thread backward([&] {
+        to = shortestMeters(edgesView, landmark, Direction::Backward);
+      });
+      from = shortestMeters(edgesView, landmark, Direction::Forward);
+      backward.join();
+
+      for (uint32_t v{0}; v < numNodes; ++v)
+      {
+        const size_t at = size_t(v) * numLandmarks + i;
+        fromLandmark[at] = static_cast<float>(from[v]);
+        toLandmark[at] = static_cast<float>(to[v]);
+        minMeters[v] = i == 0 ? from[v] : std::min(minMeters[v], from[v]);
+      }
+      std::cout << "landmark " << i << ": node " << landmark << "\n";
+    }
+
+    // Fewer landmarks than asked (tiny graph): compact the tables
+    const uint32_t found = static_cast<uint32_t>(landmarkNodes.size());
+    if (found == 0) throw std::runtime_error("no landmark found");
+    if (found < numLandmarks)
+    {
+      std::vector<float> fromCompact(size_t(numNodes) * found);
+      std::vector<float> toCompact(size_t(numNodes) * found);
+      for (uint32_t v{0}; v < numNodes; ++v)
+      {
+        for (uint32_t i{0}; i < found; ++i)
+        {
+          fromCompact[size_t(v) * found + i] =
+              fromLandmark[size_t(v) * numLandmarks + i];
+          toCompact[size_t(v) * found + i] =
+              toLandmark[size_t(v) * numLandmarks + i];
+        }
+      }
+      fromLandmark.swap(fromCompact);
+      toLandmark.swap(toCompact);
+    }
+
+    writeGraphLandmarksBin(
+        dataDir + "/graph_landmarks.bin", numNodes, edgesView.numEdges,
+        edgesChecksum(numNodes, edgesView.numEdges, edgesView.offsets,
+                      edgesView.neighbors, edgesView.lengthsMeters,
+                      edgesView.modeMask),
+        landmarkNodes, fromLandmark, toLandmark);
+  } catch (const std::exception& e)
+  {
+    std::cerr << "buildLandmarks: " << e.what() << "\n";
+    return 1;
+  }
+  return 0;
+}
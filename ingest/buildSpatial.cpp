@@ -0,0 +1,42 @@
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include "graphLoader.hpp"
+#include "kdTree.hpp"
+#include "writeBins.hpp"
+
+using namespace ingest;
+
+// Builds kd_snap's KD-tree once, at ingest time, and writes it with the
+// checksum of the coordinates it was built on. kd_snap maps the result
+// instead of partitioning every node on each start.
+int main(int argc, char* argv[])
+{
+  if (argc > 2)
+  {
+    std::cerr << "Usage: buildSpatial [dataDir]\n";
+    return 1;
+  }
+  const std::string dataDir = argc > 1 ? argv[1] : "../../backend/data";
+
+  try
+  {
+    const NodesView nodesView = mapNodes(dataDir + "/graph_nodes.bin");
+
+    kd2d::PackedKDTree tree;
+    tree.build(nodesView.lat_f32, nodesView.lon_f32, nodesView.numNodes);
+
+    writeGraphSpatialBin(
+        dataDir + "/graph_spatial.bin", nodesView.numNodes,
+        nodesCoordChecksum(nodesView.lat_f32, nodesView.lon_f32,
+                           nodesView.numNodes),
+        tree.root(), tree.nodes(), tree.size());
+  } catch (const std::exception& e)
+  {
+    std::cerr << "buildSpatial: " << e.what() << "\n";
+    return 1;
+  }
+  return 0;
+}
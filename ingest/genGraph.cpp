@@ -0,0 +1,386 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "nodeOrder.hpp"
+#include "surfaceTypes.hpp"
+#include "utils.hpp"
+#include "writeBins.hpp"
+
+using namespace ingest;
+
+// Synthetic road networks for scaling tests: writes graph_nodes.bin and
+// graph_edges.bin in the same format (and with the same edge conventions)
+// as buildGraph, so the router, buildLandmarks, buildCch and benchRoute run
+// on them unchanged.
+
+namespace
+{
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kMetersPerDegLat = 111320.0;
+
+// How a street may be used, before one-way is applied
+enum class Access : uint8_t
+{
+  Both,
+  BikeOnly,
+  FootOnly
+};
+
+struct Config
+{
+  std::string kind{"grid"};  // grid | perturbed | geometric
+  uint32_t numNodes{10000};
+  std::string outDir{"."};
+  uint32_t seed{1};
+  double spacingM{100.0};
+  double jitter{-1.0};     // fraction of spacing; perturbed default 0.3
+  double dropRatio{-1.0};  // share of grid streets removed; perturbed 0.1
+  double radiusM{0.0};     // geometric; default 1.4 * spacing
+  double onewayRatio{0.05};
+  // (surface code, weight), codes as types::SurfacePrimary
+  std::vector<std::pair<uint32_t, double>> surfaces{
+      {1, 0.6}, {3, 0.1}, {9, 0.1}, {11, 0.1}, {15, 0.1}};
+  std::vector<std::pair<Access, double>> access{
+      {Access::Both, 0.85}, {Access::BikeOnly, 0.05}, {Access::FootOnly, 0.1}};
+  double originLat{60.17};
+  double originLon{24.94};
+};
+
+// Undirected street between two nodes, expanded into directed edges later
+struct Street
+{
+  uint32_t u;
+  uint32_t v;
+};
+
+struct Points
+{
+  std::vector<double> xM;
+  std::vector<double> yM;
+};
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Topologies (planar meters around the origin)
+// ─────────────────────────────────────────────────────────────────────────────
+
+// Square-ish lattice; jitter moves nodes, dropRatio removes streets.
+void makeGrid(const Config& config, double jitter, double dropRatio,
+              std::mt19937& rng, Points& points, std::vector<Street>& streets)
+{
+  const uint32_t cols = std::max<uint32_t>(
+      2, static_cast<uint32_t>(std::ceil(std::sqrt(config.numNodes))));
+  const uint32_t rows = std::max<uint32_t>(2, (config.numNodes + cols - 1) /
+                                                  cols);
+  std::uniform_real_distribution<double> offset(-jitter, jitter);
+  std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+  for (uint32_t r{0}; r < rows; ++r)
+    for (uint32_t c{0}; c < cols; ++c)
+    {
+      points.xM.push_back((c + offset(rng)) * config.spacingM);
+      points.yM.push_back((r + offset(rng)) * config.spacingM);
+    }
+
+  auto at = [cols](uint32_t r, uint32_t c) { return r * cols + c; };
+  for (uint32_t r{0}; r < rows; ++r)
+    for (uint32_t c{0}; c < cols; ++c)
+    {
+      if (c + 1 < cols && unit(rng) >= dropRatio)
+        streets.push_back({at(r, c), at(r, c + 1)});
+      if (r + 1 < rows && unit(rng) >= dropRatio)
+        streets.push_back({at(r, c), at(r + 1, c)});
+    }
+}
+
+// Uniform random points, a street between every pair closer than radiusM.
+// Point density matches the grid (one per spacing^2); the default radius
+// gives a mean degree near 6, well above the ~4.5 where a giant connected
+// component appears.
+void makeGeometric(const Config& config, std::mt19937& rng, Points& points,
+                   std::vector<Street>& streets)
+{
+  const uint32_t n = config.numNodes;
+  const double sideM = std::sqrt(double(n)) * config.spacingM;
+  const double radiusM =
+      config.radiusM > 0.0 ? config.radiusM : 1.4 * config.spacingM;
+  std::uniform_real_distribution<double> coord(0.0, sideM);
+
+  points.xM.resize(n);
+  points.yM.resize(n);
+  for (uint32_t i{0}; i < n; ++i)
+  {
+    points.xM[i] = coord(rng);
+    points.yM[i] = coord(rng);
+  }
+
+  // Buckets of radius-sized cells: only the 3x3 neighborhood can match
+  const uint32_t cells =
+      std::max<uint32_t>(1, static_cast<uint32_t>(sideM / radiusM));
+  auto cellOf = [&](double m) {
+    return std::min(cells - 1, static_cast<uint32_t>(m / sideM * cells));
+  };
+  std::vector<std::vector<uint32_t>> buckets(size_t(cells) * cells);
+  for (uint32_t i{0}; i < n; ++i)
+    buckets[size_t(cellOf(points.yM[i])) * cells + cellOf(points.xM[i])]
+        .push_back(i);
+
+  const double radius2 = radiusM * radiusM;
+  for (uint32_t i{0}; i < n; ++i)
+  {
+    const int64_t cx = cellOf(points.xM[i]);
+    const int64_t cy = cellOf(points.yM[i]);
+    for (int64_t y{std::max<int64_t>(0, cy - 1)};
+         y <= std::min<int64_t>(cells - 1, cy + 1); ++y)
+      for (int64_t x{std::max<int64_t>(0, cx - 1)};
+           x <= std::min<int64_t>(cells - 1, cx + 1); ++x)
+        for (uint32_t j : buckets[size_t(y) * cells + size_t(x)])
+        {
+          if (j <= i) continue;
+          const double dx = points.xM[i] - points.xM[j];
+          const double dy = points.yM[i] - points.yM[j];
+          if (dx * dx + dy * dy < radius2) streets.push_back({i, j});
+        }
+  }
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Options
+// ─────────────────────────────────────────────────────────────────────────────
+
+// "key:weight,key:weight"
+std::vector<std::pair<std::string, double>> parseWeights(
+    const std::string& value)
+{
+  std::vector<std::pair<std::string, double>> weights;
+  std::istringstream list(value);
+  std::string item;
+  while (std::getline(list, item, ','))
+  {
+    const size_t colon = item.find(':');
+    if (colon == std::string::npos)
+      throw std::runtime_error("expected key:weight, got " + item);
+    const double weight = std::strtod(item.c_str() + colon + 1, nullptr);
+    if (!(weight >= 0.0))
+      throw std::runtime_error("bad weight in " + item);
+    weights.emplace_back(item.substr(0, colon), weight);
+  }
+  if (weights.empty()) throw std::runtime_error("empty weight list");
+  return weights;
+}
+
+bool parseArgs(int argc, char* argv[], Config& config)
+{
+  for (int i{1}; i < argc; ++i)
+  {
+    const std::string arg = argv[i];
+    if (i + 1 >= argc) return false;
+    const std::string value = argv[++i];
+    if (arg == "--kind")
+      config.kind = value;
+    else if (arg == "--nodes")
+      config.numNodes = static_cast<uint32_t>(std::strtoul(value.c_str(),
+                                                           nullptr, 10));
+    else if (arg == "--out")
+      config.outDir = value;
+    else if (arg == "--seed")
+      config.seed = static_cast<uint32_t>(std::strtoul(value.c_str(),
+                                                       nullptr, 10));
+    else if (arg == "--spacing-m")
+      config.spacingM = std::strtod(value.c_str(), nullptr);
+    else if (arg == "--jitter")
+      config.jitter = std::strtod(value.c_str(), nullptr);
+    else if (arg == "--drop")
+      config.dropRatio = std::strtod(value.c_str(), nullptr);
+    else if (arg == "--radius-m")
+      config.radiusM = std::strtod(value.c_str(), nullptr);
+    else if (arg == "--oneway")
+      config.onewayRatio = std::strtod(value.c_str(), nullptr);
+    else if (arg == "--surfaces")
+    {
+      config.surfaces.clear();
+      for (const auto& [key, weight] : parseWeights(value))
+      {
+        const uint32_t code =
+            static_cast<uint32_t>(std::strtoul(key.c_str(), nullptr, 10));
+        if (code > static_cast<uint32_t>(types::SurfacePrimary::UNKNOWN))
+          throw std::runtime_error("surface code out of range: " + key);
+        config.surfaces.emplace_back(code, weight);
+      }
+    }
+    else if (arg == "--access")
+    {
+      config.access.clear();
+      for (const auto& [key, weight] : parseWeights(value))
+      {
+        if (key == "both")
+          config.access.emplace_back(Access::Both, weight);
+        else if (key == "bike")
+          config.access.emplace_back(Access::BikeOnly, weight);
+        else if (key == "foot")
+          config.access.emplace_back(Access::FootOnly, weight);
+        else
+          throw std::runtime_error("access must be both, bike or foot");
+      }
+    }
+    else
+      return false;
+  }
+  return config.numNodes >= 4 && config.spacingM > 0.0 &&
+         (config.kind == "grid" || config.kind == "perturbed" ||
+          config.kind == "geometric");
+}
+
+template <class Key>
+std::discrete_distribution<size_t> weightsOf(
+    const std::vector<std::pair<Key, double>>& table)
+{
+  std::vector<double> weights;
+  for (const auto& entry : table) weights.push_back(entry.second);
+  return std::discrete_distribution<size_t>(weights.begin(), weights.end());
+}
+}  // namespace
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Main: topology → attributes → Hilbert order → CSR → bins
+// ─────────────────────────────────────────────────────────────────────────────
+int main(int argc, char* argv[])
+{
+  Config config;
+  try
+  {
+    if (!parseArgs(argc, argv, config))
+    {
+      std::cerr
+          << "Usage: genGraph [--kind grid|perturbed|geometric] [--nodes N]"
+             "\n                [--out dir] [--seed 1] [--spacing-m 100]"
+             "\n                [--jitter 0.3] [--drop 0.1] [--radius-m 140]"
+             "\n                [--oneway 0.05] [--surfaces code:w,...]"
+             "\n                [--access both:w,bike:w,foot:w]\n"
+             "Surface codes follow types::SurfacePrimary (0..15).\n";
+      return 1;
+    }
+
+    std::mt19937 rng(config.seed);
+    Points points;
+    std::vector<Street> streets;
+    if (config.kind == "geometric")
+      makeGeometric(config, rng, points, streets);
+    else
+    {
+      const bool perturbed = config.kind == "perturbed";
+      const double jitter =
+          config.jitter >= 0.0 ? config.jitter : (perturbed ? 0.3 : 0.0);
+      const double dropRatio =
+          config.dropRatio >= 0.0 ? config.dropRatio : (perturbed ? 0.1 : 0.0);
+      makeGrid(config, jitter, dropRatio, rng, points, streets);
+    }
+    const uint32_t numNodes = static_cast<uint32_t>(points.xM.size());
+
+    // Planar meters → degrees around the origin (equirectangular)
+    const double metersPerDegLon =
+        kMetersPerDegLat * std::cos(config.originLat * kPi / 180.0);
+    std::vector<float> lat(numNodes), lon(numNodes);
+    for (uint32_t i{0}; i < numNodes; ++i)
+    {
+      lat[i] = static_cast<float>(config.originLat +
+                                  points.yM[i] / kMetersPerDegLat);
+      lon[i] = static_cast<float>(config.originLon +
+                                  points.xM[i] / metersPerDegLon);
+    }
+
+    // Same numbering as buildGraph; ids stay the generation order + 1
+    const std::vector<uint32_t> order = hilbertOrder(lat, lon);
+    std::vector<uint32_t> newIdx(numNodes);
+    std::vector<uint64_t> nodeIds(numNodes);
+    std::vector<float> orderedLat(numNodes), orderedLon(numNodes);
+    for (uint32_t i{0}; i < numNodes; ++i)
+    {
+      newIdx[order[i]] = i;
+      nodeIds[i] = uint64_t(order[i]) + 1;
+      orderedLat[i] = lat[order[i]];
+      orderedLon[i] = lon[order[i]];
+    }
+
+    // Street attributes, then directed edges as buildGraph derives them:
+    // forward if bike or foot may use it, backward if bike may ride it
+    // backward (not one-way) or foot may use it.
+    auto surfacePick = weightsOf(config.surfaces);
+    auto accessPick = weightsOf(config.access);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+    struct Directed
+    {
+      uint32_t from;
+      uint32_t to;
+      float lengthM;
+      uint8_t surface;
+      uint8_t modeMask;
+    };
+    std::vector<Directed> directed;
+    directed.reserve(streets.size() * 2);
+    for (const Street& street : streets)
+    {
+      const uint32_t u = newIdx[street.u];
+      const uint32_t v = newIdx[street.v];
+      const float dist = (float)utils::haversineMeters(
+          orderedLat[u], orderedLon[u], orderedLat[v], orderedLon[v]);
+      const uint8_t surface =
+          static_cast<uint8_t>(config.surfaces[surfacePick(rng)].first);
+      const Access access = config.access[accessPick(rng)].first;
+      const bool bike = access != Access::FootOnly;
+      const bool foot = access != Access::BikeOnly;
+      const bool oneway = unit(rng) < config.onewayRatio;
+
+      const uint8_t fwdMask = (bike ? types::MODE_BIKE : 0) |
+                              (foot ? types::MODE_FOOT : 0);
+      const uint8_t backMask = (bike && !oneway ? types::MODE_BIKE : 0) |
+                               (foot ? types::MODE_FOOT : 0);
+      if (fwdMask) directed.push_back({u, v, dist, surface, fwdMask});
+      if (backMask) directed.push_back({v, u, dist, surface, backMask});
+    }
+
+    // CSR
+    const uint32_t numEdges = static_cast<uint32_t>(directed.size());
+    std::vector<uint32_t> offsets(numNodes + 1, 0);
+    for (const Directed& edge : directed) ++offsets[edge.from + 1];
+    for (uint32_t i{0}; i < numNodes; ++i) offsets[i + 1] += offsets[i];
+
+    std::vector<uint32_t> neighbors(numEdges);
+    std::vector<float> lengthsMeters(numEdges);
+    std::vector<uint8_t> surfacePrimary(numEdges);
+    std::vector<uint8_t> modeMasks(numEdges);
+    std::vector<uint32_t> cur(offsets.begin(), offsets.end() - 1);
+    for (const Directed& edge : directed)
+    {
+      const uint32_t idx = cur[edge.from]++;
+      neighbors[idx] = edge.to;
+      lengthsMeters[idx] = edge.lengthM;
+      surfacePrimary[idx] = edge.surface;
+      modeMasks[idx] = edge.modeMask;
+    }
+
+    std::cerr << config.kind << ": " << numNodes << " nodes, "
+              << streets.size() << " streets, " << numEdges
+              << " directed edges (avg out-degree "
+              << double(numEdges) / numNodes << ")\n";
+
+    writeGraphNodesBin(config.outDir + "/graph_nodes.bin", nodeIds,
+                       orderedLat, orderedLon);
+    writeGraphEdgesBin(config.outDir + "/graph_edges.bin", numNodes,
+                       numEdges, offsets, neighbors, lengthsMeters,
+                       surfacePrimary, modeMasks);
+  } catch (const std::exception& e)
+  {
+    std::cerr << "genGraph: " << e.what() << "\n";
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,439 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "aStar.hpp"
+#include "edgeSnap.hpp"
+#include "graphLoader.hpp"
+#include "kdTree.hpp"
+#include "priorityQueues.hpp"
+#include "searchCommon.hpp"
+#include "surfaceMaps.hpp"
+#include "utils.hpp"
+#include "writeBins.hpp"
+
+#if BENCH_WITH_OSMIUM
+#include <osmium/builder/attr.hpp>
+#include <osmium/memory/buffer.hpp>
+
+#include "wayCollector.hpp"
+#endif
+
+// Micro-benchmarks of the routing and snapping kernels, one isolated number
+// per kernel on fixed seeded inputs. Google Benchmark flags apply, e.g.
+//   microBench --benchmark_out=base.json --benchmark_out_format=json
+// and compare two builds with Google Benchmark's tools/compare.py.
+
+namespace
+{
+constexpr uint32_t kSeed = 1;
+
+// Random points in a box around Helsinki
+void randomPoints(uint32_t count, uint32_t seed, std::vector<float>& lat,
+                  std::vector<float>& lon)
+{
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<float> pickLat(60.10f, 60.30f);
+  std::uniform_real_distribution<float> pickLon(24.70f, 25.20f);
+  lat.resize(count);
+  lon.resize(count);
+  for (uint32_t i{0}; i < count; ++i)
+  {
+    lat[i] = pickLat(rng);
+    lon[i] = pickLon(rng);
+  }
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Fixed synthetic adjacency: a side x side grid, ~100 m spacing, streets in
+// both directions. Surfaces cycle through the 16 codes; every 7th street is
+// bike-only and every 11th foot-only, so both layers skip some edges.
+// ─────────────────────────────────────────────────────────────────────────────
+struct SyntheticGraph
+{
+  std::vector<float> lat, lon;
+  std::vector<uint32_t> offsets, neighbors;
+  std::vector<float> lengthsMeters;
+  std::vector<uint8_t> surfacePrimary, modeMasks;
+  std::vector<uint32_t> inOffsets, inSources, inEdgeIds;
+  std::vector<ingest::PackedEdge> packed;
+  NodesView nodes;
+  EdgesView edges;
+
+  explicit SyntheticGraph(uint32_t side)
+  {
+    const uint32_t numNodes = side * side;
+    lat.resize(numNodes);
+    lon.resize(numNodes);
+    for (uint32_t r{0}; r < side; ++r)
+      for (uint32_t c{0}; c < side; ++c)
+      {
+        lat[r * side + c] = 60.15f + r * 0.0009f;
+        lon[r * side + c] = 24.90f + c * 0.0018f;
+      }
+
+    offsets.assign(numNodes + 1, 0);
+    auto streetsOf = [&](uint32_t u, auto&& emit) {
+      const uint32_t r = u / side, c = u % side;
+      if (c > 0) emit(u - 1);
+      if (c + 1 < side) emit(u + 1);
+      if (r > 0) emit(u - side);
+      if (r + 1 < side) emit(u + side);
+    };
+    for (uint32_t u{0}; u < numNodes; ++u)
+      streetsOf(u, [&](uint32_t) { ++offsets[u + 1]; });
+    for (uint32_t u{0}; u < numNodes; ++u) offsets[u + 1] += offsets[u];
+
+    for (uint32_t u{0}; u < numNodes; ++u)
+      streetsOf(u, [&](uint32_t v) {
+        const uint32_t street = std::min(u, v) * 4 + (v > u ? 1 : 0);
+        neighbors.push_back(v);
+        lengthsMeters.push_back(static_cast<float>(
+            utils::haversineMeters(lat[u], lon[u], lat[v], lon[v])));
+        surfacePrimary.push_back(static_cast<uint8_t>(street % 16));
+        modeMasks.push_back(street % 7 == 0    ? EDGE_MASK_BIKE
+                            : street % 11 == 0 ? EDGE_MASK_FOOT
+                                               : EDGE_MASK_BIKE |
+                                                     EDGE_MASK_FOOT);
+      });
+
+    ingest::buildReverseCsr(numNodes, offsets, neighbors, inOffsets,
+                            inSources, inEdgeIds);
+    ingest::buildPackedEdges(numNodes, neighbors, lengthsMeters,
+                             surfacePrimary, modeMasks, packed);
+
+    nodes.numNodes = numNodes;
+    nodes.lat_f32 = lat.data();
+    nodes.lon_f32 = lon.data();
+    attachPlanarCoords(nodes);
+
+    edges.numNodes = numNodes;
+    edges.numEdges = static_cast<uint32_t>(neighbors.size());
+    edges.offsets = offsets.data();
+    edges.neighbors = neighbors.data();
+    edges.lengthsMeters = lengthsMeters.data();
+    edges.surfacePrimary = surfacePrimary.data();
+    edges.modeMask = modeMasks.data();
+    edges.inOffsets = inOffsets.data();
+    edges.inSources = inSources.data();
+    edges.inEdgeIds = inEdgeIds.data();
+    edges.packed = packed.empty() ? nullptr : packed.data();
+  }
+
+  static const SyntheticGraph& shared()
+  {
+    static const SyntheticGraph graph(256);
+    return graph;
+  }
+};
+
+// Parameters that make CostModel pick each kernel on the synthetic graph
+AStarParams paramsFor(CostKernel kernel)
+{
+  AStarParams params;
+  if (kernel == CostKernel::Uniform) return params;
+  params.bikeSurfaceFactor = {1.0, 1.0, 1.0, 1.2, 1.3, 1.6, 1.5, 1.2,
+                              1.4, 1.2, 1.3, 1.5, 1.5, 1.6, 1.6, 1.1};
+  params.walkSurfaceFactor = {1.0, 1.0, 1.0, 1.0, 1.1, 1.2, 1.2, 1.0,
+                              1.1, 1.0, 1.1, 1.2, 1.2, 1.3, 1.3, 1.0};
+  if (kernel == CostKernel::SurfacePenalty)
+  {
+    params.bikeSurfaceMask = 0x00FF;  // paved codes preferred
+    params.surfacePenaltySPerKm = 180.0;
+  }
+  return params;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Geometry
+// ─────────────────────────────────────────────────────────────────────────────
+void BM_HaversineMeters(benchmark::State& state)
+{
+  std::vector<float> lat, lon;
+  randomPoints(4096, kSeed, lat, lon);
+  for (auto _ : state)
+  {
+    double sum = 0.0;
+    for (size_t i{0}; i + 1 < lat.size(); ++i)
+      sum += utils::haversineMeters(lat[i], lon[i], lat[i + 1], lon[i + 1]);
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * (lat.size() - 1));
+}
+BENCHMARK(BM_HaversineMeters);
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Snapping (kd_snap)
+// ─────────────────────────────────────────────────────────────────────────────
+void BM_KdTreeBuild(benchmark::State& state)
+{
+  std::vector<float> lat, lon;
+  randomPoints(static_cast<uint32_t>(state.range(0)), kSeed, lat, lon);
+  for (auto _ : state)
+  {
+    kd2d::PackedKDTree tree;
+    tree.build(lat.data(), lon.data(), static_cast<uint32_t>(lat.size()));
+    benchmark::DoNotOptimize(tree);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_KdTreeBuild)
+    ->Arg(10000)
+    ->Arg(150000)
+    ->Unit(benchmark::kMillisecond);
+
+void BM_KdTreeNearest(benchmark::State& state)
+{
+  std::vector<float> lat, lon, queryLat, queryLon;
+  randomPoints(static_cast<uint32_t>(state.range(0)), kSeed, lat, lon);
+  randomPoints(4096, kSeed + 1, queryLat, queryLon);
+  kd2d::PackedKDTree tree;
+  tree.build(lat.data(), lon.data(), static_cast<uint32_t>(lat.size()));
+
+  size_t i = 0;
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(tree.nearestNeighbor(queryLat[i], queryLon[i],
+                                                  lat.data(), lon.data()));
+    i = (i + 1) % queryLat.size();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_KdTreeNearest)->Arg(10000)->Arg(150000);
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Ingest tag handling
+// ─────────────────────────────────────────────────────────────────────────────
+void BM_SurfaceFromTag(benchmark::State& state)
+{
+  // Common values first, as in the Helsinki extract; the rest miss
+  const std::vector<const char*> values{
+      "asphalt", "paving_stones", "gravel",  "compacted", "fine_gravel",
+      "ground",  "concrete",      "sett",    "earth",     "unknown",
+      "wood",    "grass",         "",        nullptr};
+  for (auto _ : state)
+  {
+    for (const char* value : values)
+    {
+      types::SurfacePrimary primary;
+      ingest::SurfaceMaps::fromTag(value, primary);
+      benchmark::DoNotOptimize(primary);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * values.size());
+}
+BENCHMARK(BM_SurfaceFromTag);
+
+#if BENCH_WITH_OSMIUM
+void BM_WayCollectorClassify(benchmark::State& state)
+{
+  using namespace osmium::builder::attr;
+  using Tags = std::initializer_list<std::pair<const char*, const char*>>;
+  const std::vector<Tags> tagSets{
+      {{"highway", "residential"}, {"surface", "asphalt"}},
+      {{"highway", "cycleway"}, {"surface", "asphalt"}, {"foot", "yes"}},
+      {{"highway", "footway"}, {"surface", "paving_stones"}},
+      {{"highway", "primary"}, {"bicycle", "no"}},
+      {{"highway", "service"}, {"access", "private"}},
+      {{"highway", "tertiary"}, {"oneway", "yes"}, {"cycleway", "opposite"}},
+      {{"highway", "track"}, {"surface", "gravel"}},
+      {{"railway", "tram"}},
+      {{"route", "ferry"}},
+      {{"highway", "path"}, {"surface", "ground"}, {"bicycle", "designated"}}};
+
+  osmium::memory::Buffer buffer{1024 * 1024,
+                                osmium::memory::Buffer::auto_grow::yes};
+  std::vector<size_t> offsets;
+  for (size_t i{0}; i < tagSets.size(); ++i)
+    offsets.push_back(osmium::builder::add_way(
+        buffer, _id(static_cast<osmium::object_id_type>(i + 1)),
+        _nodes({1, 2, 3, 4}), _tags(tagSets[i])));
+
+  std::unordered_map<uint64_t, std::vector<uint64_t>> wayNodes;
+  std::unordered_map<uint64_t, ingest::WayMeta> wayMeta;
+  ingest::WayCollector collector(wayNodes, wayMeta);
+  for (auto _ : state)
+  {
+    // Same ids every pass: the maps reach steady state after the first
+    for (size_t offset : offsets)
+      collector.way(buffer.get<osmium::Way>(offset));
+  }
+  state.SetItemsProcessed(state.iterations() * offsets.size());
+}
+BENCHMARK(BM_WayCollectorClassify);
+#endif
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Open-set policies: a Dijkstra-shaped workload on a random graph. Each pop
+// pushes three neighbors at the popped key plus a random step, improving
+// already-queued labels as often as a road graph does.
+// ─────────────────────────────────────────────────────────────────────────────
+template <class OpenQueue>
+void BM_QueuePushPop(benchmark::State& state)
+{
+  const uint32_t numStates = static_cast<uint32_t>(state.range(0));
+  std::mt19937 rng(kSeed);
+  std::uniform_int_distribution<uint32_t> pickState(0, numStates - 1);
+  std::uniform_real_distribution<double> pickStep(1.0, 60.0);
+  std::vector<std::pair<uint32_t, double>> arcs(size_t(numStates) * 3);
+  for (auto& arc : arcs) arc = {pickState(rng), pickStep(rng)};
+
+  std::vector<SearchState> states(numStates);
+  OpenQueue openPQ;
+  uint64_t pops = 0;
+  for (auto _ : state)
+  {
+    std::fill(states.begin(), states.end(), SearchState{});
+    openPQ.clear();
+    states[0].gCost = 0.0;
+    openPQ.push(0.0, 0, states[0]);
+    while (!openPQ.empty())
+    {
+      const QueueEntry top = openPQ.pop();
+      SearchState& cur = states[top.stateKey];
+      if (cur.closed) continue;
+      cur.closed = 1;
+      ++pops;
+      for (uint32_t k{0}; k < 3; ++k)
+      {
+        const auto& [v, step] = arcs[size_t(top.stateKey) * 3 + k];
+        SearchState& next = states[v];
+        const double cost = cur.gCost + step;
+        if (cost < next.gCost)
+        {
+          next.gCost = cost;
+          openPQ.push(cost, v, next);
+        }
+      }
+    }
+  }
+  state.SetItemsProcessed(pops);
+}
+BENCHMARK_TEMPLATE(BM_QueuePushPop, BinaryHeapQueue)->Arg(1 << 16);
+BENCHMARK_TEMPLATE(BM_QueuePushPop, IndexedDaryHeap<4>)->Arg(1 << 16);
+BENCHMARK_TEMPLATE(BM_QueuePushPop, RadixHeapQueue)->Arg(1 << 16);
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Ride/walk relaxation: the per-settled-node work of runAStar (cost
+// evaluation for both layers plus the label compare and store) over every
+// node of the grid, without the open set.
+// ─────────────────────────────────────────────────────────────────────────────
+template <CostKernel kKernel, class Edges>
+void BM_RelaxEdges(benchmark::State& state)
+{
+  const SyntheticGraph& graph = SyntheticGraph::shared();
+  const EdgesView& edgesView = graph.edges;
+  if constexpr (std::is_same_v<Edges, PackedEdges>)
+  {
+    if (!edgesView.packed)
+    {
+      state.SkipWithError("graph does not fit packed edges");
+      return;
+    }
+  }
+  const AStarParams params = paramsFor(kKernel);
+  const CostModel costs(params, edgesView);
+  if (costs.kernel() != kKernel)
+  {
+    state.SkipWithError("params do not select this kernel");
+    return;
+  }
+  const Edges edges(edgesView);
+  std::vector<double> labels(size_t(StateKey::kLayers) * edgesView.numNodes);
+
+  for (auto _ : state)
+  {
+    std::fill(labels.begin(), labels.end(),
+              std::numeric_limits<double>::infinity());
+    for (uint32_t u{0}; u < edgesView.numNodes; ++u)
+    {
+      const double base = u * 0.5;
+      for (uint32_t e{edgesView.offsets[u]}; e < edgesView.offsets[u + 1];
+           ++e)
+      {
+        double timeS, penaltyS;
+        uint8_t stepLabel;
+        if (costs.ride<kKernel>(edges, e, timeS, penaltyS, stepLabel))
+        {
+          double& label = labels[StateKey::idx(edges.head(e), Layer::Ride)];
+          label = std::min(label, base + timeS + penaltyS);
+        }
+        if (costs.walk<kKernel>(edges, e, timeS))
+        {
+          double& label = labels[StateKey::idx(edges.head(e), Layer::Walk)];
+          label = std::min(label, base + timeS);
+        }
+      }
+    }
+    benchmark::DoNotOptimize(labels.data());
+  }
+  state.SetItemsProcessed(state.iterations() * edgesView.numEdges);
+}
+BENCHMARK_TEMPLATE(BM_RelaxEdges, CostKernel::Uniform, SoaEdges);
+BENCHMARK_TEMPLATE(BM_RelaxEdges, CostKernel::Uniform, PackedEdges);
+BENCHMARK_TEMPLATE(BM_RelaxEdges, CostKernel::Surface, SoaEdges);
+BENCHMARK_TEMPLATE(BM_RelaxEdges, CostKernel::Surface, PackedEdges);
+BENCHMARK_TEMPLATE(BM_RelaxEdges, CostKernel::SurfacePenalty, SoaEdges);
+BENCHMARK_TEMPLATE(BM_RelaxEdges, CostKernel::SurfacePenalty, PackedEdges);
+
+// The whole search, corner to corner, on the same grid. range(0): direction.
+void BM_AStarGrid(benchmark::State& state)
+{
+  const SyntheticGraph& graph = SyntheticGraph::shared();
+  const AStarParams params = paramsFor(CostKernel::SurfacePenalty);
+  SearchOptions options;
+  options.direction = static_cast<SearchDirection>(state.range(0));
+  SearchWorkspace workspace;
+  const uint32_t target = graph.nodes.numNodes - 1;
+
+  uint64_t settled = 0;
+  for (auto _ : state)
+  {
+    const AStarResult result = aStarTwoLayer(graph.edges, graph.nodes, 0,
+                                             target, params, workspace,
+                                             options);
+    settled += result.settledStates;
+    benchmark::DoNotOptimize(result.costS);
+  }
+  state.counters["settledPerQuery"] = benchmark::Counter(
+      double(settled), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_AStarGrid)
+    ->Arg(static_cast<int>(SearchDirection::Forward))
+    ->Arg(static_cast<int>(SearchDirection::Bidirectional))
+    ->Unit(benchmark::kMillisecond);
+
+// Edge snapping on the grid: random points inside it, default options
+void BM_EdgeSnapNearest(benchmark::State& state)
+{
+  const SyntheticGraph& graph = SyntheticGraph::shared();
+  const EdgeSnapIndex index(graph.nodes, graph.edges);
+  std::mt19937 rng(kSeed);
+  std::uniform_real_distribution<double> pickLat(graph.lat.front(),
+                                                 graph.lat.back());
+  std::uniform_real_distribution<double> pickLon(graph.lon.front(),
+                                                 graph.lon.back());
+  std::vector<std::pair<double, double>> queries(4096);
+  for (auto& query : queries) query = {pickLat(rng), pickLon(rng)};
+
+  const SnapOptions options;
+  std::size_t i{0};
+  for (auto _ : state)
+  {
+    const auto& [lat, lon] = queries[i++ % queries.size()];
+    benchmark::DoNotOptimize(
+        index.nearest(graph.nodes, graph.edges, lat, lon, options));
+  }
+}
+BENCHMARK(BM_EdgeSnapNearest);
+}  // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,70 @@
+#include "nodeOrder.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+namespace ingest
+{
+namespace
+{
+constexpr uint32_t kGridBits = 16;
+constexpr uint32_t kGridSize = 1u << kGridBits;
+}  // namespace
+
+uint32_t hilbertIndex(uint32_t x, uint32_t y)
+{
+  // Classic xy -> d walk: at each level pick the quadrant, then rotate and
+  // reflect so the sub-square is traversed in the canonical orientation.
+  uint32_t d = 0;
+  for (uint32_t s{kGridSize / 2}; s > 0; s /= 2)
+  {
+    const uint32_t rx = (x & s) > 0;
+    const uint32_t ry = (y & s) > 0;
+    d += s * s * ((3 * rx) ^ ry);
+    if (ry == 0)
+    {
+      if (rx == 1)
+      {
+        x = kGridSize - 1 - x;
+        y = kGridSize - 1 - y;
+      }
+      std::swap(x, y);
+    }
+  }
+  return d;
+}
+
+std::vector<uint32_t> hilbertOrder(const std::vector<float>& lat,
+                                   const std::vector<float>& lon)
+{
+  if (lat.size() != lon.size())
+    throw std::runtime_error("hilbertOrder: lat/lon size mismatch");
+
+  const uint32_t numNodes = static_cast<uint32_t>(lat.size());
+  std::vector<uint32_t> order(numNodes);
+  std::iota(order.begin(), order.end(), 0);
+  if (numNodes == 0) return order;
+
+  const auto [minLat, maxLat] = std::minmax_element(lat.begin(), lat.end());
+  const auto [minLon, maxLon] = std::minmax_element(lon.begin(), lon.end());
+
+  // Each axis is stretched over the whole grid; cells need not be square,
+  // only the visiting order matters.
+  auto toGrid = [](float value, float low, float high) {
+    const double span = std::max(double(high) - low, 1e-9);
+    const double cell = (double(value) - low) / span * (kGridSize - 1);
+    return static_cast<uint32_t>(std::clamp(cell, 0.0, kGridSize - 1.0));
+  };
+
+  std::vector<uint32_t> key(numNodes);
+  for (uint32_t i{0}; i < numNodes; ++i)
+  {
+    key[i] = hilbertIndex(toGrid(lon[i], *minLon, *maxLon),
+                          toGrid(lat[i], *minLat, *maxLat));
+  }
+  std::stable_sort(order.begin(), order.end(),
+                   [&](uint32_t a, uint32_t b) { return key[a] < key[b]; });
+  return order;
+}
+}  // namespace ingest
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace ingest
+{
+// ─────────────────────────────────────────────────────────────────────────────
+// Node numbering
+// - the router's label arrays, coordinates and CSR rows are all indexed by
+//   node, so nodes close on the map should get close indices
+// ─────────────────────────────────────────────────────────────────────────────
+
+// Position of (x, y) on a Hilbert curve over a 2^16 x 2^16 grid.
+uint32_t hilbertIndex(uint32_t x, uint32_t y);
+
+// Node indices 0..N-1 sorted along a Hilbert curve through their
+// coordinates (ties keep the input order): entry i is the old index of the
+// node that becomes node i.
+std::vector<uint32_t> hilbertOrder(const std::vector<float>& lat,
+                                   const std::vector<float>& lon);
+}  // namespace ingest
@@ -0,0 +1,33 @@
+#include "surfaceMaps.hpp"
+
+#include <algorithm>
+
+namespace ingest
+{
+// ─────────────────────────────────────────────────────────────────────────────
+// Surface mapping implementation
+// ─────────────────────────────────────────────────────────────────────────────
+void SurfaceMaps::fromTag(const char* surfaceVal,
+                          types::SurfacePrimary& surfacePrimaryOut)
+{
+  if (!surfaceVal || !*surfaceVal)
+  {
+    surfacePrimaryOut = types::SurfacePrimary::UNKNOWN;
+
+    return;
+  }
+
+  const std::string_view key{surfaceVal};
+  auto it = std::find_if(kEntries.begin(), kEntries.end(),
+                         [&](const Entry& e) { return e.key == key; });
+
+  if (it != kEntries.end())
+  {
+    surfacePrimaryOut = it->primary;
+  }
+  else
+  {
+    surfacePrimaryOut = types::SurfacePrimary::UNKNOWN;
+  }
+}
+}  // namespace ingest
@@ -9,46 +9,11 @@
 #include <unordered_set>
 #include <vector>
 
+#include "surfaceMaps.hpp"
 #include "surfaceTypes.hpp"
 
 namespace ingest
 {
-// ─────────────────────────────────────────────────────────────────────────────
-// Surface mapping (OSM tag → SurfacePrimary)
-// ─────────────────────────────────────────────────────────────────────────────
-struct SurfaceMaps
-{
-  struct Entry
-  {
-    std::string_view key;
-    types::SurfacePrimary primary;
-  };
-
-  static constexpr std::array<Entry, 16> kEntries{
-      {{"paved", types::SurfacePrimary::PAVED},
-       {"asphalt", types::SurfacePrimary::ASPHALT},
-       {"concrete", types::SurfacePrimary::CONCRETE},
-       {"paving_stones", types::SurfacePrimary::PAVING_STONES},
-       {"sett", types::SurfacePrimary::SETT},
-       {"unhewn_cobblestones", types::SurfacePrimary::UNHEWN_COBBLESTONES},
-       {"cobblestones", types::SurfacePrimary::COBBLESTONES},
-       {"bricks", types::SurfacePrimary::BRICKS},
-
-       {"unpaved", types::SurfacePrimary::UNPAVED},
-       {"compacted", types::SurfacePrimary::COMPACTED},
-       {"fine_gravel", types::SurfacePrimary::FINE_GRAVEL},
-       {"gravel", types::SurfacePrimary::GRAVEL},
-       {"ground", types::SurfacePrimary::GROUND},
-       {"dirt", types::SurfacePrimary::DIRT},
-       {"earth", types::SurfacePrimary::EARTH},
-
-       {"unknown", types::SurfacePrimary::UNKNOWN}}};
-
-  // Set wayMeta's surface fields based on OSM surface tag
-  static void fromTag(const char* surfaceVal,
-                      types::SurfacePrimary& surfacePrimaryOut);
-};
-
 // ─────────────────────────────────────────────────────────────────────────────
 // Way metadata (access + surfaces)
 // ─────────────────────────────────────────────────────────────────────────────
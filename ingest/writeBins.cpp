@@ -6,25 +6,131 @@
 
 namespace ingest
 {
+namespace
+{
+// Zero-fill up to the next 8-byte file offset (section alignment).
+void padTo8(std::ofstream& out)
+{
+  static const char kZeros[8] = {};
+  const auto pos = static_cast<std::size_t>(out.tellp());
+  const std::size_t pad = (8 - pos % 8) % 8;
+  out.write(kZeros, static_cast<std::streamsize>(pad));
+}
 
-void writeGraphNodesBin(
-    const std::vector<uint64_t>& allNodeIds,
-    const std::unordered_map<uint64_t, std::pair<float, float>>& nodeIdCoordMap)
+constexpr uint64_t kChecksumSeed = 0xcbf29ce484222325ull;
+
+// FNV-1a over 8-byte words: each step is a bijection of the running hash,
+// so changing any one word always changes the result.
+void mixChecksum(uint64_t& hash, const void* data, size_t size)
+{
+  constexpr uint64_t kPrime = 0x100000001b3ull;
+  const char* bytes = static_cast<const char*>(data);
+  size_t at{0};
+  for (; at + 8 <= size; at += 8)
+  {
+    uint64_t word;
+    std::memcpy(&word, bytes + at, 8);
+    hash = (hash ^ word) * kPrime;
+  }
+  if (at < size)
+  {
+    uint64_t word = 0;
+    std::memcpy(&word, bytes + at, size - at);
+    hash = (hash ^ word) * kPrime;
+  }
+}
+}  // namespace
+
+void buildReverseCsr(uint32_t numNodes, const std::vector<uint32_t>& offsets,
+                     const std::vector<uint32_t>& neighbors,
+                     std::vector<uint32_t>& inOffsets,
+                     std::vector<uint32_t>& inSources,
+                     std::vector<uint32_t>& inEdgeIds)
+{
+  // Counting sort of edges by head node; stable, so incoming edges of a
+  // node stay ordered by edge id.
+  inOffsets.assign(numNodes + 1, 0);
+  for (uint32_t v : neighbors) inOffsets[v + 1]++;
+  for (size_t i{1}; i <= numNodes; ++i) inOffsets[i] += inOffsets[i - 1];
+
+  inSources.resize(neighbors.size());
+  inEdgeIds.resize(neighbors.size());
+  std::vector<uint32_t> cur(inOffsets.begin(), inOffsets.end() - 1);
+  for (uint32_t u{0}; u < numNodes; ++u)
+  {
+    for (uint32_t e{offsets[u]}; e < offsets[u + 1]; ++e)
+    {
+      const uint32_t slot = cur[neighbors[e]]++;
+      inSources[slot] = u;
+      inEdgeIds[slot] = e;
+    }
+  }
+}
+
+bool buildPackedEdges(uint32_t numNodes, const std::vector<uint32_t>& neighbors,
+                      const std::vector<float>& lengthsMeters,
+                      const std::vector<uint8_t>& surfacePrimary,
+                      const std::vector<uint8_t>& modeMasks,
+                      std::vector<PackedEdge>& out)
+{
+  out.clear();
+  if (numNodes > kPackedHeadMask + 1 ||
+      surfacePrimary.size() != neighbors.size() ||
+      modeMasks.size() != neighbors.size() ||
+      lengthsMeters.size() != neighbors.size())
+    return false;
+
+  out.resize(neighbors.size());
+  for (size_t e{0}; e < neighbors.size(); ++e)
+  {
+    if (surfacePrimary[e] > 0xF || modeMasks[e] > 0x3)
+    {
+      out.clear();
+      return false;
+    }
+    out[e].word = neighbors[e] |
+                  uint32_t(surfacePrimary[e]) << kPackedSurfaceShift |
+                  uint32_t(modeMasks[e]) << kPackedModeShift;
+    out[e].lengthMeters = lengthsMeters[e];
+  }
+  return true;
+}
+
+void writeGraphNodesBin(const std::string& outPath,
+                        const std::vector<uint64_t>& nodeIds,
+                        const std::vector<float>& lat,
+                        const std::vector<float>& lon)
 {
+  if (lat.size() != nodeIds.size() || lon.size() != nodeIds.size())
+    throw std::runtime_error("node ids and coords differ in length");
+
   NodesHeader hdr;
   std::memcpy(hdr.magic, "MMAPNODE", 8);
-  hdr.numNodes = static_cast<uint32_t>(allNodeIds.size());
+  hdr.numNodes = static_cast<uint32_t>(nodeIds.size());
 
-  std::ofstream out("../../backend/data/graph_nodes.bin", std::ios::binary);
-  if (!out) throw std::runtime_error("Cannot open graph_nodes.bin for write");
+  std::ofstream out(outPath, std::ios::binary);
+  if (!out) throw std::runtime_error("Cannot open " + outPath + " for write");
 
   out.write(reinterpret_cast<const char*>(&hdr), sizeof(hdr));
 
   // ids[N]
-  out.write(reinterpret_cast<const char*>(allNodeIds.data()),
-            allNodeIds.size() * sizeof(uint64_t));
+  out.write(reinterpret_cast<const char*>(nodeIds.data()),
+            nodeIds.size() * sizeof(uint64_t));
 
   // lat[N], lon[N]
+  out.write(reinterpret_cast<const char*>(lat.data()),
+            lat.size() * sizeof(float));
+  out.write(reinterpret_cast<const char*>(lon.data()),
+            lon.size() * sizeof(float));
+
+  out.close();
+  std::cout << "Wrote " << outPath << " (" << nodeIds.size() << " nodes)\n";
+}
+
+void writeGraphNodesBin(
+    const std::string& outPath, const std::vector<uint64_t>& allNodeIds,
+    const std::unordered_map<uint64_t, std::pair<float, float>>& nodeIdCoordMap)
+{
   std::vector<float> lat(allNodeIds.size()), lon(allNodeIds.size());
   for (size_t i = 0; i < allNodeIds.size(); ++i)
   {
@@ -34,16 +140,11 @@ void writeGraphNodesBin(
     lat[i] = it->second.first;
     lon[i] = it->second.second;
   }
-  out.write(reinterpret_cast<const char*>(lat.data()),
-            lat.size() * sizeof(float));
-  out.write(reinterpret_cast<const char*>(lon.data()),
-            lon.size() * sizeof(float));
-
-  out.close();
-  std::cout << "Wrote graph_nodes.bin (" << allNodeIds.size() << " nodes)\n";
+  writeGraphNodesBin(outPath, allNodeIds, lat, lon);
 }
 
-void writeGraphEdgesBin(uint32_t numNodes, uint32_t numEdges,
+void writeGraphEdgesBin(const std::string& outPath, uint32_t numNodes,
+                        uint32_t numEdges,
                         const std::vector<uint32_t>& offsets,
                         const std::vector<uint32_t>& neighbors,
                         const std::vector<float>& lengthsMeters,
@@ -57,9 +158,17 @@ void writeGraphEdgesBin(uint32_t numNodes, uint32_t numEdges,
   hdr.hasSurfacePrimary = 1;
   hdr.hasModeMask = 1;
   hdr.lengthType = 0;
+  hdr.extraSections = EDGES_SECTION_REVERSE_CSR;
+
+  std::vector<PackedEdge> packed;
+  if (buildPackedEdges(numNodes, neighbors, lengthsMeters, surfacePrimary,
+                       modeMasks, packed))
+    hdr.extraSections |= EDGES_SECTION_PACKED;
+  else
+    std::cout << "graph does not fit packed edge records, section skipped\n";
 
-  std::ofstream out("../../backend/data/graph_edges.bin", std::ios::binary);
-  if (!out) throw std::runtime_error("Cannot open graph_edges.bin for write");
+  std::ofstream out(outPath, std::ios::binary);
+  if (!out) throw std::runtime_error("Cannot open " + outPath + " for write");
 
   out.write(reinterpret_cast<const char*>(&hdr), sizeof(hdr));
 
@@ -88,7 +197,150 @@ void writeGraphEdgesBin(uint32_t numNodes, uint32_t numEdges,
   out.write(reinterpret_cast<const char*>(modeMasks.data()),
             modeMasksSize * sizeof(uint8_t));
 
+  // reverse CSR (incoming edges), so the router maps it instead of
+  // rebuilding it at startup
+  std::vector<uint32_t> inOffsets, inSources, inEdgeIds;
+  buildReverseCsr(numNodes, offsets, neighbors, inOffsets, inSources,
+                  inEdgeIds);
+
+  padTo8(out);
+  const uint32_t inOffsetsSize = static_cast<uint32_t>(inOffsets.size());
+  const uint32_t inEdgesSize = static_cast<uint32_t>(inSources.size());
+  out.write(reinterpret_cast<const char*>(&inOffsetsSize), 4);
+  out.write(reinterpret_cast<const char*>(&inEdgesSize), 4);
+  out.write(reinterpret_cast<const char*>(inOffsets.data()),
+            inOffsetsSize * sizeof(uint32_t));
+  out.write(reinterpret_cast<const char*>(inSources.data()),
+            inEdgesSize * sizeof(uint32_t));
+  out.write(reinterpret_cast<const char*>(inEdgeIds.data()),
+            inEdgesSize * sizeof(uint32_t));
+
+  // packed adjacency records (one cache line holds 8 edges)
+  if (hdr.extraSections & EDGES_SECTION_PACKED)
+  {
+    padTo8(out);
+    const uint32_t numRecords = static_cast<uint32_t>(packed.size());
+    const uint32_t reserved = 0;
+    out.write(reinterpret_cast<const char*>(&numRecords), 4);
+    out.write(reinterpret_cast<const char*>(&reserved), 4);
+    out.write(reinterpret_cast<const char*>(packed.data()),
+              numRecords * sizeof(PackedEdge));
+  }
+
+  out.close();
+  std::cout << "Wrote " << outPath << " (" << numEdges
+            << " directed edges)\n";
+}
+
+void writeGraphLandmarksBin(const std::string& outPath, uint32_t numNodes,
+                            uint32_t numEdges, uint64_t edgesChecksum,
+                            const std::vector<uint32_t>& landmarkNodes,
+                            const std::vector<float>& fromLandmark,
+                            const std::vector<float>& toLandmark)
+{
+  const size_t tableSize = size_t(numNodes) * landmarkNodes.size();
+  if (fromLandmark.size() != tableSize || toLandmark.size() != tableSize)
+    throw std::runtime_error("landmark table size mismatch");
+
+  LandmarksHeader hdr;
+  std::memcpy(hdr.magic, "MMAPLMRK", 8);
+  hdr.numNodes = numNodes;
+  hdr.numEdges = numEdges;
+  hdr.numLandmarks = static_cast<uint32_t>(landmarkNodes.size());
+  hdr.distanceType = 0;
+  hdr.edgesChecksum = edgesChecksum;
+
+  std::ofstream out(outPath, std::ios::binary);
+  if (!out) throw std::runtime_error("Cannot open " + outPath + " for write");
+
+  out.write(reinterpret_cast<const char*>(&hdr), sizeof(hdr));
+  out.write(reinterpret_cast<const char*>(landmarkNodes.data()),
+            landmarkNodes.size() * sizeof(uint32_t));
+  padTo8(out);
+  out.write(reinterpret_cast<const char*>(fromLandmark.data()),
+            tableSize * sizeof(float));
+  out.write(reinterpret_cast<const char*>(toLandmark.data()),
+            tableSize * sizeof(float));
+
+  out.close();
+  std::cout << "Wrote " << outPath << " (" << landmarkNodes.size()
+            << " landmarks)\n";
+}
+
+uint64_t edgesChecksum(uint32_t numNodes, uint32_t numEdges,
+                       const uint32_t* offsets, const uint32_t* neighbors,
+                       const float* lengthsMeters, const uint8_t* modeMask)
+{
+  uint64_t hash = kChecksumSeed ^ (uint64_t(numEdges) << 32 | numNodes);
+  mixChecksum(hash, offsets, sizeof(uint32_t) * (size_t(numNodes) + 1));
+  mixChecksum(hash, neighbors, sizeof(uint32_t) * size_t(numEdges));
+  mixChecksum(hash, lengthsMeters, sizeof(float) * size_t(numEdges));
+  mixChecksum(hash, modeMask, size_t(numEdges));
+  return hash;
+}
+
+void writeGraphCchBin(const std::string& outPath, uint32_t numNodes,
+                      uint32_t numEdges, const std::vector<uint32_t>& nodeRank,
+                      const std::vector<uint32_t>& firstOut,
+                      const std::vector<uint32_t>& head)
+{
+  if (nodeRank.size() != numNodes ||
+      firstOut.size() != 2 * size_t(numNodes) + 1)
+    throw std::runtime_error("cch array size mismatch");
+
+  CchHeader hdr;
+  std::memcpy(hdr.magic, "MMAPCCHO", 8);
+  hdr.numNodes = numNodes;
+  hdr.numEdges = numEdges;
+  hdr.numArcs = static_cast<uint32_t>(head.size());
+
+  std::ofstream out(outPath, std::ios::binary);
+  if (!out) throw std::runtime_error("Cannot open " + outPath + " for write");
+
+  out.write(reinterpret_cast<const char*>(&hdr), sizeof(hdr));
+  out.write(reinterpret_cast<const char*>(nodeRank.data()),
+            nodeRank.size() * sizeof(uint32_t));
+  out.write(reinterpret_cast<const char*>(firstOut.data()),
+            firstOut.size() * sizeof(uint32_t));
+  out.write(reinterpret_cast<const char*>(head.data()),
+            head.size() * sizeof(uint32_t));
+
+  out.close();
+  std::cout << "Wrote " << outPath << " (" << head.size() << " arcs)\n";
+}
+
+uint64_t nodesCoordChecksum(const float* lat, const float* lon,
+                            uint32_t numNodes)
+{
+  uint64_t hash = kChecksumSeed ^ numNodes;
+  mixChecksum(hash, lat, sizeof(float) * size_t(numNodes));
+  mixChecksum(hash, lon, sizeof(float) * size_t(numNodes));
+  return hash;
+}
+
+void writeGraphSpatialBin(const std::string& outPath, uint32_t numNodes,
+                          uint64_t nodesChecksum, int32_t rootIndex,
+                          const KdTreeNode* kdNodes, uint32_t numKdNodes)
+{
+  if (numKdNodes != numNodes)
+    throw std::runtime_error("spatial tree size mismatch");
+
+  SpatialHeader hdr;
+  std::memcpy(hdr.magic, "MMAPSPAT", 8);
+  hdr.version = kSpatialVersion;
+  hdr.numNodes = numNodes;
+  hdr.nodesChecksum = nodesChecksum;
+  hdr.rootIndex = rootIndex;
+
+  std::ofstream out(outPath, std::ios::binary);
+  if (!out) throw std::runtime_error("Cannot open " + outPath + " for write");
+
+  out.write(reinterpret_cast<const char*>(&hdr), sizeof(hdr));
+  out.write(reinterpret_cast<const char*>(kdNodes),
+            size_t(numKdNodes) * sizeof(KdTreeNode));
+
   out.close();
-  std::cout << "Wrote graph_edges.bin (" << numEdges << " directed edges)\n";
+  std::cout << "Wrote " << outPath << " (" << numKdNodes << " tree nodes)\n";
 }
+
 }  // namespace ingest
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
@@ -8,16 +9,74 @@
 
 namespace ingest
 {
+// graph_nodes.bin (see NodesHeader): ids, then lat[N], lon[N].
+void writeGraphNodesBin(const std::string& outPath,
+                        const std::vector<uint64_t>& nodeIds,
+                        const std::vector<float>& lat,
+                        const std::vector<float>& lon);
+
 void writeGraphNodesBin(
-    const std::vector<uint64_t>& allNodeIds,
+    const std::string& outPath, const std::vector<uint64_t>& allNodeIds,
     const std::unordered_map<uint64_t, std::pair<float, float>>&
         nodeIdCoordMap);
 
-void writeGraphEdgesBin(uint32_t numNodes, uint32_t numEdges,
+// Incoming-edge CSR of a forward CSR: for node v, entries
+// inOffsets[v]..inOffsets[v+1] give the tail node and forward edge id.
+void buildReverseCsr(uint32_t numNodes, const std::vector<uint32_t>& offsets,
+                     const std::vector<uint32_t>& neighbors,
+                     std::vector<uint32_t>& inOffsets,
+                     std::vector<uint32_t>& inSources,
+                     std::vector<uint32_t>& inEdgeIds);
+
+// Packed adjacency records for the forward CSR. Returns false (and leaves
+// out empty) if the graph does not fit the record: more than 2^26 nodes,
+// surface codes above 15 or mode bits above 0x3.
+bool buildPackedEdges(uint32_t numNodes, const std::vector<uint32_t>& neighbors,
+                      const std::vector<float>& lengthsMeters,
+                      const std::vector<uint8_t>& surfacePrimary,
+                      const std::vector<uint8_t>& modeMasks,
+                      std::vector<PackedEdge>& out);
+
+// graph_edges.bin (see EdgesHeader), with the reverse CSR and, if the
+// graph fits, packed edge records.
+void writeGraphEdgesBin(const std::string& outPath, uint32_t numNodes,
+                        uint32_t numEdges,
                         const std::vector<uint32_t>& offsets,
                         const std::vector<uint32_t>& neighbors,
                         const std::vector<float>& lengthsMeters,
                         const std::vector<uint8_t>& surfacePrimary,
                         const std::vector<uint8_t>& modeMasks);
 
+// graph_landmarks.bin (see LandmarksHeader). Tables are node-major,
+// numNodes * landmarkNodes.size() floats each; edgesChecksum is
+// edgesChecksum() of the edges they were computed on.
+void writeGraphLandmarksBin(const std::string& outPath, uint32_t numNodes,
+                            uint32_t numEdges, uint64_t edgesChecksum,
+                            const std::vector<uint32_t>& landmarkNodes,
+                            const std::vector<float>& fromLandmark,
+                            const std::vector<float>& toLandmark);
+
+// Checksum of the edge arrays a search reads (offsets[N+1], then
+// neighbors, lengthsMeters and modeMask[E]), stored in the bins derived
+// from them so a stale one can be detected.
+uint64_t edgesChecksum(uint32_t numNodes, uint32_t numEdges,
+                       const uint32_t* offsets, const uint32_t* neighbors,
+                       const float* lengthsMeters, const uint8_t* modeMask);
+
+// graph_cch.bin (see CchHeader).
+void writeGraphCchBin(const std::string& outPath, uint32_t numNodes,
+                      uint32_t numEdges, const std::vector<uint32_t>& nodeRank,
+                      const std::vector<uint32_t>& firstOut,
+                      const std::vector<uint32_t>& head);
+
+// Checksum of a nodes bin's coordinates (lat[N], then lon[N]), stored in
+// the bins derived from them so a stale one can be detected.
+uint64_t nodesCoordChecksum(const float* lat, const float* lon,
+                            uint32_t numNodes);
+
+// graph_spatial.bin (see SpatialHeader). kdNodes holds one node per point.
+void writeGraphSpatialBin(const std::string& outPath, uint32_t numNodes,
+                          uint64_t nodesChecksum, int32_t rootIndex,
+                          const KdTreeNode* kdNodes, uint32_t numKdNodes);
+
 }  // namespace ingest
\ No newline at end of file